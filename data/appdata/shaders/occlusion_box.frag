@@ -0,0 +1,14 @@
+/*!
+ *  Occlusion Box Fragment Shader
+ * 
+ *  Boxes are drawn with color and depth writes disabled, only the samples
+ *  passing the depth test matter.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+void main() {
+
+}
\ No newline at end of file
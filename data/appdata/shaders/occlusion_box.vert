@@ -0,0 +1,17 @@
+/*!
+ *  Occlusion Box Vertex Shader
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+// Model parameter inputs
+layout(location = LOC_IN_VERT) in vec3 vert_in;
+
+// Render parameter inputs
+layout(location = LOC_IN_MVP) uniform mat4 mvp_in;
+
+void main() {
+    gl_Position = mvp_in * vec4(vert_in, 1.0);
+}
\ No newline at end of file
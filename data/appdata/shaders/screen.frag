@@ -15,11 +15,6 @@ in vec2 uv;
 layout(location = LOC_TEX_(0)) uniform sampler2DMS input_color;
 layout(location = LOC_TEX_(1)) uniform sampler2DMS input_bg;
 layout(location = LOC_TEX_(2)) uniform sampler2DMS input_depth;
-layout(location = LOC_DIMX) uniform int dimx;
-layout(location = LOC_DIMY) uniform int dimy;
-layout(location = LOC_MSAA_LEVEL) uniform int msaa_lev;
-layout(location = LOC_CAM_NEAR) uniform float cam_near;
-layout(location = LOC_CAM_FAR) uniform float cam_far;
 
 layout(location = LOC_OUT_COLOR) out vec3 color;
 
@@ -28,11 +23,11 @@ float linearDepth(float depthSample);
 void main() {
     
     // Antialiasing
-    int x = int(((uv.x + 1.0) / 2.0) * dimx);
-    int y = int(((uv.y + 1.0) / 2.0) * dimy);
+    int x = int(((uv.x + 1.0) / 2.0) * frame.viewport.x);
+    int y = int(((uv.y + 1.0) / 2.0) * frame.viewport.y);
     ivec2 coord = ivec2(x,y);
     vec3 accum = vec3(0,0,0);
-    for(int i = 0; i < msaa_lev; i++) {
+    for(int i = 0; i < frame.msaa_level; i++) {
 
         float fog_depth = texelFetch(input_depth, coord, i).r;
         if(fog_depth == 1) {
@@ -55,6 +50,6 @@ void main() {
         }
     }
 
-    color = accum / msaa_lev;
+    color = accum / frame.msaa_level;
 
 }
\ No newline at end of file
@@ -10,16 +10,17 @@
 layout(location = LOC_IN_VERT) in vec3 vert_in;
 layout(location = LOC_IN_UV)   in vec2 uv_in;
 
-// Render parameter inputs
-layout(location = LOC_IN_MVP) uniform mat4 mvp_in;
+// Position dequantization (identity unless the geometry is quantized)
+layout(location = LOC_IN_POS_SCALE) uniform vec3 pos_scale_in;
+layout(location = LOC_IN_POS_OFFSET) uniform vec3 pos_offset_in;
 
 // Misc. Outputs
 out vec2 uv;
 
 void main() {
 
-    vec4 pos = vec4(vert_in, 1.0);
-    gl_Position = mvp_in * pos;
+    vec4 pos = vec4(vert_in * pos_scale_in + pos_offset_in, 1.0);
+    gl_Position = frame.view_projection * pos;
 
     uv = uv_in;
 
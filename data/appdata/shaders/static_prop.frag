@@ -13,11 +13,24 @@ in vec2 uv;
 in vec3 frag_pos;
 in vec3 normal;
 
+#ifdef TEXTURE_ARRAY
+layout(location = LOC_TEX_(0)) uniform sampler2DArray texture_sampler;
+#ifdef INSTANCED
+flat in int texture_layer;
+#else
+layout(location = LOC_IN_TEX_LAYER) uniform int texture_layer;
+#endif
+#else
 layout(location = LOC_TEX_(0)) uniform sampler2D texture_sampler;
+#endif
 
 void main() {
     // Sample the texture
+    #ifdef TEXTURE_ARRAY
+    color = texture(texture_sampler, vec3(uv, texture_layer)).rgb;
+    #else
     color = texture(texture_sampler, uv).rgb;
+    #endif
 
     // Calculate scene light position
     float light = dot(normal, normalize(vec3(-1,1,1)));
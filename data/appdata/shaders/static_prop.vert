@@ -11,22 +11,40 @@ layout(location = LOC_IN_VERT) in vec3 vert_in;
 layout(location = LOC_IN_UV)   in vec2 uv_in;
 layout(location = LOC_IN_NORM) in vec3 normal_in;
 
-// Render parameter inputs
-layout(location = LOC_IN_MVP) uniform mat4 mvp_in;
+#ifdef INSTANCED
+// Instance inputs
+layout(location = LOC_IN_INSTANCE_MODEL) in mat4 instance_model_in;
+layout(location = LOC_IN_INSTANCE_LAYER) in uint instance_layer_in;
+#endif
+
+// Render parameter inputs (the camera comes from the frame uniforms)
 layout(location = LOC_IN_MODEL_MAT) uniform mat4 model_in;
 
+// Position dequantization (identity unless the geometry is quantized)
+layout(location = LOC_IN_POS_SCALE) uniform vec3 pos_scale_in;
+layout(location = LOC_IN_POS_OFFSET) uniform vec3 pos_offset_in;
+
 // Misc. Outputs
 out vec2 uv;
 out vec3 frag_pos;
 out vec3 normal;
+#ifdef INSTANCED
+flat out int texture_layer;
+#endif
 
 void main() {
 
-    vec4 pos = vec4(vert_in, 1.0);
-    gl_Position = mvp_in * pos;
-    frag_pos = (model_in * pos).xyz;
+    vec4 pos = vec4(vert_in * pos_scale_in + pos_offset_in, 1.0);
+    #ifdef INSTANCED
+    mat4 model = instance_model_in;
+    texture_layer = int(instance_layer_in);
+    #else
+    mat4 model = model_in;
+    #endif
+    gl_Position = frame.view_projection * model * pos;
+    frag_pos = (model * pos).xyz;
 
     uv = uv_in;
-    normal = mat3(model_in) * normal_in;
+    normal = mat3(model) * normal_in;
 
 }
\ No newline at end of file
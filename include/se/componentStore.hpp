@@ -0,0 +1,222 @@
+/*!
+ *  @file include/se/componentStore.hpp
+ * 
+ *  Structure of arrays storage for entity components.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_COMPONENTSTORE_H_
+#define _SE_COMPONENTSTORE_H_
+
+#include "se/fwd.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+namespace se {
+
+    /*!
+     *  Component Handle.
+     * 
+     *  Stable reference to an entry in a component store.  Handles remain
+     *  valid while other entries are added and removed, and become invalid
+     *  (rather than referring to a different entity) once their own entry is
+     *  removed.
+     */
+    struct ComponentHandle {
+        /// Slot index
+        uint32_t slot = UINT32_MAX;
+        /// Slot generation
+        uint32_t generation = 0;
+    };
+
+    /*!
+     *  Component Store.
+     * 
+     *  Stores the transforms, model matrices, and flags of the entities in a
+     *  scene in parallel, densely packed arrays, so that loops over every
+     *  entity walk contiguous memory instead of chasing entity pointers.
+     *  Removing an entry moves the last entry into its place, so dense indices
+     *  are only valid until the store is next modified; handles are stable.
+     * 
+     *  Entities are bound to the store when they are inserted.  While bound,
+     *  their position, rotation, and scale accessors read and write the store
+     *  instead of the entity, and the values are copied back when the entity
+     *  is removed.
+     * 
+     *  Entities are added and moved from any thread, while the logic thread
+     *  walks the arrays every tick, so the store is guarded by a single
+     *  (recursive) mutex.  Every method locks it, but the arrays returned by
+     *  the `get_*()` array accessors may be reallocated by the next insertion
+     *  or removal, so they must only be used while holding `get_mutex()`.
+     */
+    class ComponentStore {
+
+        public:
+
+            /// Entity is renderable
+            static const uint8_t RENDERABLE = 0x1;
+
+            /// Entity is tickable
+            static const uint8_t TICKABLE = 0x2;
+
+            /// Model matrix is out of date
+            static const uint8_t TRANSFORM_DIRTY = 0x4;
+
+        private:
+
+            /// Handle slot
+            struct Slot {
+                /// Dense index, or the next free slot
+                uint32_t dense;
+                /// Incremented every time the slot is released
+                uint32_t generation;
+            };
+
+            /// Handle slots
+            std::vector<Slot> slots;
+
+            /// Head of the free slot list
+            uint32_t free_slot = UINT32_MAX;
+
+            /// Slot of each entry
+            std::vector<uint32_t> dense_slots;
+
+            /// Entity of each entry
+            std::vector<se::Entity*> entities;
+
+            /// Positions (meters)
+            std::vector<glm::vec3> positions;
+
+            /// Rotations (radians)
+            std::vector<glm::vec3> rotations;
+
+            /// Scales (multiplier)
+            std::vector<glm::vec3> scales;
+
+            /// Model matrices, as of the last `update_transforms()`
+            std::vector<glm::mat4> model_matrices;
+
+            /// Flags
+            std::vector<uint8_t> flags;
+
+            /*!
+             *  Store mutex.
+             * 
+             *  Recursive, because updating the transforms asks each entity for
+             *  its model matrix, which reads the entity's transform back out of
+             *  the store.
+             */
+            std::recursive_mutex mutex;
+
+        public:
+
+            /// Destroy the store, unbinding any remaining entities
+            ~ComponentStore();
+
+            /*!
+             *  Insert an entity.
+             * 
+             *  Copies the current transform of the entity into the store and
+             *  binds the entity to it.
+             * 
+             *  @param entity   Entity to insert.  Must not already be bound to
+             *                  a store.
+             * 
+             *  @return Handle of the new entry.
+             */
+            ComponentHandle insert(se::Entity* entity);
+
+            /*!
+             *  Remove an entity.
+             * 
+             *  Copies the transform back into the entity and unbinds it.
+             *  Invalid handles are ignored.
+             */
+            void remove(ComponentHandle handle);
+
+            /// Remove an entity, if it is in this store
+            void remove(se::Entity* entity);
+
+            /// Check if a handle refers to an entry
+            bool is_valid(ComponentHandle handle);
+
+            /*!
+             *  Get the dense index of an entry.
+             * 
+             *  The handle must be valid.
+             */
+            uint32_t get_index(ComponentHandle handle);
+
+            /// Get the position of an entry
+            glm::vec3 get_position(ComponentHandle handle);
+
+            /// Set the position of an entry
+            void set_position(ComponentHandle handle, glm::vec3 position);
+
+            /// Get the rotation of an entry
+            glm::vec3 get_rotation(ComponentHandle handle);
+
+            /// Set the rotation of an entry
+            void set_rotation(ComponentHandle handle, glm::vec3 rotation);
+
+            /// Get the scale of an entry
+            glm::vec3 get_scale(ComponentHandle handle);
+
+            /// Set the scale of an entry
+            void set_scale(ComponentHandle handle, glm::vec3 scale);
+
+            /// Mark the model matrix of an entry as out of date
+            void mark_dirty(ComponentHandle handle);
+
+            /*!
+             *  Update the model matrices.
+             * 
+             *  Only entries marked dirty are recalculated, so calling this
+             *  more than once per tick is cheap.
+             */
+            void update_transforms();
+
+            /*!
+             *  Find entries.
+             * 
+             *  @param mask     Flags the entries must have (any of).
+             *  @param indices  Set to the dense indices of the matching
+             *                  entries, in order.
+             */
+            void query(uint8_t mask, std::vector<uint32_t>& indices);
+
+            /// Get the number of entries
+            size_t size();
+
+            /*!
+             *  Get the store mutex.
+             * 
+             *  Must be held for as long as any of the arrays below (or the
+             *  dense indices from `query()` and `get_index()`) are in use.
+             */
+            std::recursive_mutex& get_mutex();
+
+            /// Get the entity array
+            se::Entity* const* get_entities();
+
+            /// Get the position array
+            const glm::vec3* get_positions();
+
+            /// Get the model matrix array
+            const glm::mat4* get_model_matrices();
+
+            /// Get the flag array
+            const uint8_t* get_flags();
+
+    };
+
+}
+
+#endif
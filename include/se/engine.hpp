@@ -58,6 +58,15 @@ namespace se {
              */
             se::logic::LogicController* logic_controller = nullptr;
 
+            /*!
+             *  Worker Thread Pool.
+             * 
+             *  Used for background work such as asset decoding.  The number of
+             *  workers is set by `engine.worker_threads` (zero selects one per
+             *  hardware thread, less one).
+             */
+            se::util::ThreadPool* worker_pool = nullptr;
+
             /*
              *  Create a new Engine Instance.
              */
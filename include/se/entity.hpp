@@ -9,7 +9,13 @@
 #ifndef _SE_ENTITY_H_
 #define _SE_ENTITY_H_
 
+#include "se/fwd.hpp"
+#include "se/componentStore.hpp"
+
 #include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <mutex>
+#include <vector>
 
 namespace se {
 
@@ -21,7 +27,9 @@ namespace se {
      */
     class Entity {
 
-        public:
+        private:
+
+            friend class se::ComponentStore;
 
             /// X position of this entity (meters)
             float x = 0.0;
@@ -44,6 +52,55 @@ namespace se {
             /// Scale along the z axis (multiplier)
             float sz = 1.0;
 
+            /// Component store this entity is bound to, if any
+            se::ComponentStore* components = nullptr;
+
+            /// Handle of this entity in its component store
+            se::ComponentHandle component_handle;
+
+            /// Parent entity, or null for root entities
+            Entity* parent = nullptr;
+
+            /// Child entities
+            std::vector<Entity*> children;
+
+            /// Cached local matrix
+            glm::mat4 local_matrix = glm::mat4(1.0);
+
+            /// Cached world (model) matrix
+            glm::mat4 world_matrix = glm::mat4(1.0);
+
+            /// Whether the local matrix needs to be recalculated
+            bool local_dirty = true;
+
+            /// Whether the world matrix needs to be recalculated
+            bool world_dirty = true;
+
+            /*!
+             *  Mark the world matrix of this entity and all of its descendants
+             *  as dirty.
+             * 
+             *  Stops at entities which are already dirty, because their
+             *  descendants must already be dirty too.
+             */
+            void invalidate_world();
+
+            /// Mark the local matrix dirty after the transform has changed
+            void invalidate_transform();
+
+            /*!
+             *  Lock the component store this entity is bound to.
+             * 
+             *  The logic thread reads the transforms and dirty flags of every
+             *  bound entity while updating the store, so changes made from
+             *  other threads are done while holding the store mutex.
+             * 
+             *  @return The lock, which owns nothing if the entity is unbound.
+             */
+            std::unique_lock<std::recursive_mutex> lock_components();
+
+        public:
+
             /*!
              *  Unique entity name.
              * 
@@ -69,9 +126,90 @@ namespace se {
              *  This method will only be called for renderable entities as
              *  determined by `is_renderable()`.
              * 
+             *  Entities must not read their own position, rotation, or scale
+             *  while rendering, because those are owned by the logic thread.
+             *  The model matrix is taken from the render snapshot instead.
+             * 
              *  @param camera_matrix    View and projection matrix
+             *  @param model_matrix     Model matrix
              */
-            virtual void render(glm::mat4 camera_matrix);
+            virtual void render(glm::mat4 camera_matrix, glm::mat4 model_matrix);
+
+            /*!
+             *  Record a draw command.
+             * 
+             *  Describes how to draw the entity without drawing it, so that
+             *  commands for many entities can be recorded in parallel and
+             *  replayed on the graphics thread.  Entities which do not
+             *  override this method are drawn with `render()` instead.
+             * 
+             *  **Warning:** This method is called from the logic thread when
+             *  the render snapshot is taken, after `select_lod()`, and the
+             *  command may be replayed up to a frame later.  It must not make
+             *  any OpenGL calls, or modify anything other than the command.
+             *  Entities drawn with `render()` are called back on the graphics
+             *  thread, so must not be deleted while a snapshot holding them
+             *  may still be drawn.
+             * 
+             *  @param model_matrix Model matrix of the entity.
+             *  @param command      Command to fill in.  The snapshot index is
+             *                      set by the render manager.
+             */
+            virtual void record(const glm::mat4& model_matrix,
+                se::graphics::DrawCommand& command);
+
+            /*!
+             *  Get the Render State.
+             * 
+             *  Describes the OpenGL state `render()` will bind, which is used
+             *  to order entities in the render queue.  Entities which do not
+             *  override this method are ordered by layer and distance only.
+             * 
+             *  @param state    State to fill in.
+             */
+            virtual void get_render_state(se::graphics::RenderState& state);
+
+            /*!
+             *  Get the world space bounds.
+             * 
+             *  Entities without bounds are never culled.
+             * 
+             *  @param model_matrix Model matrix of the entity.
+             *  @param center       Set to the bounding sphere center.
+             *  @param radius       Set to the bounding sphere radius.
+             * 
+             *  @return `true` if the entity has bounds.
+             */
+            virtual bool get_bounds(const glm::mat4& model_matrix,
+                glm::vec3& center, float& radius);
+
+            /*!
+             *  Get the occluder box.
+             * 
+             *  Occluders are rasterized by the software occlusion culler, and
+             *  hide whatever is behind them.  The box must lie entirely inside
+             *  the solid parts of the entity.
+             * 
+             *  @param min  Set to the model space minimum corner.
+             *  @param max  Set to the model space maximum corner.
+             * 
+             *  @return `true` if the entity is an occluder.
+             */
+            virtual bool get_occluder(glm::vec3& min, glm::vec3& max);
+
+            /*!
+             *  Select a level of detail.
+             * 
+             *  Called by the render manager from the logic thread when the
+             *  render snapshot is taken, before the entity is recorded.
+             *  Entities without levels of detail ignore this.
+             * 
+             *  @param model_matrix     Model matrix of the entity.
+             *  @param pixels_per_unit  Size on screen (in pixels) of one world
+             *                          unit at the entity's distance.
+             */
+            virtual void select_lod(const glm::mat4& model_matrix,
+                float pixels_per_unit);
 
             /*!
              *  Entity is Tickable.
@@ -107,6 +245,57 @@ namespace se {
             /// Entity Destructor
             virtual ~Entity();
 
+            /*!
+             *  Set the position (meters).
+             * 
+             *  While the entity is in a component store, the position,
+             *  rotation, and scale are stored there.
+             */
+            void set_position(float x, float y, float z);
+
+            /// Get the position (meters), relative to the parent
+            glm::vec3 get_position();
+
+            /// Set the rotation (radians)
+            void set_rotation(float rx, float ry, float rz);
+
+            /// Get the rotation (radians), relative to the parent
+            glm::vec3 get_rotation();
+
+            /// Set the scale (multiplier)
+            void set_scale(float sx, float sy, float sz);
+
+            /// Get the scale (multiplier), relative to the parent
+            glm::vec3 get_scale();
+
+            /*!
+             *  Set the parent entity.
+             * 
+             *  The position, rotation, and scale of this entity become
+             *  relative to the parent.  Parents must outlive their children, or
+             *  the children are detached when the parent is destroyed.
+             * 
+             *  @param parent   New parent, or null to detach this entity.
+             * 
+             *  @return `false` if the parent would create a cycle.
+             */
+            bool set_parent(Entity* parent);
+
+            /// Get the parent entity (may be null)
+            Entity* get_parent();
+
+            /// Get the child entities
+            const std::vector<Entity*>& get_children();
+
+            /*!
+             *  Get the Local Matrix.
+             * 
+             *  Transforms from model space into the space of the parent entity
+             *  (or world space for root entities).  Cached until the position,
+             *  rotation, or scale changes.
+             */
+            const glm::mat4& get_local_matrix();
+
             /*!
              *  Get the Model Matrix.
              * 
@@ -116,8 +305,16 @@ namespace se {
              *  provided by the camera entity.  Although any entity with a
              *  position in the world can be translated into camera space, this
              *  function only has real meaning for renderable entities.
+             * 
+             *  The matrix is cached.  Changing the transform of an entity
+             *  marks its subtree dirty, and dirty matrices are recalculated on
+             *  demand from the top of the dirty subtree down, so entities which
+             *  haven't moved cost nothing.
+             * 
+             *  **Warning:** This method is not thread safe, and must only be
+             *  called from the logic thread.
              */
-            glm::mat4 get_model_matrix();
+            const glm::mat4& get_model_matrix();
 
             /*!
              *  Set the entity name.
@@ -71,6 +71,17 @@ namespace se::entity {
              */
             glm::mat4 get_camera_matrix();
 
+            /*!
+             *  Get View Matrix.
+             * 
+             *  Transforms from world space into camera space, without the
+             *  projection.
+             */
+            glm::mat4 get_view_matrix();
+
+            /// Get Projection Matrix
+            glm::mat4 get_projection_matrix();
+
             /*!
              *  Get Skybox Matrix.
              * 
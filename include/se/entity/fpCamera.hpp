@@ -13,6 +13,7 @@
 #include "se/fwd.hpp"
 #include "se/logic/logicController.hpp"
 
+#include <atomic>
 #include <SDL2/SDL.h>
 
 namespace se::entity {
@@ -26,10 +27,19 @@ namespace se::entity {
 
             void sdl_event_handler(SDL_Event event);
 
-            bool key_w = false;
-            bool key_s = false;
-            bool key_a = false;
-            bool key_d = false;
+            std::atomic<bool> key_w = false;
+            std::atomic<bool> key_s = false;
+            std::atomic<bool> key_a = false;
+            std::atomic<bool> key_d = false;
+
+            /*!
+             *  Mouse movement since the last tick.
+             * 
+             *  The camera rotation is owned by the logic thread, so input
+             *  events only accumulate movement here and `tick()` applies it.
+             */
+            std::atomic<int> mouse_dx = 0;
+            std::atomic<int> mouse_dy = 0;
 
             /// Camera locked
             bool camera_locked = false;
@@ -52,7 +52,18 @@ namespace se::entity {
             ~Sign();
 
             /// Render the prop
-            void render(glm::mat4 camera_matrix);
+            void render(glm::mat4 camera_matrix, glm::mat4 model_matrix);
+
+            /// @see `se::Entity::record()`
+            void record(const glm::mat4& model_matrix,
+                se::graphics::DrawCommand& command);
+
+            /// @see `se::Entity::get_render_state()`
+            void get_render_state(se::graphics::RenderState& state);
+
+            /// @see `se::Entity::get_bounds()`
+            bool get_bounds(const glm::mat4& model_matrix, glm::vec3& center,
+                float& radius);
 
             /// Signs are renderable
             bool is_renderable() { return true; }
@@ -57,7 +57,14 @@ namespace se::entity {
             ~Skybox();
 
             /// Render the skybox
-            void render(glm::mat4 camera_matrix);
+            void render(glm::mat4 camera_matrix, glm::mat4 model_matrix);
+
+            /// @see `se::Entity::record()`
+            void record(const glm::mat4& model_matrix,
+                se::graphics::DrawCommand& command);
+
+            /// @see `se::Entity::get_render_state()`
+            void get_render_state(se::graphics::RenderState& state);
 
             /// Skyboxes are renderable
             bool is_renderable() { return true; }
@@ -28,6 +28,12 @@ namespace se::entity {
             /// Program used for rendering this prop
             se::graphics::ShaderProgram* shader_program;
 
+            /*!
+             *  Program used for rendering this prop as part of an instanced
+             *  batch.  Null if instancing is disabled (`render.instancing`).
+             */
+            se::graphics::ShaderProgram* instanced_program = nullptr;
+
             /// Geometry of this prop
             se::graphics::Geometry* geometry;
 
@@ -39,7 +45,19 @@ namespace se::entity {
              *  be replaced by a more configurable system with multiple types
              *  of textures to be applied to models.
              */
-            se::graphics::ImageTexture* texture;
+            se::graphics::ImageTexture* texture = nullptr;
+
+            /*!
+             *  Texture array layer to be applied to this prop.
+             * 
+             *  Used instead of `texture` when texture arrays are enabled, so
+             *  that props with different textures can be drawn without
+             *  switching textures.
+             */
+            se::graphics::TextureLayer* texture_layer = nullptr;
+
+            /// Texture resource, either `texture` or `texture_layer`
+            se::util::LoadableResource* texture_resource;
 
             /*!
              *  Model Name.
@@ -58,6 +76,21 @@ namespace se::entity {
             /// Parent Engine.
             se::Engine* engine;
 
+            /// Whether this prop is an occluder
+            bool occluder = false;
+
+            /// Whether the occluder box was set with `set_occluder_box()`
+            bool occluder_box_set = false;
+
+            /// Model space occluder box minimum corner
+            glm::vec3 occluder_min;
+
+            /// Model space occluder box maximum corner
+            glm::vec3 occluder_max;
+
+            /// Selected level of detail (logic thread only)
+            unsigned int lod = 0;
+
         public:
 
             /// Construct a static prop
@@ -67,7 +100,70 @@ namespace se::entity {
             ~StaticProp();
 
             /// Render the prop
-            void render(glm::mat4 camera_matrix);
+            void render(glm::mat4 camera_matrix, glm::mat4 model_matrix);
+
+            /// @see `se::Entity::record()`
+            void record(const glm::mat4& model_matrix,
+                se::graphics::DrawCommand& command);
+
+            /// @see `se::Entity::get_render_state()`
+            void get_render_state(se::graphics::RenderState& state);
+
+            /// @see `se::Entity::get_bounds()`
+            bool get_bounds(const glm::mat4& model_matrix, glm::vec3& center,
+                float& radius);
+
+            /*!
+             *  Get the occluder box.
+             * 
+             *  The box is rasterized as solid.  Unless one was set with
+             *  `set_occluder_box()`, the bounding box of the geometry is used,
+             *  which is only correct for box shaped props (walls, floors).
+             * 
+             *  @see `se::Entity::get_occluder()`
+             */
+            bool get_occluder(glm::vec3& min, glm::vec3& max);
+
+            /// Set whether this prop is an occluder
+            void set_occluder(bool occluder);
+
+            /*!
+             *  Set the occluder box.
+             * 
+             *  Props which aren't box shaped must be given a box which lies
+             *  entirely inside their solid parts, or they will hide things
+             *  which should be visible through or around them.
+             * 
+             *  @param min  Model space minimum corner.
+             *  @param max  Model space maximum corner.
+             */
+            void set_occluder_box(glm::vec3 min, glm::vec3 max);
+
+            /// @see `se::Entity::select_lod()`
+            void select_lod(const glm::mat4& model_matrix, float pixels_per_unit);
+
+            /// Get the selected level of detail
+            unsigned int get_lod();
+
+            /*!
+             *  Check if the prop is ready to be batched.
+             * 
+             *  @return `true` once the geometry, texture, and instanced program
+             *  (if any) have all been loaded.
+             */
+            bool is_ready_for_batching();
+
+            /// Get the geometry
+            se::graphics::Geometry* get_geometry();
+
+            /// Get the texture, or `nullptr` if the prop uses a texture layer
+            se::graphics::ImageTexture* get_texture();
+
+            /// Get the texture layer, or `nullptr` if the prop uses a texture
+            se::graphics::TextureLayer* get_texture_layer();
+
+            /// Get the instanced program, or `nullptr`
+            se::graphics::ShaderProgram* get_instanced_program();
 
             /// Static props are renderable
             bool is_renderable() { return true; }
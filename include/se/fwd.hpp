@@ -13,6 +13,7 @@
 
 namespace se {
     
+    class ComponentStore;
     class Engine;
     class Entity;
     class Scene;
@@ -27,18 +28,33 @@ namespace se {
 
     namespace graphics {
 
+        class CommandList;
+        struct DrawCommand;
         class Framebuffer;
         class Geometry;
+        class GLState;
         class GraphicsController;
         class GraphicsEventHandler;
+        class GraphicsTaskCompletion;
         class ImageTexture;
+        class InstancedRenderer;
+        class OcclusionCuller;
         class RenderManager;
+        class RenderQueue;
+        struct RenderSnapshot;
+        struct RenderSnapshotItem;
+        struct RenderState;
         class SimpleRenderManager;
         class Screen;
         class Shader;
         class ShaderProgram;
+        class StreamBuffer;
         class Texture;
         class TextTexture;
+        class TextureArray;
+        class TextureArrayManager;
+        class TextureLayer;
+        class TextureStreamer;
 
         #ifdef SE_ENABLE_QT_WIDGET_SUPPORT
         class QTSilhouetteWidget;
@@ -63,6 +79,9 @@ namespace se {
 
         class Configuration;
         class ConfigurationValue;
+        class LoadableResource;
+        class MappedFile;
+        class ThreadPool;
         
     }
 
@@ -0,0 +1,129 @@
+/*!
+ *  @file include/se/graphics/commandList.hpp
+ * 
+ *  Draw commands recorded off the graphics thread.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_GRAPHICS_COMMANDLIST_H_
+#define _SE_GRAPHICS_COMMANDLIST_H_
+
+#include "se/fwd.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace se::graphics {
+
+    /// Draw Command Type
+    enum class DrawCommandType : uint8_t {
+        /// Nothing to draw, the entity's resources aren't loaded yet
+        SKIP,
+        /// Call `se::Entity::render()` on the graphics thread
+        RENDER,
+        /// Draw the geometry with the program and texture
+        DRAW,
+        /// Add an instance to the instanced renderer
+        INSTANCED
+    };
+
+    /*!
+     *  Draw Command.
+     * 
+     *  Everything needed to draw one entity, without any OpenGL state.  The
+     *  model matrix isn't copied, it is read from the render snapshot item
+     *  when the command is replayed.  Only one of `texture` and
+     *  `texture_layer` is set.
+     */
+    struct DrawCommand {
+        /*!
+         *  Upload the model matrix as a uniform before drawing.  This costs
+         *  one `glUniformMatrix4fv()` call per draw, only instanced commands
+         *  read their matrix from the instance buffer.
+         */
+        static const uint8_t MODEL_MATRIX = 0x1;
+        /// Draw without writing to the depth buffer
+        static const uint8_t NO_DEPTH_WRITE = 0x2;
+
+        /// Index of the item in the render snapshot
+        uint32_t index = 0;
+        /// Geometry level of detail
+        uint16_t lod = 0;
+        /// Command type
+        DrawCommandType type = DrawCommandType::RENDER;
+        /// Command flags
+        uint8_t flags = MODEL_MATRIX;
+        /// Shader program
+        ShaderProgram* program = nullptr;
+        /// Shader program used when the command is drawn as part of a batch
+        ShaderProgram* instanced_program = nullptr;
+        /// Geometry
+        Geometry* geometry = nullptr;
+        /// Texture
+        Texture* texture = nullptr;
+        /// Texture array layer
+        TextureLayer* texture_layer = nullptr;
+    };
+
+    /*!
+     *  Command List.
+     * 
+     *  Draw commands are recorded into command lists on worker threads, one
+     *  list per thread, and the lists are replayed in order on the graphics
+     *  thread.  Replaying a command only binds resources and draws; readiness
+     *  checks and level of detail selection have already been done.
+     * 
+     *  **Warning:** A command list must only be used by one thread at a time,
+     *  and must only be replayed from the graphics thread.
+     */
+    class CommandList {
+
+        private:
+
+            /// Recorded commands
+            std::vector<DrawCommand> commands;
+
+        public:
+
+            /// Remove all commands
+            void clear();
+
+            /// Add a command
+            void push(const DrawCommand& command);
+
+            /// Get the number of commands
+            size_t size();
+
+            /*!
+             *  Replay the commands.
+             * 
+             *  @param snapshot             Snapshot the commands were recorded
+             *                              from.
+             *  @param instanced_renderer   Renderer which instanced commands
+             *                              are submitted to.  If null, they
+             *                              are drawn individually.
+             */
+            void replay(const RenderSnapshot& snapshot,
+                InstancedRenderer* instanced_renderer);
+
+            /*!
+             *  Execute a single command.
+             * 
+             *  @param snapshot             Snapshot the command was recorded
+             *                              from.
+             *  @param command              Command to execute.
+             *  @param instanced_renderer   Renderer which instanced commands
+             *                              are submitted to.  If null, they
+             *                              are drawn individually.
+             */
+            static void execute(const RenderSnapshot& snapshot,
+                const DrawCommand& command, InstancedRenderer* instanced_renderer);
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+/*!
+ *  @file include/se/graphics/frameUniforms.hpp
+ * 
+ *  Uniform buffer for values shared by every shader in a frame.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_GRAPHICS_FRAMEUNIFORMS_H_
+#define _SE_GRAPHICS_FRAMEUNIFORMS_H_
+
+#include "se/fwd.hpp"
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+namespace se::graphics {
+
+    /*!
+     *  Frame Uniforms.
+     * 
+     *  Laid out to match the std140 `SEFrameUniforms` block declared in every
+     *  shader (see `shader.cpp`), which is available to GLSL as `frame`.
+     *  Changing this structure requires changing the block too.
+     */
+    struct FrameUniforms {
+        /// World to camera space
+        glm::mat4 view;
+        /// Camera to clip space
+        glm::mat4 projection;
+        /// World to clip space
+        glm::mat4 view_projection;
+        /// Inverse of `view`
+        glm::mat4 inverse_view;
+        /// Inverse of `projection`
+        glm::mat4 inverse_projection;
+        /// Inverse of `view_projection`
+        glm::mat4 inverse_view_projection;
+        /// Viewport width, height, 1 / width, 1 / height (pixels)
+        glm::vec4 viewport;
+        /// Camera position (w is unused)
+        glm::vec4 camera_position;
+        /// Time since rendering began (seconds)
+        float time;
+        /// Camera near render boundary
+        float camera_near;
+        /// Camera far render boundary
+        float camera_far;
+        /// Number of MSAA samples
+        int32_t msaa_level;
+    };
+
+    static_assert(sizeof(FrameUniforms) == 432,
+        "FrameUniforms must match the std140 layout of SEFrameUniforms");
+
+    /*!
+     *  Frame Uniform Buffer.
+     * 
+     *  Holds the frame uniforms on the GPU.  The buffer is written once per
+     *  frame and bound to `SE_SHADER_BINDING_FRAME`, which every program
+     *  shares, so programs don't need any per-frame uniforms of their own.
+     * 
+     *  **Warning:** This class must only be used from the graphics thread.
+     */
+    class FrameUniformBuffer {
+
+        private:
+
+            /// OpenGL buffer ID
+            unsigned int gl_buffer_id = 0;
+
+        public:
+
+            /*!
+             *  Update the buffer.
+             * 
+             *  Uploads the uniforms and binds the buffer for the rest of the
+             *  frame.
+             */
+            void update(const FrameUniforms& uniforms);
+
+    };
+
+}
+
+#endif
@@ -10,6 +10,7 @@
 #define _SE_GRAPHICS_FRAMEBUFFER_H_
 
 #include "se/fwd.hpp"
+#include "se/graphics/graphicsTask.hpp"
 
 #include "GL/glew.h"
 
@@ -58,6 +59,9 @@ namespace se::graphics {
             /// Status.
             FramebufferState state = FramebufferState::NOT_INITIALIZED;
 
+            /// Handle for the most recently submitted initialization task
+            GraphicsTaskHandle init_handle;
+
             /*!
              *  Framebuffer initialization method.
              * 
@@ -92,10 +96,16 @@ namespace se::graphics {
              *  internal textures will be handled.  By default this value is set
              *  to `GL_REPEAT`.
              * 
-             *  @param engine   Parent engine
-             *  @param textures Textures to include in the buffer
+             *  Texture dimensions are read when the buffer is initialized, so
+             *  whatever sets them must be passed as a dependency.
+             * 
+             *  @param engine       Parent engine
+             *  @param textures     Textures to include in the buffer
+             *  @param dependencies Tasks which must complete before the buffer
+             *                      is initialized
              */
-            Framebuffer(Engine* engine, std::vector<Texture*> textures);
+            Framebuffer(Engine* engine, std::vector<Texture*> textures,
+                std::vector<GraphicsTaskHandle> dependencies = {});
 
             /// Destroy the framebuffer
             ~Framebuffer();
@@ -108,6 +118,20 @@ namespace se::graphics {
              */
             void use_as_target();
 
+            /*!
+             *  Wait for initialization to complete.
+             * 
+             *  Blocks until the most recently submitted initialization task
+             *  has completed, and returns the resulting state.  This method
+             *  must not be called from the graphics thread.
+             */
+            FramebufferState wait_for_init();
+
+            /*!
+             *  Get the initialization task handle.
+             */
+            GraphicsTaskHandle get_init_handle();
+
     };
 
 }
@@ -13,15 +13,117 @@
 #include "se/util/loadableResource.hpp"
 
 #include "se/fwd.hpp"
+#include "se/graphics/graphicsTask.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
 #include <vector>
+#include <glm/mat4x4.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
 namespace se::graphics {
 
+    /*!
+     *  Vertex Format.
+     * 
+     *  Layout of the interleaved vertex buffer.  All formats contain the same
+     *  attributes; the compact formats trade some precision for size.  The
+     *  format is selected by the `render.vertex_format` configuration value
+     *  (`float`, `compact`, or `quantized`).
+     */
+    enum class VertexFormat {
+        /// 32 bytes, `float` position, uv, and normal
+        FLOAT,
+        /*!
+         *  20 bytes, `float` position, `half` uv, and `GL_INT_2_10_10_10_REV`
+         *  normal.
+         */
+        COMPACT,
+        /*!
+         *  16 bytes, as `COMPACT`, but with positions quantized to 16 bit
+         *  unsigned normalized integers within the bounding box of the
+         *  geometry.  Shaders must dequantize positions using the
+         *  `LOC_IN_POS_SCALE` and `LOC_IN_POS_OFFSET` uniforms.
+         */
+        QUANTIZED
+    };
+
+    /// Get the name of a vertex format
+    const char* vertex_format_name(VertexFormat format);
+
+    /*!
+     *  Geometry Vertex.
+     * 
+     *  Full precision vertex, used while building geometry before it is
+     *  packed into the selected vertex format.
+     */
+    struct GeometryVertex {
+        /// Vertex position
+        glm::vec3 position;
+        /// Texture coordinate
+        glm::vec2 uv;
+        /// Vertex normal
+        glm::vec3 normal;
+    };
+
+    /*!
+     *  Geometry Bounds.
+     * 
+     *  Model space bounding volumes.  The sphere is centered on the box, with
+     *  the smallest radius which contains every vertex.
+     */
+    struct GeometryBounds {
+        /// Bounding box minimum corner
+        glm::vec3 min = glm::vec3(0.0, 0.0, 0.0);
+        /// Bounding box maximum corner
+        glm::vec3 max = glm::vec3(0.0, 0.0, 0.0);
+        /// Bounding sphere center
+        glm::vec3 center = glm::vec3(0.0, 0.0, 0.0);
+        /// Bounding sphere radius
+        float radius = 0.0;
+    };
+
+    /*!
+     *  Geometry Level of Detail.
+     * 
+     *  A range of the index buffer.  Every level shares the same vertices, the
+     *  coarser levels just reference fewer of them.
+     */
+    struct GeometryLOD {
+        /// First index
+        uint32_t index_offset = 0;
+        /// Number of indices
+        uint32_t index_count = 0;
+        /// Model space geometric error, relative to the full detail mesh
+        float error = 0.0;
+    };
+
+    /*!
+     *  Geometry Instance.
+     * 
+     *  Per-instance data read from the instance buffer by instanced draws (see
+     *  `Geometry::use_geometry_instanced()`).
+     */
+    struct GeometryInstance {
+        /// Model matrix
+        glm::mat4 model;
+        /// Texture array layer
+        uint32_t layer;
+    };
+
     /*!
      *  Geometry Class.
+     * 
+     *  Geometry is stored as a deduplicated, interleaved vertex buffer and an
+     *  index buffer, with triangles ordered for post-transform vertex cache
+     *  efficiency.
+     * 
+     *  The index buffer holds a chain of levels of detail, generated by mesh
+     *  simplification when the geometry is first parsed and stored in the
+     *  mesh cache.  Level 0 is the full detail mesh.
      */
     class Geometry : public se::util::CacheableResource, public se::util::LoadableResource {
 
@@ -47,23 +149,57 @@ namespace se::graphics {
             /*!
              *  Raw Vertex Data.
              * 
-             *  This variable may be cleared after binding.
+             *  Full precision vertices, cleared once they have been packed.
              */
-            std::vector<glm::vec3> vertex_data;
-            
+            std::vector<GeometryVertex> vertex_data;
+
             /*!
-             *  Raw UV Data.
+             *  Packed Vertex Data.
              * 
-             *  This variable may be cleared after binding.
+             *  Vertices in the selected vertex format.  This variable may be
+             *  cleared after binding.
              */
-            std::vector<glm::vec2> uv_data;
+            std::vector<uint8_t> packed_vertex_data;
+
+            /// Vertex format
+            VertexFormat vertex_format = VertexFormat::FLOAT;
+
+            /// Size of each packed vertex in bytes
+            unsigned int vertex_size = sizeof(GeometryVertex);
+
+            /// Position dequantization scale
+            glm::vec3 position_scale = glm::vec3(1.0, 1.0, 1.0);
+
+            /// Position dequantization offset
+            glm::vec3 position_offset = glm::vec3(0.0, 0.0, 0.0);
+
+            /// Model space bounds
+            GeometryBounds bounds;
 
             /*!
-             *  Raw Normal Data.
+             *  Raw Index Data.
              * 
-             *  This variable may be cleared after binding.
+             *  Indices are stored as 16 bit values if there are few enough
+             *  vertices, otherwise as 32 bit values (see `index_size`).  This
+             *  variable may be cleared after binding.
+             */
+            std::vector<uint8_t> index_data;
+
+            /// Levels of detail, from finest to coarsest
+            std::vector<GeometryLOD> lods;
+
+            /*!
+             *  Acceptable projected error in pixels when selecting a level of
+             *  detail (`render.lod_error_pixels`).  Zero disables level of
+             *  detail selection.
              */
-            std::vector<glm::vec3> normal_data;
+            const volatile float* lod_error_pixels;
+
+            /// Total number of triangles drawn
+            static uint64_t stat_triangles_drawn;
+
+            /// Total number of triangles that would have been drawn at full detail
+            static uint64_t stat_triangles_full;
 
             /// OpenGL vertex array object ID
             unsigned int gl_vertex_array_object_id = 0;
@@ -71,14 +207,61 @@ namespace se::graphics {
             /// OpenGL vertex buffer ID
             unsigned int gl_vertex_buffer_id = 0;
 
-            /// OpenGL uv buffer ID
-            unsigned int gl_uv_buffer_id = 0;
+            /// OpenGL index buffer ID
+            unsigned int gl_index_buffer_id = 0;
+
+            /*!
+             *  Instance buffer the vertex array object's instance attributes
+             *  currently point at, or 0 if they have not been configured.
+             */
+            unsigned int gl_instance_buffer_id = 0;
+
+            /// Generation of `gl_instance_buffer_id` (see
+            /// `StreamBuffer::get_generation()`)
+            uint64_t gl_instance_buffer_generation = 0;
+
+            /// Number of unique vertices
+            unsigned int vertex_count = 0;
+
+            /// Number of indices, for every level of detail
+            unsigned int index_count = 0;
+
+            /// Size of each index in bytes (2 or 4)
+            unsigned int index_size = 4;
 
-            /// OpenGL normal buffer ID
-            unsigned int gl_normal_buffer_id = 0;
+            /// Handle for the most recently submitted binding task
+            GraphicsTaskHandle bind_handle;
 
-            /// Size of the vertex array
-            unsigned int vertex_array_size = 0;
+            /*!
+             *  Mesh Cache Mapping.
+             * 
+             *  If the geometry was loaded from the mesh cache, this is the
+             *  mapping the GPU data is uploaded from.  The mapping is released
+             *  after binding.
+             */
+            se::util::MappedFile* mesh_cache = nullptr;
+
+            /// Held by the worker for the whole decode, so decodes never overlap
+            std::mutex decode_mutex;
+
+            /*!
+             *  State Mutex.
+             * 
+             *  Guards the load generation and resource state, and is held while
+             *  binding so that a newer load (and its decode) can't start until
+             *  the bind is done.  It is never held across a decode, so the
+             *  graphics thread never waits on one.
+             */
+            std::mutex state_mutex;
+
+            /*!
+             *  Load Generation.
+             * 
+             *  Incremented by every load and unload.  Decodes and binds which
+             *  were started by an earlier load see a different generation, and
+             *  are dropped.  Binds check it before taking any lock.
+             */
+            std::atomic<uint32_t> load_generation = 0;
 
             /*!
              *  Bind geometry to the GPU.
@@ -96,6 +279,90 @@ namespace se::graphics {
              */
             void unbind();
 
+            /*!
+             *  Read and parse the geometry file.
+             * 
+             *  **Warning:** This method is executed on the worker pool, and
+             *  must not touch any OpenGL state.
+             * 
+             *  @return `false` if the file could not be read.
+             */
+            bool decode();
+
+            /*!
+             *  Read the mesh cache.
+             * 
+             *  Maps the compiled mesh cache file, if it exists and matches the
+             *  given source file metadata.
+             * 
+             *  @return `true` if the cache is valid and has been mapped.
+             */
+            bool read_cache(std::string cache_fname, int64_t source_mtime_ns,
+                uint64_t source_size);
+
+            /*!
+             *  Write the mesh cache.
+             * 
+             *  Saves the parsed data as a compiled mesh for future loads.
+             *  Failure to write the cache is not an error.
+             */
+            void write_cache(std::string cache_fname, int64_t source_mtime_ns,
+                uint64_t source_size);
+
+            /*!
+             *  Parse an OBJ file.
+             * 
+             *  The file is mapped and parsed with `se::graphics::obj::parse()`
+             *  (in parallel on the worker pool, for large files).  Faces are
+             *  converted into an indexed triangle list, merging corners which
+             *  share the same position, uv, and normal.  Corners without a
+             *  normal are given a smooth normal.
+             * 
+             *  @return `true` on success, `false` if the file could not be
+             *  read or is unsupported.
+             */
+            bool parse_obj(std::string fname);
+
+            /*!
+             *  Optimize and pack indexed geometry.
+             * 
+             *  Reorders triangles for the post-transform vertex cache, then
+             *  reorders vertices by first use (for pre-transform fetch
+             *  locality), generates the levels of detail, and packs the
+             *  indices to the smallest suitable width.  The savings are
+             *  logged.
+             * 
+             *  @param indices  32 bit indices produced by the parser.
+             */
+            void optimize(std::vector<uint32_t>& indices);
+
+            /*!
+             *  Generate the levels of detail.
+             * 
+             *  Each level aims for half the triangles of the one before it,
+             *  simplified from the full detail mesh.  Generation stops once
+             *  the simplifier can no longer make meaningful progress.
+             * 
+             *  @param indices  Full detail indices.  The coarser levels are
+             *                  appended.
+             */
+            void generate_lods(std::vector<uint32_t>& indices);
+
+            /*!
+             *  Compute the bounds.
+             * 
+             *  Must be called before the vertices are packed.
+             */
+            void compute_bounds();
+
+            /*!
+             *  Pack vertices.
+             * 
+             *  Converts `vertex_data` into `packed_vertex_data` using the
+             *  given vertex format.
+             */
+            void pack_vertices(VertexFormat format);
+
         protected:
 
             /// @see `se::util::LoadableResource::load_()`
@@ -126,8 +393,94 @@ namespace se::graphics {
              * 
              *  **Warning:** This method must be called from the graphics
              *  thread.
+             * 
+             *  @param lod  Level of detail to draw.
+             */
+            void use_geometry(unsigned int lod = 0);
+
+            /*!
+             *  Draw instances of this Geometry.
+             * 
+             *  Instance attributes (`SE_SHADER_LOC_IN_INSTANCE_MODEL` and
+             *  `SE_SHADER_LOC_IN_INSTANCE_LAYER`) are read from the given
+             *  buffer, which must contain `GeometryInstance` structures.
+             * 
+             *  **Warning:** This method must be called from the graphics
+             *  thread.
+             * 
+             *  @param instance_buffer  OpenGL instance buffer ID.
+             *  @param generation       Instance buffer generation, which must
+             *                          change whenever a buffer ID might have
+             *                          been reused (0 for buffers which are
+             *                          never deleted).
+             *  @param first_instance   Index of the first instance to draw.
+             *  @param instance_count   Number of instances to draw.
+             *  @param lod              Level of detail to draw.
+             */
+            void use_geometry_instanced(unsigned int instance_buffer,
+                uint64_t generation, unsigned int first_instance, unsigned int instance_count,
+                unsigned int lod = 0);
+
+            /*!
+             *  Wait for loading to complete.
+             * 
+             *  Blocks until the most recently submitted binding task has
+             *  completed, and returns the resulting resource state.  This
+             *  method must not be called from the graphics thread.
+             */
+            se::util::LoadableResourceState wait_for_loading();
+
+            /*!
+             *  Get the binding task handle.
+             * 
+             *  Null if the geometry has never been submitted for binding.
+             */
+            GraphicsTaskHandle get_bind_handle();
+
+            /// Get the vertex format
+            VertexFormat get_vertex_format();
+
+            /// Get the size of each vertex in bytes
+            unsigned int get_vertex_size();
+
+            /*!
+             *  Get the model space bounds.
+             * 
+             *  Only meaningful once the geometry has been loaded.
+             */
+            GeometryBounds get_bounds();
+
+            /// Get the number of levels of detail (at least 1 once loaded)
+            unsigned int get_lod_count();
+
+            /*!
+             *  Select a level of detail.
+             * 
+             *  Picks the coarsest level whose error projects to no more than
+             *  `render.lod_error_pixels`.  The level only changes once the
+             *  projected error moves a margin past the threshold, so objects
+             *  sitting near a switching distance don't flicker between
+             *  levels.
+             * 
+             *  @param pixels_per_unit  Size on screen (in pixels) of one model
+             *                          space unit at the object's distance.
+             *  @param current          Currently selected level.
+             * 
+             *  @return The level to draw.
+             */
+            unsigned int select_lod(float pixels_per_unit, unsigned int current);
+
+            /*!
+             *  Get the triangle statistics.
+             * 
+             *  **Warning:** This method must be called from the graphics
+             *  thread.
+             * 
+             *  @param drawn    Set to the total number of triangles drawn.
+             *  @param full     Set to the total number of triangles which
+             *                  would have been drawn without levels of detail.
              */
-            void use_geometry();
+            static void get_triangle_stats(uint64_t& drawn, uint64_t& full);
 
     };
 
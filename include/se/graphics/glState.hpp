@@ -0,0 +1,183 @@
+/*!
+ *  @file include/se/graphics/glState.hpp
+ * 
+ *  Render thread OpenGL state cache.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_GRAPHICS_GLSTATE_H_
+#define _SE_GRAPHICS_GLSTATE_H_
+
+#include "se/fwd.hpp"
+
+#include <GL/glew.h>
+#include <cstdint>
+
+namespace se::graphics {
+
+    /*!
+     *  OpenGL State Statistics.
+     * 
+     *  A call is elided when the requested state was already set, so nothing
+     *  was sent to the driver.
+     */
+    struct GLStateStats {
+        /// State changes sent to the driver
+        uint32_t issued = 0;
+        /// State changes skipped because they were redundant
+        uint32_t elided = 0;
+    };
+
+    /*!
+     *  OpenGL State Cache.
+     * 
+     *  Every bind and enable made by the engine goes through this class, which
+     *  remembers the current state of the context and skips calls that
+     *  wouldn't change it.  Objects must also be deleted through this class,
+     *  so that a new object which reuses a deleted name isn't mistaken for the
+     *  old one.
+     * 
+     *  State starts out unknown, so the first call of each kind is always
+     *  issued.  Anything which changes the context behind the engine's back
+     *  (such as a Qt widget binding its own framebuffer) must be followed by
+     *  `invalidate()`.
+     * 
+     *  Buffer targets other than `GL_ARRAY_BUFFER`, `GL_PIXEL_UNPACK_BUFFER`,
+     *  and `GL_UNIFORM_BUFFER` are passed straight through.  In particular the
+     *  `GL_ELEMENT_ARRAY_BUFFER` binding is vertex array state and is never
+     *  cached.  The same goes for capabilities other than depth testing,
+     *  blending, and face culling.
+     * 
+     *  **Warning:** The state is kept per thread, and this class must only be
+     *  used from the graphics thread.
+     */
+    class GLState {
+
+        private:
+
+            /// Number of texture units tracked
+            static const unsigned int TEXTURE_UNIT_COUNT = 32;
+
+            /// Value of a binding which is not known
+            static const unsigned int UNKNOWN = UINT32_MAX;
+
+            /// Current program
+            static thread_local unsigned int program;
+
+            /// Current active texture unit (`GL_TEXTUREi`)
+            static thread_local unsigned int active_texture;
+
+            /// Target of the last texture bound to each unit
+            static thread_local unsigned int texture_targets[TEXTURE_UNIT_COUNT];
+
+            /// Last texture bound to each unit
+            static thread_local unsigned int textures[TEXTURE_UNIT_COUNT];
+
+            /// Current vertex array object
+            static thread_local unsigned int vertex_array;
+
+            /// Current framebuffer
+            static thread_local unsigned int framebuffer;
+
+            /// Current `GL_ARRAY_BUFFER`, `GL_PIXEL_UNPACK_BUFFER`, and
+            /// `GL_UNIFORM_BUFFER` bindings
+            static thread_local unsigned int buffers[3];
+
+            /// Depth test, blend, and face culling state (-1 if unknown)
+            static thread_local int8_t capabilities[3];
+
+            /// Current depth write mask (-1 if unknown)
+            static thread_local int8_t depth_write;
+
+            /// Current color write mask (-1 if unknown)
+            static thread_local int8_t color_write;
+
+            /// Current depth function
+            static thread_local unsigned int depth_function;
+
+            /// Calls issued and elided since the start of the frame
+            static thread_local GLStateStats frame_stats;
+
+            /// Get the cache index of a buffer target, or -1
+            static int buffer_index(GLenum target);
+
+            /// Get the cache index of a capability, or -1
+            static int capability_index(GLenum cap);
+
+            /// Compare and update a cached value, counting the result
+            static bool update(unsigned int& cached, unsigned int value);
+
+        public:
+
+            /*!
+             *  Forget the entire state.
+             * 
+             *  Every call after this is issued until the state is known again.
+             */
+            static void invalidate();
+
+            /// Reset the frame statistics
+            static void begin_frame();
+
+            /// Get the number of calls issued and elided since `begin_frame()`
+            static GLStateStats get_frame_stats();
+
+            /// `glUseProgram()`
+            static void use_program(unsigned int program);
+
+            /*!
+             *  `glActiveTexture()` and `glBindTexture()`.
+             * 
+             *  @param unit     Texture unit (`GL_TEXTUREi`).
+             *  @param target   Texture target.
+             *  @param texture  Texture ID.
+             */
+            static void bind_texture(GLenum unit, GLenum target, unsigned int texture);
+
+            /// `glBindTexture()` on the active texture unit
+            static void bind_texture(GLenum target, unsigned int texture);
+
+            /// `glBindVertexArray()`
+            static void bind_vertex_array(unsigned int vertex_array);
+
+            /// `glBindFramebuffer()` with `GL_FRAMEBUFFER`
+            static void bind_framebuffer(unsigned int framebuffer);
+
+            /// `glBindBuffer()`
+            static void bind_buffer(GLenum target, unsigned int buffer);
+
+            /// `glEnable()` or `glDisable()`
+            static void set_enabled(GLenum cap, bool enabled);
+
+            /// `glDepthMask()`
+            static void depth_mask(bool enabled);
+
+            /// `glColorMask()`, with the same value for every channel
+            static void color_mask(bool enabled);
+
+            /// `glDepthFunc()`
+            static void depth_func(GLenum function);
+
+            /// `glDeleteProgram()`
+            static void delete_program(unsigned int program);
+
+            /// `glDeleteTextures()`
+            static void delete_textures(int count, const unsigned int* textures);
+
+            /// `glDeleteVertexArrays()`
+            static void delete_vertex_arrays(int count, const unsigned int* vertex_arrays);
+
+            /// `glDeleteFramebuffers()`
+            static void delete_framebuffers(int count, const unsigned int* framebuffers);
+
+            /// `glDeleteBuffers()`
+            static void delete_buffers(int count, const unsigned int* buffers);
+
+    };
+
+}
+
+#endif
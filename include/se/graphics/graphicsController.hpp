@@ -13,23 +13,90 @@
 
 #include "se/fwd.hpp"
 #include "se/graphics/graphicsEventHandler.hpp"
+#include "se/graphics/graphicsTask.hpp"
+#include "se/util/mpscQueue.hpp"
 
 #include <SDL2/SDL.h>
 #include <GL/glew.h>
 #include <SDL2/SDL_opengl.h>
 #include <GL/glu.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <thread>
-#include <functional>
-#include <queue>
+#include <unordered_map>
+#include <vector>
 
 namespace se::graphics {
 
     /*!
-     *  Render Thread Task.
+     *  Graphics Task Statistics.
+     *
+     *  Snapshot of the graphics task queue performance counters.
+     */
+    struct GraphicsTaskStats {
+        /// Number of tasks waiting in the queue
+        size_t pending = 0;
+        /// Number of tasks executed during the last frame
+        uint32_t frame_task_count = 0;
+        /// Time spent executing tasks during the last frame (nanoseconds)
+        uint64_t frame_task_time_ns = 0;
+        /// Total number of tasks executed
+        uint64_t total_task_count = 0;
+        /// Total time spent executing tasks (nanoseconds)
+        uint64_t total_task_time_ns = 0;
+        /// Tasks executed per second, averaged over the last second
+        float drain_rate = 0.0;
+        /// Number of tasks merged into an already pending task
+        uint64_t merged_task_count = 0;
+        /// Number of tasks dropped without being executed at shutdown
+        uint64_t dropped_task_count = 0;
+    };
+
+    /*!
+     *  Queued Graphics Task.
+     * 
+     *  A task waiting in the graphics task queue, along with the completion
+     *  object which will be signalled once it has been executed.
+     */
+    struct QueuedGraphicsTask {
+        /// Task to execute
+        GraphicsTask task;
+        /// Completion handle
+        GraphicsTaskHandle handle;
+        /*!
+         *  Coalescing key.
+         * 
+         *  If nonzero, the task and handle are empty and the actual task is
+         *  stored in the controllers coalesced task table.
+         */
+        GraphicsTaskKey coalesce_key = 0;
+        /*!
+         *  Marker sequence number.
+         * 
+         *  Promoting a coalesced task queues a new marker at the higher
+         *  priority, leaving the old one behind.  Only the marker whose number
+         *  matches the table entry is live; the rest are skipped.
+         */
+        uint64_t sequence = 0;
+    };
+
+    /*!
+     *  Coalesced Graphics Task.
      * 
-     *  Represents a task that needs to be executed on the render thread.
+     *  The most recently submitted task for a coalescing key, along with the
+     *  completion objects for every submission which was merged into it.
      */
-    typedef std::function<void(void)> GraphicsTask;
+    struct CoalescedGraphicsTask {
+        /// Task to execute
+        GraphicsTask task;
+        /// Completion handles
+        std::vector<GraphicsTaskHandle> handles;
+        /// Highest priority the task was submitted with
+        GraphicsTaskPriority priority = GraphicsTaskPriority::NORMAL;
+        /// Sequence number of the live queue marker
+        uint64_t sequence = 0;
+    };
 
     /*!
     *  Graphics Controller.
@@ -85,13 +152,71 @@ namespace se::graphics {
             /*!
              *  Graphics Tasks.
              * 
-             *  These tasks are executed in the order they are received, at a
-             *  rate of one task per rendered frame.  While this does have a
-             *  small impact on how quickly all tasks can be processed, it
-             *  ensures that some frames still get rendered, preventing a
-             *  complete output freeze if a lot of tasks land all at once.
+             *  There is one queue per priority class, indexed by
+             *  `GraphicsTaskPriority`.  Within a queue, tasks are executed in
+             *  the order they are received.  Tasks may be submitted from any
+             *  thread, but are only ever consumed by the graphics thread.
+             *  Critical tasks are always drained completely, then the other
+             *  queues are drained until the task time budget
+             *  (`render.task_budget_us`) has been used up, which ensures that
+             *  some frames still get rendered, preventing a complete output
+             *  freeze if a lot of tasks land all at once.
+             */
+            se::util::MPSCQueue<QueuedGraphicsTask> tasks[SE_GRAPHICS_TASK_PRIORITY_COUNT];
+
+            /*!
+             *  Coalesced Tasks.
+             * 
+             *  Pending tasks which were submitted with a coalescing key.  Only
+             *  keyed submissions ever touch this table (and its mutex), so
+             *  regular submissions remain lock-free.
              */
-            std::queue<GraphicsTask> tasks;
+            std::unordered_map<GraphicsTaskKey, CoalescedGraphicsTask> coalesced_tasks;
+
+            /// Coalesced task table mutex
+            std::mutex coalesced_tasks_mutex;
+
+            /// Last marker sequence number handed out (guarded by the table
+            /// mutex)
+            uint64_t coalesced_task_sequence = 0;
+
+            /*!
+             *  Graphics Thread ID.
+             * 
+             *  ID of the thread which is currently executing frames.  This is
+             *  usually the internal graphics thread, but may be an external
+             *  thread when rendering is administered by a QT widget.
+             */
+            std::atomic<std::thread::id> graphics_thread_id;
+
+            /*!
+             *  Task Time Budget.
+             * 
+             *  Pointer to the `render.task_budget_us` configuration value.  At
+             *  least one task is always executed per frame, regardless of the
+             *  budget.
+             */
+            const volatile int* task_budget_us = nullptr;
+
+            /// Number of tasks executed during the last frame
+            std::atomic<uint32_t> stat_frame_task_count = 0;
+            /// Time spent executing tasks during the last frame
+            std::atomic<uint64_t> stat_frame_task_time_ns = 0;
+            /// Total number of tasks executed
+            std::atomic<uint64_t> stat_total_task_count = 0;
+            /// Total time spent executing tasks
+            std::atomic<uint64_t> stat_total_task_time_ns = 0;
+            /// Tasks executed per second
+            std::atomic<float> stat_drain_rate = 0.0;
+            /// Number of tasks merged into an already pending task
+            std::atomic<uint64_t> stat_merged_task_count = 0;
+            /// Number of tasks dropped at shutdown
+            std::atomic<uint64_t> stat_dropped_task_count = 0;
+
+            /// Start of the current drain rate measurement window
+            std::chrono::steady_clock::time_point drain_window_start;
+            /// Number of tasks executed in the current drain rate window
+            uint32_t drain_window_count = 0;
 
             /*!
              *  Graphics Event Handler.
@@ -110,6 +235,22 @@ namespace se::graphics {
              */
             RenderManager* render_manager = nullptr;
 
+            /*!
+             *  Texture Streamer.
+             * 
+             *  Created once OpenGL has been initialized, if streaming uploads
+             *  are supported and enabled.
+             */
+            std::atomic<TextureStreamer*> texture_streamer = nullptr;
+
+            /*!
+             *  Texture Array Manager.
+             * 
+             *  Created once OpenGL has been initialized.  Null unless texture
+             *  arrays are enabled (`render.texture_arrays`).
+             */
+            std::atomic<TextureArrayManager*> texture_array_manager = nullptr;
+
             /*!
              *  Graphics Thread.
              * 
@@ -139,9 +280,43 @@ namespace se::graphics {
 
             /*!
              *  Process pending graphics tasks.
+             * 
+             *  Executes tasks until the queue is empty or the task budget for
+             *  this frame has been used up.
              */
             void process_tasks();
 
+            /*!
+             *  Execute the next pending task.
+             * 
+             *  Queues are checked in order of priority, down to and including
+             *  the given priority class.
+             * 
+             *  @param lowest   Lowest priority class to consider.
+             * 
+             *  @return `true` if a task was executed, `false` otherwise.
+             */
+            bool run_next_task(GraphicsTaskPriority lowest);
+
+            /*!
+             *  Drop every task still queued at shutdown.
+             * 
+             *  The tasks are not run, but their handles are completed so
+             *  nothing waiting on them hangs.  Stale coalescing markers are
+             *  not counted as dropped.
+             */
+            void drop_pending_tasks();
+
+            /*!
+             *  Enqueue a task.
+             * 
+             *  Places a task whose dependencies have been satisfied into the
+             *  appropriate queue, merging it with a pending task if it shares
+             *  a coalescing key.
+             */
+            void enqueue_task(GraphicsTask task, GraphicsTaskHandle handle,
+                GraphicsTaskPriority priority, GraphicsTaskKey coalesce_key);
+
             /*!
              *  SDL Initialization Method.
              * 
@@ -180,8 +355,49 @@ namespace se::graphics {
              *  Sometimes things need to be done on the graphics thread due to
              *  thread safety requirements, such as shader compilation or
              *  texture loading.
+             * 
+             *  This method is lock-free and may be called from any thread,
+             *  including the graphics thread itself.
+             * 
+             *  If dependencies are given, the task will not be queued until
+             *  every one of them has completed.  Null dependencies are ignored.
+             * 
+             *  @param task         Task to execute on the graphics thread.
+             *  @param dependencies Tasks which must complete first.
+             * 
+             *  @return A handle which is completed once the task has executed.
+             */
+            GraphicsTaskHandle submit_graphics_task(GraphicsTask task,
+                std::vector<GraphicsTaskHandle> dependencies = {});
+
+            /*!
+             *  Submit a prioritized graphics task.
+             * 
+             *  Identical to the basic `submit_graphics_task()`, but allows the
+             *  priority class and coalescing key to be specified.
+             * 
+             *  If a task with the same nonzero coalescing key is still pending
+             *  when the task becomes ready, the pending task is replaced by
+             *  this one.  The pending task will never be executed, and its
+             *  handle is completed along with this one.  If the new task has a
+             *  higher priority, the merged task is promoted.
+             * 
+             *  @param task         Task to execute on the graphics thread.
+             *  @param priority     Task priority class.
+             *  @param coalesce_key Coalescing key (see `graphics_task_key()`)
+             *                      or zero.
+             *  @param dependencies Tasks which must complete first.
+             * 
+             *  @return A handle which is completed once the task has executed.
+             */
+            GraphicsTaskHandle submit_graphics_task(GraphicsTask task,
+                GraphicsTaskPriority priority, GraphicsTaskKey coalesce_key = 0,
+                std::vector<GraphicsTaskHandle> dependencies = {});
+
+            /*!
+             *  Check if the calling thread is the graphics thread.
              */
-            void submit_graphics_task(GraphicsTask task);
+            bool is_graphics_thread();
 
             /// Specify the active render manager
             void set_render_manager(se::graphics::RenderManager* manager);
@@ -189,12 +405,34 @@ namespace se::graphics {
             /// Get the active render manager
             se::graphics::RenderManager* get_render_manager();
 
+            /*!
+             *  Get the texture streamer.
+             * 
+             *  May be called from any thread.  Returns `nullptr` if texture
+             *  streaming is unavailable.
+             */
+            se::graphics::TextureStreamer* get_texture_streamer();
+
+            /*!
+             *  Get the texture array manager.
+             * 
+             *  Returns `nullptr` if texture arrays are disabled.
+             */
+            se::graphics::TextureArrayManager* get_texture_array_manager();
+
             /*!
              *  Pending Graphics Tasks.
              * 
              *  Returns the number of pending graphics tasks.
              */
             int pending_task_count();
+
+            /*!
+             *  Graphics Task Statistics.
+             * 
+             *  Returns a snapshot of the task queue performance counters.
+             */
+            GraphicsTaskStats get_task_stats();
     };
 
 }
@@ -0,0 +1,190 @@
+/*!
+ *  @file include/se/graphics/graphicsTask.hpp
+ *
+ *  Definitions for graphics tasks and their completion handles.
+ *
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ *
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_GRAPHICS_GRAPHICSTASK_H_
+#define _SE_GRAPHICS_GRAPHICSTASK_H_
+
+#include "se/fwd.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace se::graphics {
+
+    /*!
+     *  Render Thread Task.
+     *
+     *  Represents a task that needs to be executed on the render thread.
+     */
+    typedef std::function<void(void)> GraphicsTask;
+
+    /*!
+     *  Graphics Task Priority.
+     *
+     *  Each priority class has its own queue.  Pending tasks in a higher
+     *  priority class are always executed before any lower priority tasks.
+     */
+    enum class GraphicsTaskPriority {
+        /// Frame critical work (such as resizing), not subject to the budget
+        CRITICAL,
+        /// General purpose work
+        NORMAL,
+        /// Background resource streaming
+        BACKGROUND
+    };
+
+    /// Number of graphics task priority classes
+    #define SE_GRAPHICS_TASK_PRIORITY_COUNT 3
+
+    /*!
+     *  Graphics Task Coalescing Key.
+     *
+     *  Tasks submitted with the same nonzero key are coalesced: if a task with
+     *  the given key is still pending when another is submitted, the pending
+     *  task is replaced by the newer one.  A key of zero disables coalescing.
+     */
+    typedef uint64_t GraphicsTaskKey;
+
+    /*!
+     *  Generate a coalescing key.
+     *
+     *  Keys are generated from the address of the resource being operated on
+     *  and a small resource specific operation number, allowing different
+     *  operations on the same resource to be coalesced independently.
+     *
+     *  @param resource     Resource being operated on.
+     *  @param operation    Operation number (0-255).
+     */
+    inline GraphicsTaskKey graphics_task_key(const void* resource, uint8_t operation) {
+        return ((GraphicsTaskKey) (uintptr_t) resource) ^ (((GraphicsTaskKey) operation) << 56);
+    }
+
+    /*!
+     *  Graphics Task Completion.
+     *
+     *  Every task submitted to the graphics controller is given a completion
+     *  object, which is marked as complete as soon as the task has finished
+     *  executing on the render thread.  Completions can be polled, waited on,
+     *  or used to schedule follow-up tasks without any sleeping.
+     *
+     *  Completions are always passed around as a `GraphicsTaskHandle`.
+     */
+    class GraphicsTaskCompletion :
+        public std::enable_shared_from_this<GraphicsTaskCompletion> {
+
+        friend class GraphicsController;
+
+        private:
+
+            /// Controller which will execute the task
+            GraphicsController* controller;
+
+            /// Completion flag
+            std::atomic<bool> complete = false;
+
+            /// Completion mutex, protects the callback list
+            std::mutex completion_mutex;
+
+            /// Signalled when the task completes
+            std::condition_variable completion_condition;
+
+            /*!
+             *  Completion Callbacks.
+             *
+             *  These are invoked on the render thread immediately after the
+             *  task has completed.  They must be short, and are generally
+             *  only used to queue dependent tasks.
+             */
+            std::vector<std::function<void(void)>> callbacks;
+
+            /// Time at which the task was submitted
+            std::chrono::steady_clock::time_point submit_time;
+
+            /// Time at which the task completed
+            std::chrono::steady_clock::time_point complete_time;
+
+            /*!
+             *  Register a completion callback.
+             *
+             *  If the task has already completed, the callback will be invoked
+             *  immediately on the calling thread.
+             */
+            void on_complete(std::function<void(void)> callback);
+
+        public:
+
+            /// Create a new (incomplete) task completion
+            GraphicsTaskCompletion(GraphicsController* controller);
+
+            /*!
+             *  Mark this task as complete.
+             *
+             *  Wakes up any waiting threads and invokes completion callbacks.
+             *  Completions for tasks submitted to the graphics controller are
+             *  marked automatically.  This only needs to be called directly
+             *  for completions which represent work done elsewhere (such as on
+             *  the worker pool), allowing graphics tasks to depend on them.
+             */
+            void mark_complete();
+
+            /*!
+             *  Check if the task has completed.
+             *
+             *  This method never blocks.
+             */
+            bool is_complete();
+
+            /*!
+             *  Wait for the task to complete.
+             *
+             *  **Warning:** Waiting on the graphics thread for a task which
+             *  has not yet been executed would deadlock the renderer.  If this
+             *  is attempted, an error is logged and this method returns
+             *  immediately.
+             */
+            void wait();
+
+            /*!
+             *  Schedule a follow-up task.
+             *
+             *  The given task is submitted to the graphics controller once this
+             *  task has completed.
+             *
+             *  @return A handle for the follow-up task.
+             */
+            std::shared_ptr<GraphicsTaskCompletion> then(GraphicsTask task);
+
+            /*!
+             *  Get the task latency.
+             *
+             *  Returns the number of nanoseconds between submission and
+             *  completion of the task, or zero if the task is not complete.
+             */
+            uint64_t get_latency_ns();
+
+    };
+
+    /*!
+     *  Graphics Task Handle.
+     *
+     *  Shared reference to a task completion.  May be null if no task was
+     *  submitted.
+     */
+    typedef std::shared_ptr<GraphicsTaskCompletion> GraphicsTaskHandle;
+
+}
+
+#endif
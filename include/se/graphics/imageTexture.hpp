@@ -13,13 +13,21 @@
 
 #include "se/util/cacheableResource.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
 namespace se::graphics {
 
     /*!
      *  Image Texture Class.
      * 
      *  Image textures are populated with data loaded from PNG or other
-     *  image files.
+     *  image files.  Decoded images, along with their complete mip chain, are
+     *  kept in the texture cache so that subsequent loads only have to map
+     *  the cached copy.
      */
     class ImageTexture : public Texture, public se::util::CacheableResource {
 
@@ -37,6 +45,45 @@ namespace se::graphics {
             /// Texture Destructor
             ~ImageTexture();
 
+            /*!
+             *  Decoded Pixel Data.
+             * 
+             *  Storage for freshly decoded images and their mip chain.  Cleared
+             *  after binding.
+             */
+            std::vector<uint8_t> pixel_data;
+
+            /*!
+             *  Texture Cache Mapping.
+             * 
+             *  If the texture was loaded from the texture cache, this is the
+             *  mapping the GPU data is uploaded from.  The mapping is released
+             *  after binding.
+             */
+            se::util::MappedFile* texture_cache = nullptr;
+
+            /// Held by the worker for the whole decode, so decodes never overlap
+            std::mutex decode_mutex;
+
+            /*!
+             *  State Mutex.
+             * 
+             *  Guards the load generation and resource state, and is held while
+             *  binding so that a newer load (and its decode) can't start until
+             *  the bind is done.  It is never held across a decode, so the
+             *  graphics thread never waits on one.
+             */
+            std::mutex state_mutex;
+
+            /*!
+             *  Load Generation.
+             * 
+             *  Incremented by every load and unload.  Decodes and binds which
+             *  were started by an earlier load see a different generation, and
+             *  are dropped.  Binds check it before taking any lock.
+             */
+            std::atomic<uint32_t> load_generation = 0;
+
             /*!
              *  Bind texture data to the GPU.
              * 
@@ -45,6 +92,49 @@ namespace se::graphics {
              */
             virtual void bind();
 
+            /// @see `se::graphics::Texture::release_texture_data()`
+            void release_texture_data();
+
+            /*!
+             *  Read and decode the texture file.
+             * 
+             *  **Warning:** This method is executed on the worker pool, and
+             *  must not touch any OpenGL state.
+             * 
+             *  @return `false` if the file could not be read.
+             */
+            bool decode();
+
+            /*!
+             *  Read the texture cache.
+             * 
+             *  Maps the cached mip chain, if it exists and matches the given
+             *  source file metadata.
+             * 
+             *  @return `true` if the cache is valid and has been mapped.
+             */
+            bool read_cache(std::string cache_fname, int64_t source_mtime_ns,
+                uint64_t source_size);
+
+            /*!
+             *  Write the texture cache.
+             * 
+             *  Saves the decoded mip chain for future loads.  Failure to write
+             *  the cache is not an error.
+             */
+            void write_cache(std::string cache_fname, int64_t source_mtime_ns,
+                uint64_t source_size, int channels);
+
+            /*!
+             *  Decode a PNG file.
+             * 
+             *  Decodes the image into `pixel_data` (bottom row first, as
+             *  OpenGL expects), leaving space for the mip chain.
+             * 
+             *  @return Number of channels (3 or 4), or 0 on failure.
+             */
+            int decode_png(std::string fname);
+
         protected:
 
             void load_();
@@ -0,0 +1,154 @@
+/*!
+ *  @file include/se/graphics/instancedRenderer.hpp
+ * 
+ *  Instanced rendering of static props.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_GRAPHICS_INSTANCEDRENDERER_H_
+#define _SE_GRAPHICS_INSTANCEDRENDERER_H_
+
+#include "se/fwd.hpp"
+#include "se/graphics/geometry.hpp"
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace se::graphics {
+
+    /*!
+     *  Instance Batch Key.
+     * 
+     *  Props can be drawn together if they share all of these.  Only one of
+     *  `array` and `texture` is set.  Each level of detail of a geometry is a
+     *  separate batch.
+     */
+    struct InstanceBatchKey {
+        /// Instanced program
+        ShaderProgram* program;
+        /// Geometry
+        Geometry* geometry;
+        /// Texture array
+        TextureArray* array;
+        /// Texture
+        Texture* texture;
+        /// Level of detail
+        unsigned int lod;
+
+        bool operator==(const InstanceBatchKey& other) const {
+            return program == other.program && geometry == other.geometry &&
+                array == other.array && texture == other.texture && lod == other.lod;
+        }
+    };
+
+    /// Instance batch key hash
+    struct InstanceBatchKeyHash {
+        size_t operator()(const InstanceBatchKey& key) const {
+            size_t hash = (size_t) key.program;
+            hash = hash * 31 + (size_t) key.geometry;
+            hash = hash * 31 + (size_t) key.array;
+            hash = hash * 31 + (size_t) key.texture;
+            hash = hash * 31 + key.lod;
+            return hash;
+        }
+    };
+
+    /*!
+     *  Instanced Renderer.
+     * 
+     *  Collects static props each frame, groups them by program, geometry, and
+     *  texture, and draws each group with a single instanced draw call.  Model
+     *  matrices (and texture array layers) are collected per group as props
+     *  are submitted, then copied into a persistently mapped, triple buffered
+     *  instance buffer once per frame, and the vertex shader combines them
+     *  with the camera matrix from the frame uniforms.
+     *  Props sharing a texture array are grouped together even if their
+     *  textures differ.
+     * 
+     *  Only instanced props go through the instance buffer.  Everything drawn
+     *  individually (signs, the skybox, props when instancing is disabled, and
+     *  props drawn late by the occlusion culler) still uploads its model
+     *  matrix with one `glUniformMatrix4fv()` call per draw.
+     * 
+     *  Instancing is enabled by the `render.instancing` configuration value.
+     * 
+     *  **Warning:** This class must only be used from the graphics thread.
+     */
+    class InstancedRenderer {
+
+        private:
+
+            /// Parent Engine
+            se::Engine* engine;
+
+            /// Instances collected for each batch this frame
+            std::unordered_map<InstanceBatchKey, std::vector<GeometryInstance>,
+                InstanceBatchKeyHash> batches;
+
+            /// Persistently mapped instance buffer
+            StreamBuffer* stream;
+
+            /// Contiguous instance data for upload, when streaming isn't supported
+            std::vector<GeometryInstance> staging;
+
+            /// OpenGL instance buffer ID, when streaming isn't supported
+            unsigned int gl_instance_buffer_id = 0;
+
+            /// Instance buffer capacity (instances)
+            size_t instance_capacity = 0;
+
+            /// Number of draw calls issued during the last frame
+            uint32_t frame_draw_count = 0;
+
+            /// Number of instances drawn during the last frame
+            uint32_t frame_instance_count = 0;
+
+            /// Total number of frames drawn
+            uint64_t stat_frame_count = 0;
+
+            /// Total number of draw calls issued
+            uint64_t stat_draw_count = 0;
+
+            /// Total number of instances drawn
+            uint64_t stat_instance_count = 0;
+
+        public:
+
+            /// Construct a new instanced renderer
+            InstancedRenderer(se::Engine* engine);
+
+            /// Destroy the instanced renderer
+            ~InstancedRenderer();
+
+            /*!
+             *  Submit an instance.
+             * 
+             *  @param command      Instanced draw command (see
+             *                      `se::entity::StaticProp::record()`).
+             *  @param model_matrix Model matrix of the instance.
+             */
+            void submit(const DrawCommand& command, const glm::mat4& model_matrix);
+
+            /*!
+             *  Draw all submitted props.
+             * 
+             *  The camera matrix is taken from the frame uniforms.
+             */
+            void draw();
+
+            /// Get the number of draw calls issued during the last frame
+            uint32_t get_frame_draw_count();
+
+            /// Get the number of instances drawn during the last frame
+            uint32_t get_frame_instance_count();
+
+    };
+
+}
+
+#endif
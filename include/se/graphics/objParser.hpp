@@ -0,0 +1,105 @@
+/*!
+ *  @file include/se/graphics/objParser.hpp
+ * 
+ *  Wavefront OBJ geometry parser.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_GRAPHICS_OBJPARSER_H_
+#define _SE_GRAPHICS_OBJPARSER_H_
+
+#include "se/fwd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+namespace se::graphics::obj {
+
+    /*!
+     *  Face Corner.
+     * 
+     *  Indices are one-based (as in the source file) with relative indices
+     *  already resolved.  A uv or normal index of zero means the attribute
+     *  was not specified.  Indices are not range checked by the parser.
+     */
+    struct Corner {
+        /// Position index
+        uint32_t position;
+        /// Texture coordinate index
+        uint32_t uv;
+        /// Normal index
+        uint32_t normal;
+    };
+
+    /// Parsed OBJ model
+    struct Model {
+        /// Vertex positions (`v`)
+        std::vector<glm::vec3> positions;
+        /// Texture coordinates (`vt`)
+        std::vector<glm::vec2> uvs;
+        /// Vertex normals (`vn`)
+        std::vector<glm::vec3> normals;
+        /*!
+         *  Triangle list.
+         * 
+         *  Every three corners form a triangle.  Polygons with more than
+         *  three corners are triangulated as a fan.
+         */
+        std::vector<Corner> corners;
+    };
+
+    /*!
+     *  Parse an OBJ file.
+     * 
+     *  Supports `v`, `vt`, `vn`, and `f` statements (with `v`, `v/vt`,
+     *  `v//vn`, and `v/vt/vn` corners, negative indices, and polygons of any
+     *  size).  All other statements are ignored.  Numbers are parsed without
+     *  regard to the current locale.
+     * 
+     *  The input is scanned once to determine exact output sizes, then parsed
+     *  directly into place.  Large inputs are split into chunks which are
+     *  scanned and parsed in parallel on the given thread pool.  The calling
+     *  thread always participates, so it is safe to call this from a worker.
+     * 
+     *  @param data     File contents.
+     *  @param size     Size of the file contents in bytes.
+     *  @param model    Destination model.
+     *  @param pool     Thread pool for parallel parsing, or `nullptr`.
+     *  @param name     Name used in log messages.
+     * 
+     *  @return `true` on success, `false` if the file is malformed.
+     */
+    bool parse(const char* data, size_t size, Model& model,
+        se::util::ThreadPool* pool, const char* name);
+
+    /*!
+     *  Run the benchmark on a file.
+     * 
+     *  Times `parse()`, both single threaded and on the given pool, against
+     *  a plain `fscanf()` reader like the one it replaced, and logs the
+     *  results.  Each reader is run three times and the fastest run is
+     *  reported.  The `fscanf()` reader only understands triangles with
+     *  `v/vt/vn` corners.
+     * 
+     *  @param fname    OBJ file to read.
+     *  @param pool     Thread pool for the parallel run, or `nullptr`.
+     */
+    void benchmark(const char* fname, se::util::ThreadPool* pool);
+
+    /*!
+     *  Run the benchmark on a synthetic model.
+     * 
+     *  Writes a grid of at least `triangle_count` triangles to the temporary
+     *  data folder, runs `benchmark()` on it, and deletes it again.
+     */
+    void benchmark_synthetic(size_t triangle_count, se::util::ThreadPool* pool);
+
+}
+
+#endif
@@ -0,0 +1,176 @@
+/*!
+ *  @file include/se/graphics/occlusionCuller.hpp
+ * 
+ *  Hardware occlusion culling.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_GRAPHICS_OCCLUSIONCULLER_H_
+#define _SE_GRAPHICS_OCCLUSIONCULLER_H_
+
+#include "se/fwd.hpp"
+#include "se/graphics/renderQueue.hpp"
+#include "se/graphics/renderSnapshot.hpp"
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace se::graphics {
+
+    /// Occlusion state of a single entity
+    struct OcclusionState {
+        /// OpenGL query ID
+        unsigned int gl_query_id = 0;
+        /// Whether the query has been issued and its result not yet read
+        bool pending = false;
+        /// Whether the pending query was used for conditional rendering
+        bool conditional = false;
+        /// Whether the entity was visible according to the last result
+        bool visible = true;
+        /// Frame the entity was last seen
+        uint64_t last_frame = 0;
+    };
+
+    /*!
+     *  Occlusion Culler.
+     * 
+     *  Tests the bounding boxes of entities against the depth buffer with
+     *  hardware occlusion queries.  Query results are never waited on, each
+     *  frame uses whatever results have arrived since the last one:
+     * 
+     *  1. Entities which were visible when last tested are drawn normally,
+     *     and act as occluders.
+     *  2. A query is issued for the bounding box of every entity which was
+     *     occluded, and every few frames for those which were visible.
+     *  3. Entities which were occluded are drawn with conditional rendering
+     *     on this frame's query, so the GPU discards them if their box is
+     *     still hidden, without the CPU ever waiting for the result.
+     * 
+     *  Only core OpenGL 3.3 functionality is required, so occlusion culling
+     *  also works with Mesa's llvmpipe software renderer.  Conservative
+     *  queries are used when the context supports them.
+     * 
+     *  Hardware occlusion culling is used when the `render.occlusion_culling`
+     *  configuration value is `hardware`.
+     * 
+     *  **Warning:** This class must only be used from the graphics thread.
+     */
+    class OcclusionCuller {
+
+        private:
+
+            /// Parent Engine
+            se::Engine* engine;
+
+            /// Box proxy program
+            ShaderProgram* box_program;
+
+            /// OpenGL box vertex array ID
+            unsigned int gl_box_vertex_array_id = 0;
+
+            /// OpenGL box vertex buffer ID
+            unsigned int gl_box_vertex_buffer_id = 0;
+
+            /// OpenGL box index buffer ID
+            unsigned int gl_box_index_buffer_id = 0;
+
+            /// OpenGL query target
+            unsigned int gl_query_target = 0;
+
+            /// Occlusion state of each entity
+            std::unordered_map<se::Entity*, OcclusionState> states;
+
+            /// Whether each snapshot item was deferred to conditional rendering
+            std::vector<uint8_t> item_deferred;
+
+            /// Snapshot items to issue queries for this frame
+            std::vector<uint32_t> query_items;
+
+            /// Current frame
+            uint64_t frame = 0;
+
+            /// Number of entities deferred during the last frame
+            uint32_t frame_occluded_count = 0;
+
+            /// Number of queries issued during the last frame
+            uint32_t frame_query_count = 0;
+
+            /// Total number of entities deferred
+            uint64_t stat_occluded_count = 0;
+
+            /// Total number of queries issued
+            uint64_t stat_query_count = 0;
+
+            /// Total number of conditional draws discarded by the GPU
+            uint64_t stat_draws_saved = 0;
+
+            /// Total number of query results which were not ready in time
+            uint64_t stat_late_results = 0;
+
+            /// Create the box geometry and choose the query target
+            void init();
+
+            /// Read the result of a query, if it is available
+            void poll(OcclusionState& state);
+
+        public:
+
+            /// Construct a new occlusion culler
+            OcclusionCuller(se::Engine* engine);
+
+            /// Destroy the occlusion culler
+            ~OcclusionCuller();
+
+            /*!
+             *  Prepare a frame.
+             * 
+             *  Collects the available query results, and decides which items
+             *  are drawn normally and which are deferred.
+             * 
+             *  @param snapshot     Snapshot being drawn.
+             *  @param item_visible Frustum culling results for each item.
+             */
+            void begin_frame(const RenderSnapshot& snapshot,
+                const std::vector<uint8_t>& item_visible);
+
+            /*!
+             *  Check if an item was deferred.
+             * 
+             *  Deferred items must not be drawn normally, they are drawn by
+             *  `draw_deferred()`.
+             */
+            bool is_deferred(uint32_t index);
+
+            /*!
+             *  Issue this frame's queries.
+             * 
+             *  Must be called after every item which is not deferred has been
+             *  drawn.
+             */
+            void issue_queries(const RenderSnapshot& snapshot);
+
+            /*!
+             *  Draw the deferred items.
+             * 
+             *  @param snapshot Snapshot being drawn.
+             *  @param items    Sorted render queue items.
+             */
+            void draw_deferred(const RenderSnapshot& snapshot,
+                const std::vector<RenderQueueItem>& items);
+
+            /// Get the number of entities deferred during the last frame
+            uint32_t get_frame_occluded_count();
+
+            /// Get the number of queries issued during the last frame
+            uint32_t get_frame_query_count();
+
+    };
+
+}
+
+#endif
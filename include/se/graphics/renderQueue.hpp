@@ -0,0 +1,180 @@
+/*!
+ *  @file include/se/graphics/renderQueue.hpp
+ * 
+ *  State sorted render queue.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_GRAPHICS_RENDERQUEUE_H_
+#define _SE_GRAPHICS_RENDERQUEUE_H_
+
+#include "se/fwd.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace se::graphics {
+
+    /*!
+     *  Render Layer.
+     * 
+     *  Layers are drawn in order, and take precedence over all other sort
+     *  criteria.
+     */
+    enum class RenderLayer : uint8_t {
+        /// Drawn first, without writing depth (skyboxes)
+        BACKGROUND = 0,
+        /// Regular opaque geometry
+        OPAQUE = 1,
+        /// Drawn last
+        OVERLAY = 2
+    };
+
+    /*!
+     *  Render State.
+     * 
+     *  Describes the OpenGL state an entity binds when it is rendered.  Any of
+     *  the resources may be null if the entity does not use one.
+     */
+    struct RenderState {
+        /// Render layer
+        RenderLayer layer = RenderLayer::OPAQUE;
+        /// Shader program
+        const void* program = nullptr;
+        /// Texture (or texture array)
+        const void* texture = nullptr;
+        /// Geometry
+        const void* geometry = nullptr;
+    };
+
+    /*!
+     *  Render Queue Item.
+     * 
+     *  The key is packed (from most to least significant) as 4 bits of layer,
+     *  12 bits of program, 16 bits of texture, 16 bits of geometry, and 16
+     *  bits of quantized depth, so sorting by key groups items by state and
+     *  orders them front to back within each group.
+     */
+    struct RenderQueueItem {
+        /// Sort key
+        uint64_t key;
+        /// Index of the item in the render snapshot
+        uint32_t index;
+    };
+
+    /*!
+     *  Render Queue Statistics.
+     * 
+     *  State changes are counted as the number of times consecutive items
+     *  differ in the given resource, both in submission order and in sorted
+     *  order.  The difference is the number of changes saved by sorting.
+     */
+    struct RenderQueueStats {
+        /// Number of items
+        uint32_t item_count = 0;
+        /// Program changes in submission order
+        uint32_t unsorted_program_changes = 0;
+        /// Texture changes in submission order
+        uint32_t unsorted_texture_changes = 0;
+        /// Geometry changes in submission order
+        uint32_t unsorted_geometry_changes = 0;
+        /// Program changes in sorted order
+        uint32_t program_changes = 0;
+        /// Texture changes in sorted order
+        uint32_t texture_changes = 0;
+        /// Geometry changes in sorted order
+        uint32_t geometry_changes = 0;
+    };
+
+    /*!
+     *  Render Queue.
+     * 
+     *  Rebuilt every frame.  Items are sorted by their packed 64 bit key with
+     *  an LSD radix sort, which takes linear time and never needs to compute
+     *  distances more than once per item.
+     * 
+     *  Resources are mapped to small, stable identifiers the first time they
+     *  are seen.  If there are more resources than fit in a key field the
+     *  identifiers wrap, which only makes the sort less effective.
+     * 
+     *  **Warning:** This class is not thread safe.
+     */
+    class RenderQueue {
+
+        private:
+
+            /// Queue items
+            std::vector<RenderQueueItem> items;
+
+            /// Scratch buffer for sorting
+            std::vector<RenderQueueItem> scratch;
+
+            /// Resource identifiers
+            std::unordered_map<const void*, uint32_t> resource_ids;
+
+            /// Statistics for the current frame
+            RenderQueueStats frame_stats;
+
+            /// Total number of frames sorted
+            uint64_t stat_frame_count = 0;
+
+            /// Total program changes saved
+            int64_t stat_program_changes_saved = 0;
+
+            /// Total texture changes saved
+            int64_t stat_texture_changes_saved = 0;
+
+            /// Total geometry changes saved
+            int64_t stat_geometry_changes_saved = 0;
+
+            /// Total time spent sorting (nanoseconds)
+            uint64_t stat_sort_time = 0;
+
+            /*!
+             *  Get the identifier for a resource.
+             * 
+             *  Null resources have the identifier 0.
+             */
+            uint32_t resource_id(const void* resource);
+
+            /// Count the state changes between consecutive items
+            void count_changes(uint32_t& programs, uint32_t& textures,
+                uint32_t& geometries);
+
+        public:
+
+            /// Destroy the render queue
+            ~RenderQueue();
+
+            /// Remove all items
+            void clear();
+
+            /*!
+             *  Add an item.
+             * 
+             *  @param index    Index of the item in the render snapshot.
+             *  @param state    State the item will bind.
+             *  @param depth    Normalized distance from the camera, where 0 is
+             *                  the camera and 1 is the far plane.  Values
+             *                  outside of this range are clamped.
+             */
+            void push(uint32_t index, const RenderState& state, float depth);
+
+            /// Sort the queue and update the frame statistics
+            void sort();
+
+            /// Get the (sorted) items
+            const std::vector<RenderQueueItem>& get_items();
+
+            /// Get the statistics for the current frame
+            RenderQueueStats get_frame_stats();
+
+    };
+
+}
+
+#endif
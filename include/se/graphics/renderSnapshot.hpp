@@ -0,0 +1,95 @@
+/*!
+ *  @file include/se/graphics/renderSnapshot.hpp
+ *
+ *  Immutable per-frame copies of scene render data.
+ *
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ *
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_GRAPHICS_RENDERSNAPSHOT_H_
+#define _SE_GRAPHICS_RENDERSNAPSHOT_H_
+
+#include "se/fwd.hpp"
+#include "se/graphics/commandList.hpp"
+#include "se/graphics/renderQueue.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+namespace se::graphics {
+
+    /*!
+     *  Render Snapshot Item.
+     *
+     *  Everything the render thread needs to know about an entity's position
+     *  and state, copied at the logic sync point.
+     */
+    struct RenderSnapshotItem {
+        /*!
+         *  Entity the item was taken from.
+         * 
+         *  Used to recognize the entity from one frame to the next.  It is
+         *  only dereferenced to call `se::Entity::render()` for entities which
+         *  don't record draw commands, everything else is read from the item.
+         */
+        se::Entity* entity;
+        /*!
+         *  Draw command, recorded at the sync point after the level of detail
+         *  was selected.  The snapshot index is not set.
+         */
+        DrawCommand command;
+        /// Model matrix
+        glm::mat4 model_matrix;
+        /// Entity position
+        glm::vec3 position;
+        /// Render state
+        RenderState state;
+        /// Whether the entity has bounds (see `se::Entity::get_bounds()`)
+        bool bounded;
+        /// World space bounding sphere center
+        glm::vec3 bounds_center;
+        /// World space bounding sphere radius
+        float bounds_radius;
+        /// Whether the entity is an occluder (see `se::Entity::get_occluder()`)
+        bool occluder;
+        /// Model space occluder box minimum corner
+        glm::vec3 occluder_min;
+        /// Model space occluder box maximum corner
+        glm::vec3 occluder_max;
+    };
+
+    /*!
+     *  Render Snapshot.
+     *
+     *  A consistent view of the scene, published by the logic thread after
+     *  every tick and consumed by the render thread.  Once published, a
+     *  snapshot is never modified until the render thread has released it.
+     */
+    struct RenderSnapshot {
+        /// Logic tick the snapshot was taken after
+        uint64_t sequence = 0;
+        /// Camera view and projection matrix
+        glm::mat4 camera_matrix;
+        /// Camera view matrix
+        glm::mat4 camera_view;
+        /// Camera projection matrix
+        glm::mat4 camera_projection;
+        /// Camera position
+        glm::vec3 camera_position;
+        /// Camera near render boundary
+        float camera_near = 0.0;
+        /// Camera far render boundary
+        float camera_far = 1.0;
+        /// Size on screen (in pixels) of one world unit at a distance of one
+        float camera_pixel_scale = 1.0;
+        /// Renderable entities
+        std::vector<RenderSnapshotItem> items;
+    };
+
+}
+
+#endif
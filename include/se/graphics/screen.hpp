@@ -53,9 +53,9 @@ namespace se::graphics {
             void reconfigure_textures();
 
             /// Render framebuffer
-            Framebuffer* primarybuffer;
+            Framebuffer* primarybuffer = nullptr;
             /// Post processing buffer
-            Framebuffer* postprocessbuffer;
+            Framebuffer* postprocessbuffer = nullptr;
 
             /// Ready to rumble flag
             bool ready = false;
@@ -14,21 +14,27 @@
 #define SE_SHADER_LOC_IN_VERT       3
 #define SE_SHADER_LOC_IN_UV         4
 #define SE_SHADER_LOC_IN_NORM       5
-#define SE_SHADER_LOC_CAM_NEAR      7
-#define SE_SHADER_LOC_CAM_FAR       8
-#define SE_SHADER_LOC_DIMX          9
-#define SE_SHADER_LOC_DIMY          10
-#define SE_SHADER_LOC_MSAA_LEVEL    11
 #define SE_SHADER_LOC_TEX_SCR_COLOR 12
 #define SE_SHADER_LOC_TEX_SCR_DEPTH 13
 #define SE_SHADER_LOC_TEX_SCR_BG    14
+#define SE_SHADER_LOC_IN_POS_SCALE  15
+#define SE_SHADER_LOC_IN_POS_OFFSET 16
+#define SE_SHADER_LOC_IN_TEX_LAYER  17
 #define SE_SHADER_LOC_TEX_0         50
 
+// Instance attributes (vertex inputs, so these don't clash with uniforms)
+#define SE_SHADER_LOC_IN_INSTANCE_MODEL 6
+#define SE_SHADER_LOC_IN_INSTANCE_LAYER 10
+
 #define SE_SHADER_LOC_OUT_COLOR     0
 #define SE_SHADER_LOC_OUT_BG        1
 #define SE_SHADER_LOC_OUT_DEPTH     2
 
+// Uniform buffer binding points
+#define SE_SHADER_BINDING_FRAME     0
+
 #include "se/fwd.hpp"
+#include "se/graphics/graphicsTask.hpp"
 
 #include <map>
 
@@ -91,6 +97,14 @@ namespace se::graphics {
             /// Shader Object State
             volatile ShaderState state = ShaderState::LOADING;
 
+            /*!
+             *  Compilation Task Handle.
+             * 
+             *  Completed once the compilation task has executed.  This will be
+             *  null if the shader failed before compilation could be queued.
+             */
+            GraphicsTaskHandle compile_handle;
+
             /*!
              *  Source Code.
              * 
@@ -196,12 +210,22 @@ namespace se::graphics {
              *  `ShaderState::LOADING` state, at which point it will return the
              *  new state.
              * 
-             *  This method checks for load completion every 10ms.
+             *  This method blocks on the compilation task handle, and wakes up
+             *  as soon as compilation completes.  It must not be called from
+             *  the graphics thread.
              * 
              *  @return The state the shader is in after loading.
              */
             ShaderState wait_for_loading();
 
+            /*!
+             *  Get the compilation task handle.
+             * 
+             *  May be null if the shader failed before compilation could be
+             *  queued, in which case the shader is already in an error state.
+             */
+            GraphicsTaskHandle get_compile_handle();
+
             /*!
              *  Get the OpenGL ID.
              */
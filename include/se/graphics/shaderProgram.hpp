@@ -10,6 +10,7 @@
 #define _SE_GRAPHICS_SHADERPROGRAM_H_
 
 #include "se/fwd.hpp"
+#include "se/graphics/graphicsTask.hpp"
 
 #include "se/util/cacheableResource.hpp"
 #include "se/util/loadableResource.hpp"
@@ -70,6 +71,15 @@ namespace se::graphics {
             /// Fragment Shader
             Shader* fshader = nullptr;
 
+            /*!
+             *  Linking Task Handle.
+             * 
+             *  The linking task is not queued until both shaders have finished
+             *  compiling, so it never has to wait for them on the graphics
+             *  thread.
+             */
+            GraphicsTaskHandle link_handle;
+
             /*!
              *  Linking Method.
              * 
@@ -86,22 +96,6 @@ namespace se::graphics {
              */
             void unlink();
 
-            /*!
-             *  Current Program for this render thread.
-             * 
-             *  This contains the OpenGL ID of the most recently activated
-             *  program.  Theoretically, this will prevent the engine from
-             *  performing a number of unnecessary program context switches when
-             *  multiple consecutive entities are rendered using the same
-             *  program, however it's entirely possible that this situation is
-             *  handled by the graphics driver and therefore provides no
-             *  performance benefit here.  Either way, I'm including it in the
-             *  event that the target system does not optimize command
-             *  executions, and it only adds like two or three CPU cycles per
-             *  entity so what the heck.
-             */
-            static thread_local unsigned int current_program;
-
         protected:
 
             /*!
@@ -154,12 +148,21 @@ namespace se::graphics {
              *  This method will block until this program is no longer in the
              *  loading state, at which point it will return the new state.
              * 
-             *  This method checks for load completion every 10ms.
+             *  This method blocks on the linking task handle, and wakes up as
+             *  soon as linking completes.  It must not be called from the
+             *  graphics thread.
              * 
              *  @return The state the program is in after loading.
              */
             se::util::LoadableResourceState wait_for_loading();
 
+            /*!
+             *  Get the linking task handle.
+             * 
+             *  Null until the program has been loaded.
+             */
+            GraphicsTaskHandle get_link_handle();
+
             /*!
              *  Use this Program.
              * 
@@ -10,10 +10,18 @@
 #define _SE_GRAPHICS_SIMPLERENDERMANAGER_H_
 
 #include "se/fwd.hpp"
+#include "se/graphics/commandList.hpp"
+#include "se/graphics/frameUniforms.hpp"
+#include "se/graphics/glState.hpp"
 #include "se/graphics/renderManager.hpp"
+#include "se/graphics/renderQueue.hpp"
+#include "se/graphics/renderSnapshot.hpp"
+#include "se/util/depthRasterizer.hpp"
+#include "se/util/tripleBuffer.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <vector>
-#include <thread>
 
 namespace se::graphics {
 
@@ -35,40 +43,200 @@ namespace se::graphics {
             se::Engine* engine;
 
             /// Current Scene
-            se::Scene* active_scene;
+            std::atomic<se::Scene*> active_scene;
 
             /// Default scene
             se::Scene* default_scene;
 
             /// Active view point
-            se::entity::Camera* active_camera;
+            std::atomic<se::entity::Camera*> active_camera;
 
             /// Default camera
             se::entity::Camera* default_camera;
 
+            /// Window height, for level of detail selection
+            const volatile int* window_height;
+
+            /// Window width
+            const volatile int* window_width;
+
+            /// MSAA sample count
+            const volatile int* msaa_level;
+
+            /// Time rendering began
+            std::chrono::steady_clock::time_point render_start;
+
+            /// Frame uniforms
+            se::graphics::FrameUniforms frame_uniforms;
+
+            /// Frame uniform buffer
+            se::graphics::FrameUniformBuffer* frame_uniform_buffer;
+
             /// Screen used for output rendering
             se::graphics::Screen* screen;
 
-            /// Support thread.
-            std::thread support_thread;
+            /*!
+             *  Instanced renderer used for static props.
+             * 
+             *  Null if instancing is disabled (`render.instancing`).
+             */
+            se::graphics::InstancedRenderer* instanced_renderer = nullptr;
+
+            /*!
+             *  Hardware occlusion culler.
+             * 
+             *  Null unless `render.occlusion_culling` is `hardware`.
+             */
+            se::graphics::OcclusionCuller* occlusion_culler = nullptr;
+
+            /*!
+             *  Software occlusion rasterizer.
+             * 
+             *  Null unless `render.occlusion_culling` is `software`.
+             */
+            se::util::DepthRasterizer* depth_rasterizer = nullptr;
+
+            /// Queue used to order renderable entities each frame
+            se::graphics::RenderQueue* render_queue;
+
+            /// Record draw commands on the worker threads (`render.parallel_recording`)
+            bool parallel_recording = true;
+
+            /*!
+             *  Command lists.
+             * 
+             *  The sorted render queue is split into contiguous ranges, one per
+             *  list, so replaying the lists in order preserves the sort.
+             */
+            std::vector<CommandList> command_lists;
+
+            /// Number of command lists recorded during the last frame
+            size_t frame_command_list_count = 0;
+
+            /*!
+             *  Render Snapshots.
+             * 
+             *  Written by the logic thread, read by the graphics thread.  The
+             *  graphics thread never touches live entity transforms.
+             */
+            se::util::TripleBuffer<RenderSnapshot> snapshots;
+
+            /// Number of snapshots published
+            uint64_t snapshot_sequence = 0;
+
+            /// Frustum culling enabled (`render.frustum_culling`)
+            bool frustum_culling = true;
+
+            /// Packed bounding sphere x coordinates, for culling
+            std::vector<float> cull_x;
+
+            /// Packed bounding sphere y coordinates, for culling
+            std::vector<float> cull_y;
+
+            /// Packed bounding sphere z coordinates, for culling
+            std::vector<float> cull_z;
+
+            /// Packed bounding sphere radii, for culling
+            std::vector<float> cull_radius;
+
+            /// Snapshot item index of each packed bounding sphere
+            std::vector<uint32_t> cull_index;
+
+            /// Culling results for each packed bounding sphere
+            std::vector<uint8_t> cull_result;
+
+            /// Visibility of each snapshot item
+            std::vector<uint8_t> item_visible;
+
+            /// Number of entities drawn during the last frame
+            uint32_t frame_visible_count = 0;
+
+            /// Number of entities outside the view frustum during the last frame
+            uint32_t frame_culled_count = 0;
+
+            /// Number of entities hidden by software occlusion culling
+            uint32_t frame_occluded_count = 0;
+
+            /// Total number of frames rendered
+            uint64_t stat_frame_count = 0;
+
+            /// Total number of entities drawn
+            uint64_t stat_visible_count = 0;
+
+            /// Total number of entities outside the view frustum
+            uint64_t stat_culled_count = 0;
 
-            /// Threads run flag
-            bool run = true;
+            /// Total number of entities hidden by software occlusion culling
+            uint64_t stat_occluded_count = 0;
+
+            /// Total time spent on software occlusion culling (nanoseconds)
+            uint64_t stat_occlusion_time = 0;
+
+            /// Total time spent recording draw commands (nanoseconds)
+            uint64_t stat_record_time = 0;
+
+            /// OpenGL state changes issued and elided during the last frame
+            GLStateStats frame_gl_state_stats;
+
+            /// Total number of OpenGL state changes issued
+            uint64_t stat_gl_state_issued = 0;
+
+            /// Total number of redundant OpenGL state changes elided
+            uint64_t stat_gl_state_elided = 0;
+
+            /*!
+             *  Publish a render snapshot.
+             * 
+             *  Copies the transforms and render state of every renderable
+             *  entity in the active scene, along with the active camera.
+             * 
+             *  **Warning:** This method is a logic sync handler, and must only
+             *  be called from the logic thread.
+             */
+            void publish_snapshot();
+
+            /// Update the frame uniforms from a snapshot
+            void update_frame_uniforms(const RenderSnapshot& snapshot);
 
             /*!
-             *  Graphics Support Thread.
+             *  Add an entity to a render snapshot.
              * 
-             *  This thread is spawned to perform a variety of background tasks
-             *  related to bookkeeping and realtime optimization.
+             *  Selects the entity's level of detail for the snapshot camera,
+             *  and records its draw command into the item.
              */
-            void support_thread_main();
+            void snapshot_entity(RenderSnapshot& snapshot, se::Entity* entity,
+                const glm::mat4& model_matrix);
 
             /*!
-             *  Sort Renderable Entities.
+             *  Cull a snapshot.
              * 
-             *  One of several support thread tasks.
+             *  Tests the bounds of every snapshot item against the camera
+             *  frustum, and fills `item_visible`.  Items without bounds are
+             *  always visible.
              */
-            void sort_renderables();
+            void cull(const RenderSnapshot& snapshot);
+
+            /*!
+             *  Occlusion cull a snapshot in software.
+             * 
+             *  Rasterizes the occluders on the worker threads, then tests the
+             *  bounds of every visible item and clears `item_visible` for the
+             *  hidden ones.  Occluders are never hidden.
+             */
+            void occlusion_cull(const RenderSnapshot& snapshot);
+
+            /*!
+             *  Record draw commands for the render queue.
+             * 
+             *  Copies the command recorded in the snapshot for every queued
+             *  item into the command lists, in queue order, spread across the
+             *  worker threads.  No OpenGL calls are made.
+             */
+            void record_commands(const RenderSnapshot& snapshot);
+
+            /// Record the draw command for one snapshot item
+            void record_item(const RenderSnapshot& snapshot, uint32_t index,
+                CommandList& commands);
 
         public:
 
@@ -113,6 +281,60 @@ namespace se::graphics {
              */
             void use_default_scene();
 
+            /*!
+             *  Get the render queue statistics.
+             * 
+             *  Includes the number of program, texture, and geometry changes
+             *  during the last frame, before and after sorting.
+             * 
+             *  **Warning:** This method must be called from the graphics
+             *  thread.
+             */
+            RenderQueueStats get_render_queue_stats();
+
+            /*!
+             *  Get the number of entities drawn during the last frame.
+             * 
+             *  **Warning:** This method must be called from the graphics
+             *  thread.
+             */
+            uint32_t get_frame_visible_count();
+
+            /*!
+             *  Get the number of entities culled during the last frame.
+             * 
+             *  Only counts entities outside the view frustum.  Entities hidden
+             *  by occlusion culling are counted by
+             *  `get_frame_occluded_count()` instead.
+             * 
+             *  **Warning:** This method must be called from the graphics
+             *  thread.
+             */
+            uint32_t get_frame_culled_count();
+
+            /*!
+             *  Get the number of entities which were occluded during the last
+             *  frame.
+             * 
+             *  With hardware occlusion culling, occluded entities are still
+             *  drawn if the GPU finds their bounding box visible.  With
+             *  software occlusion culling they are not drawn at all.  Always 0
+             *  if occlusion culling is disabled.
+             * 
+             *  **Warning:** This method must be called from the graphics
+             *  thread.
+             */
+            uint32_t get_frame_occluded_count();
+
+            /*!
+             *  Get the number of OpenGL state changes issued and elided during
+             *  the last frame.
+             * 
+             *  **Warning:** This method must be called from the graphics
+             *  thread.
+             */
+            GLStateStats get_gl_state_stats();
+
     };
 
 }
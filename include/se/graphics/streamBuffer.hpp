@@ -0,0 +1,145 @@
+/*!
+ *  @file include/se/graphics/streamBuffer.hpp
+ * 
+ *  Persistently mapped buffer for per-frame data.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_GRAPHICS_STREAMBUFFER_H_
+#define _SE_GRAPHICS_STREAMBUFFER_H_
+
+#include "se/fwd.hpp"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace se::graphics {
+
+    /*!
+     *  Stream Buffer.
+     * 
+     *  A buffer which is rewritten every frame, split into three regions so
+     *  the CPU can fill one while the GPU is still reading the other two.  The
+     *  buffer is persistently and coherently mapped, so filling a region is a
+     *  plain memory write, with no upload call and no driver copy.  A fence is
+     *  placed after the draws reading each region, and the region is only
+     *  reused once the fence has been signalled.
+     * 
+     *  Regions grow (reallocating the buffer) when a frame needs more space
+     *  than they have.
+     * 
+     *  Persistent mapping requires `ARB_buffer_storage`.  If it is unavailable
+     *  `begin_frame()` always returns null, and the caller must upload its data
+     *  some other way.
+     * 
+     *  **Warning:** This class must only be used from the graphics thread.
+     */
+    class StreamBuffer {
+
+        private:
+
+            /// Number of regions
+            static const unsigned int REGION_COUNT = 3;
+
+            /// OpenGL buffer ID
+            unsigned int gl_buffer_id = 0;
+
+            /// Generation of the current buffer (see `get_generation()`)
+            uint64_t generation = 0;
+
+            /// Last generation handed out by any stream buffer
+            static uint64_t last_generation;
+
+            /// Mapped buffer memory (write only)
+            char* mapping = nullptr;
+
+            /// Size of each region (bytes)
+            size_t region_size = 0;
+
+            /// Region sizes are rounded up to a multiple of this
+            size_t alignment;
+
+            /// Fences signalled once the GPU has finished reading each region
+            GLsync fences[REGION_COUNT] = {};
+
+            /// Set if the buffer could not be mapped
+            bool disabled = false;
+
+            /// Region being written this frame
+            unsigned int region = 0;
+
+            /// Total number of frames streamed
+            uint64_t stat_frame_count = 0;
+
+            /// Number of frames which had to wait for the GPU
+            uint64_t stat_stall_count = 0;
+
+            /// Number of times the buffer was reallocated
+            uint64_t stat_grow_count = 0;
+
+            /// Allocate and map a buffer with the given region size
+            void allocate(size_t region_size);
+
+        public:
+
+            /*!
+             *  Construct a new stream buffer.
+             * 
+             *  No buffer is allocated until the first frame.
+             * 
+             *  @param alignment    Region sizes (and therefore offsets) are
+             *                      rounded up to a multiple of this, usually
+             *                      the size of one element.
+             */
+            StreamBuffer(size_t alignment);
+
+            /// Destroy the stream buffer
+            ~StreamBuffer();
+
+            /*!
+             *  Begin a frame.
+             * 
+             *  Moves to the next region, waiting for the GPU to finish with it
+             *  if necessary.
+             * 
+             *  @param size Number of bytes which will be written.
+             * 
+             *  @return Pointer to the (write only) region memory, or null if
+             *  persistent mapping is not supported.
+             */
+            void* begin_frame(size_t size);
+
+            /*!
+             *  End a frame.
+             * 
+             *  Must be called after every draw reading the region has been
+             *  issued.
+             */
+            void end_frame();
+
+            /// Get the offset of the current region (bytes)
+            size_t get_offset();
+
+            /// Get the OpenGL buffer ID
+            unsigned int get_buffer_id();
+
+            /*!
+             *  Get the buffer generation.
+             * 
+             *  Every allocation gets a new generation, unique across all stream
+             *  buffers.  OpenGL is free to hand a deleted buffer's name to a
+             *  later object, so anything which caches state about the buffer
+             *  (such as vertex attribute pointers) must compare the generation
+             *  rather than the ID.
+             */
+            uint64_t get_generation();
+
+    };
+
+}
+
+#endif
@@ -10,6 +10,8 @@
 #define _SE_GRAPHICS_TEXTURE_H_
 
 #include "se/fwd.hpp"
+#include "se/graphics/graphicsTask.hpp"
+#include "se/graphics/textureStreamer.hpp"
 
 #include "se/util/loadableResource.hpp"
 
@@ -33,6 +35,7 @@ namespace se::graphics {
      * |`gl_color_attachment`|Color attachment point.  Leave as 0 for no attachment.  [See khronos documentation.][2]|
      * |`gl_color_format`  |Internal color format of the texture.  [See khronos documentation.][3]|
      * |`gl_data_format`   |Color format of the raw texture data.  [See khronos documentation.][3]|
+     * |`mip_levels`       |Number of mip levels present in the texture data, only applicable when `type` is `GL_TEXTURE_2D`|
      * 
      * [1]: https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glTexParameter.xhtml
      * [2]: https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glFramebufferTexture.xhtml
@@ -50,6 +53,7 @@ namespace se::graphics {
         GLenum gl_color_attachment = 0;
         GLenum gl_color_format = GL_RGB;
         GLenum gl_data_format = GL_RGB;
+        int mip_levels = 1;
     };
 
     /*!
@@ -77,25 +81,75 @@ namespace se::graphics {
              * 
              *  This data will be copied to the graphics device during the
              *  binding process.  It should already be in the format specified
-             *  in the options structure.
+             *  in the options structure, with no padding between rows.  If
+             *  there is more than one mip level, the levels follow each other
+             *  (see `se::util::mipmap`).
              * 
              *  Setting this value to `nullptr` or `0` will initialize the
              *  texture as empty (black).
              */
             char* texture_data = nullptr;
 
+            /*!
+             *  Upload Slot.
+             * 
+             *  If the texture data has been staged for streaming, this is the
+             *  slot it was copied into, and `texture_data` is ignored.
+             */
+            TextureUploadSlot* upload_slot = nullptr;
+
             /// Texture Destructor
             ~Texture();
 
             /// OpenGL texture ID
             unsigned int gl_texture = 0;
 
+            /*!
+             *  Binding Task Handle.
+             * 
+             *  Handle for the most recently submitted binding task.
+             */
+            GraphicsTaskHandle bind_handle;
+
             /// @see `se::util::LoadableResource`
             virtual void load_();
 
             /// @see `se::util::LoadableResource`
             virtual void unload_();
 
+            /*!
+             *  Stage texture data for upload.
+             * 
+             *  Copies the texture data into a texture streamer slot, if one is
+             *  available, and releases the original copy.  The `ready` handle
+             *  is completed once the upload may be issued, which is
+             *  immediately if the data could not be staged.
+             * 
+             *  This method is intended to be called from the worker pool once
+             *  the texture data has been decoded.
+             */
+            void stage_upload(GraphicsTaskHandle ready);
+
+            /*!
+             *  Discard staged texture data.
+             * 
+             *  Returns the upload slot without uploading from it, for use when
+             *  a texture is unloaded before it was bound.  The slot isn't
+             *  counted as an upload.
+             * 
+             *  **Warning:** This method must not be called while the texture is
+             *  being staged or bound on another thread.
+             */
+            void discard_upload();
+
+            /*!
+             *  Release texture data.
+             * 
+             *  Called once the texture data is no longer needed.  The default
+             *  implementation does nothing.
+             */
+            virtual void release_texture_data();
+
         public:
 
             /*!
@@ -136,6 +190,22 @@ namespace se::graphics {
              */
             unsigned int get_texture_id();
 
+            /*!
+             *  Wait for loading to complete.
+             * 
+             *  Blocks until the most recently submitted binding task has
+             *  completed, and returns the resulting resource state.  This
+             *  method must not be called from the graphics thread.
+             */
+            se::util::LoadableResourceState wait_for_loading();
+
+            /*!
+             *  Get the binding task handle.
+             * 
+             *  Null if the texture has never been submitted for binding.
+             */
+            GraphicsTaskHandle get_bind_handle();
+
     };
 
 }
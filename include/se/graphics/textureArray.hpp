@@ -0,0 +1,291 @@
+/*!
+ *  @file include/se/graphics/textureArray.hpp
+ * 
+ *  Texture arrays, used to draw differently textured objects without
+ *  switching textures.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_GRAPHICS_TEXTUREARRAY_H_
+#define _SE_GRAPHICS_TEXTUREARRAY_H_
+
+#include "se/fwd.hpp"
+#include "se/graphics/graphicsTask.hpp"
+#include "se/graphics/texture.hpp"
+
+#include "se/util/loadableResource.hpp"
+
+#include <GL/glew.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace se::graphics {
+
+    /*!
+     *  Texture Array.
+     * 
+     *  A `GL_TEXTURE_2D_ARRAY` holding any number of textures with the same
+     *  dimensions, format, and mip level count.  The array grows as required.
+     * 
+     *  **Warning:** With the exception of the getters, the methods of this
+     *  class must only be called from the graphics thread.
+     */
+    class TextureArray {
+
+        private:
+
+            /// Layer width
+            int dimx;
+
+            /// Layer height
+            int dimy;
+
+            /// Number of mip levels
+            int mip_levels;
+
+            /// Color format of the source textures
+            GLenum gl_color_format;
+
+            /// OpenGL texture ID
+            unsigned int gl_texture = 0;
+
+            /// Number of layers allocated
+            int capacity = 0;
+
+            /// Layer usage flags
+            std::vector<bool> used_layers;
+
+            /*!
+             *  Grow the array.
+             * 
+             *  Allocates a new array with the given capacity and copies the
+             *  existing layers into it.
+             * 
+             *  @return `true` on success.
+             */
+            bool grow(int new_capacity);
+
+        public:
+
+            /// Construct a new texture array for textures like the given one
+            TextureArray(const TextureOptions& options);
+
+            /// Destroy the texture array
+            ~TextureArray();
+
+            /*!
+             *  Check if a texture can be stored in this array.
+             */
+            bool matches(const TextureOptions& options);
+
+            /*!
+             *  Add a layer.
+             * 
+             *  Copies every mip level of the given texture into a free layer.
+             *  The copy is performed by the GPU.
+             * 
+             *  @return Layer index, or -1 if the array could not grow.
+             */
+            int add_layer(Texture* source);
+
+            /// Free a layer for reuse
+            void free_layer(int layer);
+
+            /// Release the OpenGL texture
+            void unbind();
+
+            /*!
+             *  Make this the active texture.
+             * 
+             *  @param tex_unit Texture unit to bind the array to.
+             */
+            void use_array(unsigned int tex_unit);
+
+            /// Get the number of layers in use
+            int get_layer_count();
+
+            /// Get the OpenGL texture ID
+            unsigned int get_texture_id();
+
+    };
+
+    /*!
+     *  Texture Layer.
+     * 
+     *  A reference to a texture stored in a texture array.  Loading the layer
+     *  loads the image texture, copies it into a matching array, and then
+     *  releases the image texture again.
+     */
+    class TextureLayer final : public se::util::LoadableResource {
+
+        friend class TextureArrayManager;
+
+        private:
+
+            /// Parent Engine
+            se::Engine* engine;
+
+            /// Owning manager
+            TextureArrayManager* manager;
+
+            /// Texture name
+            std::string name;
+
+            /// Source texture, held while the layer is being loaded
+            ImageTexture* source = nullptr;
+
+            /// Array containing the texture
+            TextureArray* array = nullptr;
+
+            /// Layer within the array
+            int layer = -1;
+
+            /// Handle for the most recently submitted binding task
+            GraphicsTaskHandle bind_handle;
+
+            /// Construct a new texture layer
+            TextureLayer(se::Engine* engine, TextureArrayManager* manager, std::string name);
+
+            /*!
+             *  Copy the source texture into an array.
+             * 
+             *  **Warning:** This method must only be called from the graphics
+             *  thread.
+             */
+            void bind();
+
+            /*!
+             *  Free the layer.
+             * 
+             *  **Warning:** This method must only be called from the graphics
+             *  thread.
+             */
+            void unbind();
+
+        protected:
+
+            /// @see `se::util::LoadableResource::load_()`
+            void load_();
+
+            /// @see `se::util::LoadableResource::unload_()`
+            void unload_();
+
+        public:
+
+            /*!
+             *  Make this the active texture.
+             * 
+             *  Binds the array and sets the layer uniform
+             *  (`SE_SHADER_LOC_IN_TEX_LAYER`).  Binding is skipped if the array
+             *  is already bound to the given unit.
+             * 
+             *  **Warning:** This method must only be called from the graphics
+             *  thread.
+             * 
+             *  @param tex_unit Texture unit to bind the array to.
+             */
+            void use_layer(unsigned int tex_unit);
+
+            /// Get the array containing the texture, or `nullptr`
+            TextureArray* get_array();
+
+            /// Get the layer index, or -1
+            int get_layer();
+
+    };
+
+    /*!
+     *  Texture Array Manager.
+     * 
+     *  Packs textures into texture arrays, one per combination of dimensions,
+     *  format, and mip level count.  Objects which reference a texture layer
+     *  instead of a texture can be drawn one after another without any texture
+     *  switches, as long as their textures share an array.
+     * 
+     *  The manager is enabled by the `render.texture_arrays` configuration
+     *  value.
+     */
+    class TextureArrayManager {
+
+        private:
+
+            /// Parent Engine
+            se::Engine* engine;
+
+            /// Texture layers, by texture name
+            std::map<std::string, TextureLayer*> layers;
+
+            /// Layer table mutex
+            std::mutex layers_mutex;
+
+            /// Texture arrays
+            std::vector<TextureArray*> arrays;
+
+            /// Array currently bound to each texture unit
+            std::map<unsigned int, TextureArray*> bound_arrays;
+
+        public:
+
+            /// Construct a new texture array manager
+            TextureArrayManager(se::Engine* engine);
+
+            /// Destroy the texture array manager
+            ~TextureArrayManager();
+
+            /*!
+             *  Get a texture layer.
+             * 
+             *  Returns the layer for the given texture, creating it if this is
+             *  the first request.  Callers must increment the layer's user
+             *  counter to load it.  May be called from any thread.
+             */
+            TextureLayer* get_layer(const char* texture_name);
+
+            /*!
+             *  Get an array for a texture.
+             * 
+             *  Finds an array which can hold the given texture, creating one
+             *  if required.
+             * 
+             *  **Warning:** This method must only be called from the graphics
+             *  thread.
+             */
+            TextureArray* get_array(const TextureOptions& options);
+
+            /*!
+             *  Bind an array.
+             * 
+             *  Binds the array to the given texture unit, unless it is already
+             *  bound there.
+             * 
+             *  **Warning:** This method must only be called from the graphics
+             *  thread.
+             */
+            void bind_array(TextureArray* array, unsigned int tex_unit);
+
+            /*!
+             *  Forget the bound arrays.
+             * 
+             *  Must be called whenever something other than the manager
+             *  changes the texture bindings.
+             */
+            void reset_bindings();
+
+            /*!
+             *  Release OpenGL resources.
+             * 
+             *  **Warning:** This method must only be called from the graphics
+             *  thread.
+             */
+            void shutdown();
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,219 @@
+/*!
+ *  @file include/se/graphics/textureStreamer.hpp
+ * 
+ *  Asynchronous texture uploads through pixel buffer objects.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_GRAPHICS_TEXTURESTREAMER_H_
+#define _SE_GRAPHICS_TEXTURESTREAMER_H_
+
+#include "se/fwd.hpp"
+#include "se/graphics/graphicsTask.hpp"
+
+#include <GL/glew.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace se::graphics {
+
+    /// Texture upload slot state
+    enum class TextureUploadSlotState {
+        /// Available for use
+        FREE,
+        /// Acquired by a worker, being filled or waiting for upload
+        STAGED,
+        /// Upload commands issued, waiting for the fence
+        IN_FLIGHT
+    };
+
+    /*!
+     *  Texture Upload Slot.
+     * 
+     *  One section of the persistently mapped upload buffer.
+     */
+    struct TextureUploadSlot {
+        /// Offset of the slot within the upload buffer
+        size_t offset = 0;
+        /// Pointer to the mapped slot memory (write only)
+        void* data = nullptr;
+        /// Number of bytes staged in the slot
+        size_t size = 0;
+        /// Fence signalled once the GPU has finished reading the slot
+        GLsync fence = nullptr;
+        /// Slot state
+        TextureUploadSlotState state = TextureUploadSlotState::FREE;
+    };
+
+    /*!
+     *  Texture Streamer.
+     * 
+     *  The texture streamer owns a ring of slots in a persistently mapped
+     *  `GL_PIXEL_UNPACK_BUFFER`.  Worker threads copy decoded pixels straight
+     *  into a slot, so the graphics thread only has to issue the copy commands
+     *  from the buffer into the texture, which the driver performs
+     *  asynchronously.  A fence is placed after each upload, and the slot is
+     *  recycled once it has been signalled.
+     * 
+     *  The number of bytes admitted for upload each frame is limited by the
+     *  `render.upload_budget_kb` configuration value, so a burst of large
+     *  textures is spread over several frames.
+     * 
+     *  Persistent mapping requires `ARB_buffer_storage`.  If it is unavailable
+     *  the streamer is not created and textures are uploaded directly.
+     */
+    class TextureStreamer {
+
+        private:
+
+            /// Parent Engine
+            se::Engine* engine;
+
+            /// OpenGL upload buffer ID
+            unsigned int gl_buffer_id = 0;
+
+            /// Upload slots
+            std::vector<TextureUploadSlot> slots;
+
+            /// Size of each slot in bytes
+            size_t slot_size = 0;
+
+            /// Slot table mutex
+            std::mutex slots_mutex;
+
+            /// Set once the GL resources have been released
+            bool stopped = false;
+
+            /*!
+             *  Queued Upload.
+             * 
+             *  A staged slot waiting to be admitted by the upload budget.
+             */
+            struct QueuedUpload {
+                /// Staged slot
+                TextureUploadSlot* slot;
+                /// Number of bytes to upload
+                size_t size;
+                /// Completed once the upload has been admitted
+                GraphicsTaskHandle ready;
+            };
+
+            /// Uploads waiting for budget
+            std::deque<QueuedUpload> queued_uploads;
+
+            /// Upload budget per frame in kilobytes
+            const volatile int* upload_budget_kb = nullptr;
+
+            /// Total number of uploads streamed
+            std::atomic<uint64_t> stat_upload_count = 0;
+
+            /// Total number of bytes streamed
+            std::atomic<uint64_t> stat_upload_bytes = 0;
+
+            /// Number of uploads which could not get a slot
+            std::atomic<uint64_t> stat_fallback_count = 0;
+
+            /// Number of staged uploads which were discarded
+            std::atomic<uint64_t> stat_discard_count = 0;
+
+        public:
+
+            /*!
+             *  Construct a new texture streamer.
+             * 
+             *  **Warning:** This method must only be called from the graphics
+             *  thread.
+             * 
+             *  @param slot_count   Number of slots.
+             *  @param slot_size    Size of each slot in bytes.
+             */
+            TextureStreamer(se::Engine* engine, unsigned int slot_count, size_t slot_size);
+
+            /// Destroy the texture streamer
+            ~TextureStreamer();
+
+            /*!
+             *  Release OpenGL resources.
+             * 
+             *  After this has been called, no further slots will be handed out.
+             *  Uploads still waiting for budget have their `ready` handles
+             *  completed without being admitted.
+             * 
+             *  **Warning:** This method must only be called from the graphics
+             *  thread.
+             */
+            void shutdown();
+
+            /*!
+             *  Acquire a slot.
+             * 
+             *  This method may be called from any thread.  It never blocks
+             *  waiting for a slot to become free.
+             * 
+             *  @param size Number of bytes required.
+             * 
+             *  @return A slot, or `nullptr` if none are free or the data does
+             *  not fit.
+             */
+            TextureUploadSlot* acquire(size_t size);
+
+            /*!
+             *  Queue a staged upload.
+             * 
+             *  The `ready` handle is completed on the graphics thread once the
+             *  upload fits in a frame's upload budget.  Tasks which issue the
+             *  upload should depend on it.  After `shutdown()` the handle is
+             *  completed immediately, but the upload is never admitted.
+             */
+            void queue_upload(TextureUploadSlot* slot, GraphicsTaskHandle ready);
+
+            /*!
+             *  Release a slot.
+             * 
+             *  Places a fence after any upload commands issued from the slot.
+             *  The slot is reused once the fence has been signalled.
+             * 
+             *  **Warning:** This method must only be called from the graphics
+             *  thread.
+             */
+            void release(TextureUploadSlot* slot);
+
+            /*!
+             *  Discard a slot.
+             * 
+             *  Returns a staged slot whose upload was never issued, so no
+             *  fence is needed and the slot is free immediately.  If the upload
+             *  was still waiting for budget it is removed from the queue, and
+             *  its `ready` handle is completed.  Discarded slots aren't counted
+             *  as uploads.
+             * 
+             *  This method may be called from any thread.
+             */
+            void discard(TextureUploadSlot* slot);
+
+            /*!
+             *  Process uploads.
+             * 
+             *  Recycles slots whose fences have been signalled, and admits
+             *  queued uploads until this frame's budget has been used up.  At
+             *  least one upload is admitted per frame.
+             * 
+             *  **Warning:** This method must only be called from the graphics
+             *  thread.
+             */
+            void process_uploads();
+
+            /// Get the OpenGL upload buffer ID
+            unsigned int get_buffer_id();
+
+    };
+
+}
+
+#endif
@@ -11,7 +11,10 @@
 
 #include "se/fwd.hpp"
 
+#include <functional>
+#include <mutex>
 #include <thread>
+#include <utility>
 #include <vector>
 
 namespace se::logic {
@@ -94,6 +97,17 @@ namespace se::logic {
              */
             std::vector<Tickable*> tickables;
 
+            /*!
+             *  Sync Handlers.
+             * 
+             *  Called after every tick, once all tickables have run, along with
+             *  the object that registered them.
+             */
+            std::vector<std::pair<void*, std::function<void()>>> sync_handlers;
+
+            /// Sync handler mutex
+            std::mutex sync_handler_mutex;
+
             /*!
              *  Logic Thread.
              * 
@@ -131,6 +145,26 @@ namespace se::logic {
             /// Deregister a tickable
             void deregister_tickable(Tickable* tickable);
 
+            /*!
+             *  Register a sync handler.
+             * 
+             *  Sync handlers are called from the logic thread at the end of
+             *  every tick, when all entities are in a consistent state.  This
+             *  is the point where state is published to other threads.
+             * 
+             *  @param owner    Object registering the handler, used to
+             *                  deregister it.
+             *  @param handler  Handler function.
+             */
+            void register_sync_handler(void* owner, std::function<void()> handler);
+
+            /*!
+             *  Deregister a sync handler.
+             * 
+             *  Once this method returns the handler will not be called again.
+             */
+            void deregister_sync_handler(void* owner);
+
     };
 
 }
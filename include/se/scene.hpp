@@ -10,9 +10,15 @@
 #define _SE_SCENE_H_
 
 #include "se/fwd.hpp"
+#include "se/util/bvh.hpp"
 
+#include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
+#include <unordered_map>
 #include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
 #include <map>
 
 namespace se {
@@ -60,6 +66,14 @@ namespace se {
             /// Tickable entities
             std::vector<Entity*> tickable_entities;
 
+            /*!
+             *  Component store.
+             * 
+             *  Holds the transforms of every registered entity, or null if the
+             *  component store is disabled (`logic.component_store`).
+             */
+            std::unique_ptr<se::ComponentStore> components;
+
             /// Construction functiosn
             std::map<uint32_t, WrappedEntityConstructor> constructors;
 
@@ -74,6 +88,58 @@ namespace se {
             /// Generate default wrapped entity constructors.
             void generate_default_wrapped_entity_constructors();
 
+            /*!
+             *  Spatial Index.
+             * 
+             *  World space bounds of every renderable entity which has bounds
+             *  (see `se::Entity::get_bounds()`).
+             */
+            se::util::BVH spatial_index;
+
+            /// Spatial index proxy of each indexed entity
+            std::unordered_map<se::Entity*, int32_t> spatial_proxies;
+
+            /*!
+             *  Spatial index mutex.
+             * 
+             *  Also guards the renderable entity list, which the spatial index
+             *  walks when there is no component store.
+             */
+            std::mutex spatial_index_mutex;
+
+            /*!
+             *  Spatial index rebuild in progress.
+             * 
+             *  Shared with the worker building it, so the scene can be
+             *  destroyed before the rebuild completes.
+             */
+            std::shared_ptr<se::util::BVHBuild> spatial_rebuild;
+
+            /// Spatial index cost after the last rebuild
+            float spatial_rebuild_cost = 0.0;
+
+            /// Number of spatial index updates since the cost was checked
+            unsigned int spatial_cost_check_counter = 0;
+
+            /*!
+             *  Update the spatial index.
+             * 
+             *  Moves every indexed entity to its current bounds, which only
+             *  modifies the tree for entities which have moved significantly,
+             *  and adopts or starts background rebuilds.
+             * 
+             *  **Warning:** This method is a logic sync handler, and must only
+             *  be called from the logic thread.
+             */
+            void update_spatial_index();
+
+            /// Move a renderable entity in the spatial index
+            void index_entity(se::Entity* entity, const glm::mat4& model_matrix);
+
+            /// Query results, converted to entities
+            void spatial_results(std::vector<void*>& found,
+                std::vector<se::Entity*>& results);
+
         public:
 
             /// Create a new (empty) scene.
@@ -117,6 +183,18 @@ namespace se {
              */
             std::map<uint8_t, se::Entity*>* get_entities();
 
+            /*!
+             *  Get the Component Store.
+             * 
+             *  Returns null if the component store is disabled.  Dense indices
+             *  into the store are only valid until the next entity is
+             *  registered or deregistered.
+             * 
+             *  **Warning:** The store must only be accessed from the logic
+             *  thread.
+             */
+            se::ComponentStore* get_components();
+
             /*!
              *  Register an entity.
              * 
@@ -152,6 +230,49 @@ namespace se {
              */
             se::Entity* get_entity(const char* name);
 
+            /*!
+             *  Find entities in a frustum.
+             * 
+             *  Spatial queries only consider entities with bounds, and test
+             *  slightly enlarged boxes around them, so the results may include
+             *  entities which just miss.  Results are appended.
+             * 
+             *  @param camera_matrix    View projection matrix.
+             *  @param results          Entities found.
+             */
+            void query_frustum(const glm::mat4& camera_matrix,
+                std::vector<se::Entity*>& results);
+
+            /*!
+             *  Find entities hit by a ray.
+             * 
+             *  @see `query_frustum()`
+             * 
+             *  @param origin       Ray origin.
+             *  @param direction    Ray direction.
+             *  @param max_distance Maximum distance, in multiples of
+             *                      `direction`.
+             *  @param results      Entities found.
+             */
+            void query_ray(glm::vec3 origin, glm::vec3 direction,
+                float max_distance, std::vector<se::Entity*>& results);
+
+            /*!
+             *  Find entities in a sphere.
+             * 
+             *  @see `query_frustum()`
+             */
+            void query_sphere(glm::vec3 center, float radius,
+                std::vector<se::Entity*>& results);
+
+            /*!
+             *  Find entities in a box.
+             * 
+             *  @see `query_frustum()`
+             */
+            void query_aabb(glm::vec3 min, glm::vec3 max,
+                std::vector<se::Entity*>& results);
+
     };
 
 }
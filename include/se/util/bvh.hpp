@@ -0,0 +1,268 @@
+/*!
+ *  @file include/se/util/bvh.hpp
+ *
+ *  Dynamic bounding volume hierarchy.
+ *
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ *
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_UTIL_BVH_H_
+#define _SE_UTIL_BVH_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace se::util {
+
+    /// Axis aligned bounding box
+    struct AABB {
+        /// Minimum corner
+        glm::vec3 min;
+        /// Maximum corner
+        glm::vec3 max;
+    };
+
+    /// BVH tree node
+    struct BVHNode {
+        /// Node bounds
+        AABB box;
+        /// Parent node, or -1 for the root
+        int32_t parent;
+        /// Child nodes, both -1 for leaves
+        int32_t children[2];
+        /// Proxy stored in this node (leaves only), or the next free node
+        int32_t proxy;
+    };
+
+    /// BVH leaf, as passed to the builder
+    struct BVHLeaf {
+        /// Proxy ID
+        int32_t proxy;
+        /// Proxy bounds
+        AABB box;
+    };
+
+    /*!
+     *  BVH Build.
+     *
+     *  State for a rebuild performed outside of the tree (see
+     *  `BVH::begin_rebuild()`).
+     */
+    struct BVHBuild {
+        /// Leaves to build the tree from
+        std::vector<BVHLeaf> leaves;
+        /// Built nodes
+        std::vector<BVHNode> nodes;
+        /// Built root node
+        int32_t root = -1;
+        /// Set once `BVH::build()` has completed
+        std::atomic<bool> complete = false;
+    };
+
+    /*!
+     *  Bounding Volume Hierarchy.
+     *
+     *  A dynamic AABB tree.  Each object is represented by a proxy, which is
+     *  stored in the tree with a slightly enlarged ("fat") box, so that small
+     *  movements don't require the tree to be modified at all.  When an
+     *  object leaves its fat box it is removed and reinserted, choosing the
+     *  sibling which increases the surface area of the tree the least.
+     *
+     *  Incremental updates slowly degrade the tree, so it can be rebuilt from
+     *  scratch using the binned surface area heuristic.  The rebuild can run
+     *  on another thread while the tree continues to be updated; changes made
+     *  in the meantime are replayed when the result is adopted.
+     *
+     *  **Warning:** This class is not thread safe, with the exception of the
+     *  static `build()` method.
+     */
+    class BVH {
+
+        private:
+
+            /// Proxy record
+            struct Proxy {
+                /// Fat bounds
+                AABB box;
+                /// User data
+                void* user_data;
+                /// Leaf node, or -1 if the proxy is not in the tree
+                int32_t node;
+                /// Whether the proxy is in use
+                bool alive;
+            };
+
+            /// Tree nodes
+            std::vector<BVHNode> nodes;
+
+            /// Root node, or -1 if the tree is empty
+            int32_t root = -1;
+
+            /// Head of the free node list
+            int32_t free_list = -1;
+
+            /// Proxies
+            std::vector<Proxy> proxies;
+
+            /// Unused proxy IDs
+            std::vector<int32_t> free_proxies;
+
+            /// Number of live proxies
+            size_t proxy_count = 0;
+
+            /// Distance the fat boxes are enlarged by on each side
+            float margin;
+
+            /// Whether changes are being recorded for a rebuild
+            bool tracking = false;
+
+            /// Proxies changed since the rebuild began
+            std::vector<int32_t> changed;
+
+            /// Allocate a node
+            int32_t allocate_node();
+
+            /// Release a node
+            void release_node(int32_t node);
+
+            /// Insert a proxy into the tree
+            void insert_leaf(int32_t proxy);
+
+            /// Remove a proxy from the tree
+            void remove_leaf(int32_t proxy);
+
+            /// Recalculate the bounds of a node and all of its ancestors
+            void refit(int32_t node);
+
+            /// Add every leaf below a node to the results
+            void collect(int32_t node, std::vector<void*>& results);
+
+            /// Build a subtree (see `build()`)
+            static int32_t build_node(BVHBuild& build, size_t begin, size_t end,
+                int32_t parent);
+
+        public:
+
+            /*!
+             *  Construct a new (empty) BVH.
+             *
+             *  @param margin   Distance to enlarge proxy boxes by.  Larger
+             *                  margins mean fewer tree updates for moving
+             *                  objects, but looser queries.
+             */
+            BVH(float margin = 0.1);
+
+            /*!
+             *  Insert an object.
+             *
+             *  @param box          Object bounds.
+             *  @param user_data    Value returned by queries.
+             *
+             *  @return Proxy ID.
+             */
+            int32_t insert(const AABB& box, void* user_data);
+
+            /// Remove an object
+            void remove(int32_t proxy);
+
+            /*!
+             *  Move an object.
+             *
+             *  @return `true` if the tree had to be modified, `false` if the
+             *  object is still within its fat box.
+             */
+            bool move(int32_t proxy, const AABB& box);
+
+            /// Get the user data of a proxy
+            void* get_user_data(int32_t proxy);
+
+            /// Get the number of objects in the tree
+            size_t size();
+
+            /*!
+             *  Calculate the tree cost.
+             *
+             *  Sum of the surface areas of the internal nodes relative to the
+             *  root, proportional to the expected cost of a query.  Lower is
+             *  better.
+             */
+            float cost();
+
+            /// Find all objects whose fat box overlaps a box
+            void query_aabb(const AABB& box, std::vector<void*>& results);
+
+            /// Find all objects whose fat box overlaps a sphere
+            void query_sphere(glm::vec3 center, float radius,
+                std::vector<void*>& results);
+
+            /*!
+             *  Find all objects whose fat box is hit by a ray.
+             *
+             *  @param origin       Ray origin.
+             *  @param direction    Ray direction (need not be normalized).
+             *  @param max_distance Maximum distance, in multiples of
+             *                      `direction`.
+             *  @param results      Objects hit, in no particular order.
+             */
+            void query_ray(glm::vec3 origin, glm::vec3 direction,
+                float max_distance, std::vector<void*>& results);
+
+            /*!
+             *  Find all objects whose fat box intersects a frustum.
+             *
+             *  @param planes   Frustum planes (see
+             *                  `se::util::frustum::extract_planes()`).
+             *  @param results  Objects found.
+             */
+            void query_frustum(const glm::vec4 planes[6],
+                std::vector<void*>& results);
+
+            /// Rebuild the tree immediately
+            void rebuild();
+
+            /*!
+             *  Begin a rebuild.
+             *
+             *  Copies the leaves into the build state, and starts recording
+             *  changes.  The build state must then be passed to `build()`
+             *  (which may be done on another thread), and then back to
+             *  `finish_rebuild()`.
+             */
+            void begin_rebuild(BVHBuild& build);
+
+            /*!
+             *  Build a tree.
+             *
+             *  Builds a tree from `build.leaves` top down, splitting each node
+             *  with the binned surface area heuristic.  This method only
+             *  touches the build state, and may be called from any thread.
+             */
+            static void build(BVHBuild& build);
+
+            /*!
+             *  Finish a rebuild.
+             *
+             *  Replaces the tree with the built tree, and replays any changes
+             *  made since `begin_rebuild()`.
+             */
+            void finish_rebuild(BVHBuild& build);
+
+            /*!
+             *  Run the benchmarks.
+             *
+             *  Builds a tree of randomly placed boxes, then times updates,
+             *  rebuilds, and queries, and logs the results.
+             */
+            static void benchmark(size_t object_count);
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,195 @@
+/*!
+ *  @file include/se/util/depthRasterizer.hpp
+ * 
+ *  Software depth rasterizer for occlusion culling.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_UTIL_DEPTHRASTERIZER_H_
+#define _SE_UTIL_DEPTHRASTERIZER_H_
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace se::util {
+
+    /*!
+     *  Depth Rasterizer.
+     * 
+     *  Rasterizes occluders into a small depth buffer on the CPU, which object
+     *  bounds can then be tested against before anything is submitted to the
+     *  GPU.  The buffer stores inverse W (so larger values are closer, and 0
+     *  is empty), which can be interpolated linearly in screen space.
+     * 
+     *  The buffer is divided into tiles of `TILE_SIZE` pixels square.  Each
+     *  row of tiles (a band) is rasterized independently, so bands can be
+     *  rasterized on different threads.  The farthest depth of each tile is
+     *  kept, so most tests never have to look at individual pixels.
+     * 
+     *  Rasterization processes four pixels at a time with SSE2 where
+     *  available.  Nothing here touches OpenGL.
+     * 
+     *  **Warning:** This class is not thread safe, with the exception of
+     *  `rasterize_band()`, which may be called concurrently for different
+     *  bands.
+     */
+    class DepthRasterizer {
+
+        public:
+
+            /// Tile size in pixels
+            static const unsigned int TILE_SIZE = 8;
+
+        private:
+
+            /// Screen space triangle, set up for rasterization
+            struct Triangle {
+                /// Edge function x coefficients
+                float edge_a[3];
+                /// Edge function y coefficients
+                float edge_b[3];
+                /// Edge function constants
+                float edge_c[3];
+                /// Depth plane x coefficient
+                float depth_a;
+                /// Depth plane y coefficient
+                float depth_b;
+                /// Depth plane constant
+                float depth_c;
+                /// Pixel bounds (inclusive)
+                int min_x, min_y, max_x, max_y;
+            };
+
+            /// Buffer width in pixels
+            unsigned int width;
+
+            /// Buffer height in pixels
+            unsigned int height;
+
+            /// Width in tiles
+            unsigned int tiles_x;
+
+            /// Height in tiles
+            unsigned int tiles_y;
+
+            /// Depth buffer (inverse W)
+            std::vector<float> depth;
+
+            /// Farthest depth of each tile
+            std::vector<float> tile_depth;
+
+            /// Triangles to rasterize
+            std::vector<Triangle> triangles;
+
+            /// Set up a clip space triangle (already clipped to the near plane)
+            void setup_triangle(const glm::vec4& a, const glm::vec4& b,
+                const glm::vec4& c);
+
+        public:
+
+            /*!
+             *  Construct a new depth rasterizer.
+             * 
+             *  @param width    Buffer width, rounded up to a multiple of the
+             *                  tile size.
+             *  @param height   Buffer height, rounded up to a multiple of the
+             *                  tile size.
+             */
+            DepthRasterizer(unsigned int width, unsigned int height);
+
+            /// Remove every occluder and clear the depth buffer
+            void clear();
+
+            /*!
+             *  Add an occluder triangle.
+             * 
+             *  The triangle is clipped to the near plane.  Both sides are
+             *  rasterized.
+             * 
+             *  @param a,b,c    Clip space vertices.
+             */
+            void add_triangle(const glm::vec4& a, const glm::vec4& b,
+                const glm::vec4& c);
+
+            /*!
+             *  Add an occluder box.
+             * 
+             *  @param matrix   Model view projection matrix.
+             *  @param min      Model space minimum corner.
+             *  @param max      Model space maximum corner.
+             */
+            void add_box(const glm::mat4& matrix, glm::vec3 min, glm::vec3 max);
+
+            /// Get the number of bands (rows of tiles)
+            unsigned int get_band_count();
+
+            /*!
+             *  Rasterize a band.
+             * 
+             *  Every occluder must be added before any band is rasterized.
+             */
+            void rasterize_band(unsigned int band);
+
+            /// Rasterize every band on the calling thread
+            void rasterize();
+
+            /*!
+             *  Test a box.
+             * 
+             *  Conservative: boxes which cross the near plane are always
+             *  visible.
+             * 
+             *  @param matrix   Model view projection matrix.
+             *  @param min      Model space minimum corner.
+             *  @param max      Model space maximum corner.
+             * 
+             *  @return `false` if the box is completely hidden behind the
+             *  occluders.
+             */
+            bool test_box(const glm::mat4& matrix, glm::vec3 min, glm::vec3 max);
+
+            /*!
+             *  Test a screen rectangle.
+             * 
+             *  @param min_x,min_y,max_x,max_y  Pixel bounds (inclusive).
+             *  @param depth                    Closest depth (inverse W) of
+             *                                  the object.
+             * 
+             *  @return `false` if every pixel in the rectangle is closer than
+             *  `depth`.
+             */
+            bool test_rect(int min_x, int min_y, int max_x, int max_y, float depth);
+
+            /// Get the buffer width
+            unsigned int get_width();
+
+            /// Get the buffer height
+            unsigned int get_height();
+
+            /// Get the depth buffer, row by row from the bottom of the screen
+            const std::vector<float>& get_depth();
+
+            /*!
+             *  Run the self test.
+             * 
+             *  Checks edge coverage and interpolated depth against known
+             *  triangles, compares a triangle crossing the near plane with a
+             *  ray traced reference, and tests boxes against a wall.  Each
+             *  failure is logged.
+             * 
+             *  @return `true` if every check passed.
+             */
+            static bool self_test();
+
+    };
+
+}
+
+#endif
@@ -53,6 +53,15 @@ namespace se::util::dirs {
      */
     std::string app_data();
 
+    /*!
+     *  Create a directory.
+     * 
+     *  Any missing parent directories are also created.
+     * 
+     *  @return `true` if the directory exists or was created successfully.
+     */
+    bool create_directories(std::string path);
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+/*!
+ *  @file include/se/util/frustum.hpp
+ * 
+ *  View frustum culling helpers.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_UTIL_FRUSTUM_H_
+#define _SE_UTIL_FRUSTUM_H_
+
+#include <cstdint>
+#include <cstdlib>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace se::util::frustum {
+
+    /*!
+     *  Extract the frustum planes.
+     * 
+     *  Planes are extracted from a view projection matrix with the
+     *  Gribb/Hartmann method, and normalized so that `dot(plane.xyz, p) +
+     *  plane.w` is the signed distance of the point `p` from the plane.  The
+     *  inside of the frustum is on the positive side of every plane.
+     * 
+     *  @param matrix   View projection matrix.
+     *  @param planes   Left, right, bottom, top, near, and far planes.
+     */
+    void extract_planes(const glm::mat4& matrix, glm::vec4 planes[6]);
+
+    /*!
+     *  Transform a bounding sphere.
+     * 
+     *  The radius is scaled by the largest scale factor of the matrix, so the
+     *  result always contains the transformed sphere.
+     * 
+     *  @param matrix       Transformation matrix.
+     *  @param center       Sphere center, transformed in place.
+     *  @param radius       Sphere radius, scaled in place.
+     */
+    void transform_sphere(const glm::mat4& matrix, glm::vec3& center,
+        float& radius);
+
+    /*!
+     *  Test spheres against the frustum.
+     * 
+     *  Spheres are passed as separate arrays of components, so that four can
+     *  be tested against each plane at once.
+     * 
+     *  @param planes   Frustum planes (see `extract_planes()`).
+     *  @param x        Sphere center x coordinates.
+     *  @param y        Sphere center y coordinates.
+     *  @param z        Sphere center z coordinates.
+     *  @param radius   Sphere radii.
+     *  @param count    Number of spheres.
+     *  @param visible  Set to 1 for every sphere which intersects the frustum,
+     *                  and 0 for every sphere which doesn't.
+     * 
+     *  @return Number of visible spheres.
+     */
+    size_t cull_spheres(const glm::vec4 planes[6], const float* x,
+        const float* y, const float* z, const float* radius, size_t count,
+        uint8_t* visible);
+
+}
+
+#endif
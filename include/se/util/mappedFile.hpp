@@ -0,0 +1,68 @@
+/*!
+ *  @file include/se/util/mappedFile.hpp
+ * 
+ *  Read-only memory mapped files.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_UTIL_MAPPEDFILE_H_
+#define _SE_UTIL_MAPPEDFILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace se::util {
+
+    /*!
+     *  Mapped File.
+     * 
+     *  Maps the contents of a file into memory for reading.  Pages are loaded
+     *  by the kernel as they are accessed, so data can be used straight from
+     *  the mapping without being copied into an intermediate buffer.  The
+     *  mapping is released when the object is destroyed.
+     */
+    class MappedFile {
+
+        private:
+
+            /// Base address of the mapping
+            void* mapping = nullptr;
+
+            /// Size of the mapping in bytes
+            size_t mapping_size = 0;
+
+        public:
+
+            /*!
+             *  Map a file.
+             * 
+             *  If the file can not be mapped, `is_valid()` will return false.
+             *  A missing file is not considered an error and is not logged.
+             * 
+             *  @param path Path to the file.
+             */
+            MappedFile(std::string path);
+
+            /// Unmap the file
+            ~MappedFile();
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            /// Check if the file was successfully mapped
+            bool is_valid();
+
+            /// Get a pointer to the mapped data
+            const void* get_data();
+
+            /// Get the size of the mapped data in bytes
+            size_t get_size();
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,68 @@
+/*!
+ *  @file include/se/util/mipmap.hpp
+ * 
+ *  Mipmap chain generation helpers.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_UTIL_MIPMAP_H_
+#define _SE_UTIL_MIPMAP_H_
+
+#include <cstdint>
+#include <cstdlib>
+
+/*!
+ *  Mipmap chains are stored as every level in order, starting with the full
+ *  size image, with no padding between rows or levels.  Each level is half
+ *  the size of the previous one (rounded down, but never less than one pixel)
+ *  down to 1x1.
+ */
+namespace se::util::mipmap {
+
+    /*!
+     *  Count mip levels.
+     * 
+     *  @return Number of levels in a complete chain, including level 0.
+     */
+    unsigned int level_count(int width, int height);
+
+    /*!
+     *  Calculate mip chain size.
+     * 
+     *  @return Size in bytes of a complete chain of 8 bit per channel images.
+     */
+    size_t chain_size(int width, int height, int channels);
+
+    /*!
+     *  Downsample an image.
+     * 
+     *  Produces the next mip level from an 8 bit per channel image using a
+     *  2x2 box filter.  The last row or column of an odd sized image is
+     *  repeated.  The vertical pass is vectorized with SSE2 where available.
+     * 
+     *  @param src      Source image.
+     *  @param width    Source width.
+     *  @param height   Source height.
+     *  @param channels Number of channels per pixel.
+     *  @param dst      Destination image, sized for the next level.
+     */
+    void downsample(const uint8_t* src, int width, int height, int channels,
+        uint8_t* dst);
+
+    /*!
+     *  Generate a mip chain.
+     * 
+     *  @param data     Buffer of `chain_size()` bytes, with level 0 already
+     *                  populated.  The remaining levels are filled in.
+     *  @param width    Level 0 width.
+     *  @param height   Level 0 height.
+     *  @param channels Number of channels per pixel.
+     */
+    void generate(uint8_t* data, int width, int height, int channels);
+
+}
+
+#endif
@@ -0,0 +1,166 @@
+/*!
+ *  @file include/se/util/mpscQueue.hpp
+ *
+ *  Lock-free multi-producer single-consumer queue.
+ *
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ *
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_UTIL_MPSCQUEUE_H_
+#define _SE_UTIL_MPSCQUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace se::util {
+
+    /*!
+     *  Multi-Producer Single-Consumer Queue.
+     *
+     *  This is an intrusive linked list queue based on the design published by
+     *  Dmitry Vyukov.  Any number of threads may call `push()` at the same
+     *  time without blocking each other (a push is a single atomic exchange),
+     *  but only one thread may ever call `pop()`.
+     *
+     *  There is one quirk to be aware of: if a producer has been preempted in
+     *  the middle of a push, `pop()` may return `false` even though `size()`
+     *  is nonzero.  The consumer should simply try again later.
+     */
+    template<typename T>
+    class MPSCQueue {
+
+        private:
+
+            /// Queue node
+            struct Node {
+                /// Next node in the queue
+                std::atomic<Node*> next;
+                /// Node value
+                T value;
+            };
+
+            /*!
+             *  Queue Head.
+             *
+             *  Producers push new nodes onto this end of the queue.
+             */
+            std::atomic<Node*> head;
+
+            /*!
+             *  Queue Tail.
+             *
+             *  Only touched by the consumer.
+             */
+            Node* tail;
+
+            /*!
+             *  Stub Node.
+             *
+             *  The stub node allows the queue to be empty without the head and
+             *  tail ever becoming null.
+             */
+            Node stub;
+
+            /// Approximate number of elements in the queue
+            std::atomic<size_t> count;
+
+            /// Link a node onto the head of the queue
+            void push_node(Node* node) {
+                node->next.store(nullptr, std::memory_order_relaxed);
+                Node* prev = this->head.exchange(node, std::memory_order_acq_rel);
+                prev->next.store(node, std::memory_order_release);
+            }
+
+        public:
+
+            /// Construct a new (empty) queue
+            MPSCQueue() {
+                this->stub.next.store(nullptr, std::memory_order_relaxed);
+                this->head.store(&this->stub, std::memory_order_relaxed);
+                this->tail = &this->stub;
+                this->count.store(0, std::memory_order_relaxed);
+            }
+
+            /// Destroy the queue and any elements remaining in it
+            ~MPSCQueue() {
+                T discard;
+                while(this->pop(discard)) {}
+            }
+
+            MPSCQueue(const MPSCQueue&) = delete;
+            MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+            /*!
+             *  Push a value onto the queue.
+             *
+             *  This method is safe to call from any thread.
+             */
+            void push(T value) {
+                Node* node = new Node();
+                node->value = std::move(value);
+                this->count.fetch_add(1, std::memory_order_relaxed);
+                this->push_node(node);
+            }
+
+            /*!
+             *  Pop a value from the queue.
+             *
+             *  **Warning:** This method must only be called from the consumer
+             *  thread.
+             *
+             *  @param out  Destination for the popped value.
+             *
+             *  @return `true` if a value was popped, `false` otherwise.
+             */
+            bool pop(T& out) {
+                Node* tail = this->tail;
+                Node* next = tail->next.load(std::memory_order_acquire);
+                // Skip over the stub node
+                if(tail == &this->stub) {
+                    if(next == nullptr) { return false; }
+                    this->tail = next;
+                    tail = next;
+                    next = next->next.load(std::memory_order_acquire);
+                }
+                // Common case, there is more than one node in the queue
+                if(next != nullptr) {
+                    this->tail = next;
+                    out = std::move(tail->value);
+                    delete tail;
+                    this->count.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+                // A producer is in the middle of a push, try again later
+                if(tail != this->head.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                // Last node in the queue, re-insert the stub behind it
+                this->push_node(&this->stub);
+                next = tail->next.load(std::memory_order_acquire);
+                if(next != nullptr) {
+                    this->tail = next;
+                    out = std::move(tail->value);
+                    delete tail;
+                    this->count.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+                return false;
+            }
+
+            /*!
+             *  Get the number of elements in the queue.
+             *
+             *  This value is only approximate while producers are active.
+             */
+            size_t size() {
+                return this->count.load(std::memory_order_relaxed);
+            }
+
+    };
+
+}
+
+#endif
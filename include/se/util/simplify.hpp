@@ -0,0 +1,52 @@
+/*!
+ *  @file include/se/util/simplify.hpp
+ * 
+ *  Mesh simplification helpers.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_UTIL_SIMPLIFY_H_
+#define _SE_UTIL_SIMPLIFY_H_
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <glm/vec3.hpp>
+
+namespace se::util::simplify {
+
+    /*!
+     *  Simplify a mesh.
+     * 
+     *  Repeatedly collapses the edge with the lowest quadric error (Garland
+     *  and Heckbert, "Surface Simplification Using Quadric Error Metrics")
+     *  until the target triangle count is reached or no more edges can be
+     *  collapsed.  Vertices are only ever moved onto other existing vertices,
+     *  so the result indexes the original vertex array and can share its
+     *  vertex buffer.
+     * 
+     *  Vertices on open borders are locked.  Vertices which are split along
+     *  a uv or normal seam have open borders in the index buffer, so seams
+     *  are preserved too.  Collapses which would flip a triangle or make the
+     *  mesh non-manifold are rejected.
+     * 
+     *  @param indices              Triangle list indices.
+     *  @param index_count          Number of indices (a multiple of 3).
+     *  @param positions            Vertex positions.
+     *  @param vertex_count         Number of vertices.
+     *  @param target_index_count   Number of indices to aim for.
+     *  @param result               Simplified triangle list indices.
+     * 
+     *  @return Geometric error of the result, as an approximate distance from
+     *  the original surface.
+     */
+    float simplify(const uint32_t* indices, size_t index_count,
+        const glm::vec3* positions, size_t vertex_count,
+        size_t target_index_count, std::vector<uint32_t>& result);
+
+}
+
+#endif
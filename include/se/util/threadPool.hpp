@@ -0,0 +1,123 @@
+/*!
+ *  @file include/se/util/threadPool.hpp
+ * 
+ *  Worker thread pool for background jobs.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_UTIL_THREADPOOL_H_
+#define _SE_UTIL_THREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace se::util {
+
+    /// Worker job
+    typedef std::function<void(void)> WorkerJob;
+
+    /*!
+     *  Thread Pool.
+     * 
+     *  The thread pool owns a fixed number of worker threads which execute
+     *  jobs in the order they are submitted.  It is intended for slow,
+     *  thread-safe work such as file I/O and asset decoding which would
+     *  otherwise stall whichever thread requested it.
+     * 
+     *  **Note:** Workers have no OpenGL context.  Anything that touches the GPU
+     *  must still be handed off to the graphics controller.
+     */
+    class ThreadPool {
+
+        private:
+
+            /// Worker threads
+            std::vector<std::thread> workers;
+
+            /// Pending jobs
+            std::deque<WorkerJob> jobs;
+
+            /// Job queue mutex
+            std::mutex jobs_mutex;
+
+            /// Signalled when a job is submitted or the pool is stopping
+            std::condition_variable jobs_condition;
+
+            /// Run flag, cleared when the pool is destroyed
+            bool run = true;
+
+            /// Number of jobs currently being executed
+            std::atomic<uint32_t> active_jobs = 0;
+
+            /// Total number of jobs executed
+            std::atomic<uint64_t> stat_total_job_count = 0;
+
+            /// Total time spent executing jobs (summed over all workers)
+            std::atomic<uint64_t> stat_total_job_time_ns = 0;
+
+            /*!
+             *  Worker Thread.
+             * 
+             *  Body of each worker thread.  Runs until the pool is destroyed.
+             */
+            void worker_main(unsigned int index);
+
+        public:
+
+            /*!
+             *  Construct a new thread pool.
+             * 
+             *  @param thread_count Number of worker threads.  If zero, one
+             *                      worker is created per hardware thread, less
+             *                      one for the caller.
+             */
+            ThreadPool(unsigned int thread_count);
+
+            /*!
+             *  Destroy the thread pool.
+             * 
+             *  Jobs which have already been submitted are completed before the
+             *  workers exit.
+             */
+            ~ThreadPool();
+
+            /*!
+             *  Submit a job.
+             * 
+             *  This method may be called from any thread, including worker
+             *  threads.
+             */
+            void submit(WorkerJob job);
+
+            /*!
+             *  Run a loop in parallel.
+             * 
+             *  Calls `body` once for every index below `count`, spread across
+             *  the workers and the calling thread, and returns once every call
+             *  has completed.  The calling thread takes indices too, and only
+             *  waits for indices which are already running, so the loop
+             *  completes even if every worker is busy.  This makes it safe to
+             *  call from a worker thread.
+             */
+            void parallel_for(size_t count, const std::function<void(size_t)>& body);
+
+            /// Get the number of worker threads
+            unsigned int get_thread_count();
+
+            /// Get the number of jobs waiting or being executed
+            unsigned int pending_job_count();
+
+    };
+
+}
+
+#endif
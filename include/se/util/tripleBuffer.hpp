@@ -0,0 +1,105 @@
+/*!
+ *  @file include/se/util/tripleBuffer.hpp
+ *
+ *  Lock-free single-producer single-consumer triple buffer.
+ *
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ *
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_UTIL_TRIPLEBUFFER_H_
+#define _SE_UTIL_TRIPLEBUFFER_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace se::util {
+
+    /*!
+     *  Triple Buffer.
+     *
+     *  Passes complete values from one producer thread to one consumer thread
+     *  without either ever waiting for the other.  The producer fills the back
+     *  buffer and publishes it, the consumer acquires the most recently
+     *  published buffer.  Values published in between acquisitions are
+     *  skipped.
+     *
+     *  Buffers are recycled rather than reconstructed, so containers inside
+     *  of them keep their capacity.
+     */
+    template<typename T>
+    class TripleBuffer {
+
+        private:
+
+            /// Flag set in `middle` when it holds an unread value
+            static const uint8_t FRESH = 0x4;
+
+            /// Buffers
+            T buffers[3];
+
+            /// Index of the buffer being filled by the producer
+            uint8_t back = 0;
+
+            /// Index of the spare buffer, and the fresh flag
+            std::atomic<uint8_t> middle{1};
+
+            /// Index of the buffer being read by the consumer
+            uint8_t front = 2;
+
+        public:
+
+            /*!
+             *  Get the back buffer.
+             *
+             *  The buffer still contains whatever was written to it the last
+             *  time it was used.  Only the producer may call this method.
+             */
+            T& get_back() {
+                return this->buffers[this->back];
+            }
+
+            /*!
+             *  Publish the back buffer.
+             *
+             *  Only the producer may call this method.
+             */
+            void publish() {
+                uint8_t old = this->middle.exchange(this->back | FRESH,
+                    std::memory_order_acq_rel);
+                this->back = old & ~FRESH;
+            }
+
+            /*!
+             *  Acquire the most recently published buffer.
+             *
+             *  Only the consumer may call this method.
+             *
+             *  @return `true` if a new buffer was acquired, `false` if nothing
+             *  has been published since the last call.
+             */
+            bool acquire() {
+                if((this->middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+                    return false;
+                }
+                uint8_t old = this->middle.exchange(this->front,
+                    std::memory_order_acq_rel);
+                this->front = old & ~FRESH;
+                return true;
+            }
+
+            /*!
+             *  Get the front buffer.
+             *
+             *  Only the consumer may call this method.
+             */
+            T& get_front() {
+                return this->buffers[this->front];
+            }
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+/*!
+ *  @file include/se/util/vertexCache.hpp
+ * 
+ *  Post-transform vertex cache optimization helpers.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#ifndef _SE_UTIL_VERTEXCACHE_H_
+#define _SE_UTIL_VERTEXCACHE_H_
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace se::util::vertex_cache {
+
+    /*!
+     *  Optimize triangle order.
+     * 
+     *  Reorders the triangles of an indexed triangle list to improve the
+     *  post-transform vertex cache hit rate, using Tom Forsyth's "Linear-Speed
+     *  Vertex Cache Optimisation" algorithm.  Triangles keep their winding.
+     * 
+     *  @param indices      Triangle list indices, reordered in place.
+     *  @param index_count  Number of indices (a multiple of 3).
+     *  @param vertex_count Number of vertices referenced by the indices.
+     */
+    void optimize(uint32_t* indices, size_t index_count, size_t vertex_count);
+
+    /*!
+     *  Count vertex shader invocations.
+     * 
+     *  Simulates a FIFO post-transform cache to estimate how many times the
+     *  vertex shader will be invoked when drawing the given triangle list.
+     * 
+     *  @param indices      Triangle list indices.
+     *  @param index_count  Number of indices.
+     *  @param vertex_count Number of vertices referenced by the indices.
+     *  @param cache_size   Number of entries in the simulated cache.
+     * 
+     *  @return Estimated number of vertex shader invocations.
+     */
+    size_t count_transforms(const uint32_t* indices, size_t index_count,
+        size_t vertex_count, unsigned int cache_size = 32);
+
+}
+
+#endif
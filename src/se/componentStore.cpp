@@ -0,0 +1,218 @@
+/*!
+ *  @file src/se/componentStore.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/componentStore.hpp"
+
+#include "se/entity.hpp"
+
+#include "se/util/log.hpp"
+
+using namespace se;
+
+// ====================
+// == PUBLIC MEMBERS ==
+// ====================
+
+ComponentStore::~ComponentStore() {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    while(!this->dense_slots.empty()) {
+        uint32_t slot = this->dense_slots.back();
+        this->remove({slot, this->slots[slot].generation});
+    }
+}
+
+ComponentHandle ComponentStore::insert(se::Entity* entity) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    if(entity->components != nullptr) {
+        WARN("Entity [%s] is already in a component store", entity->get_name());
+        return entity->component_handle;
+    }
+    uint32_t slot;
+    if(this->free_slot != UINT32_MAX) {
+        slot = this->free_slot;
+        this->free_slot = this->slots[slot].dense;
+    } else {
+        slot = this->slots.size();
+        this->slots.push_back({0, 0});
+    }
+    this->slots[slot].dense = this->dense_slots.size();
+    ComponentHandle handle = {slot, this->slots[slot].generation};
+
+    uint8_t entity_flags = TRANSFORM_DIRTY;
+    if(entity->is_renderable()) {
+        entity_flags |= RENDERABLE;
+    }
+    if(entity->is_tickable()) {
+        entity_flags |= TICKABLE;
+    }
+    this->dense_slots.push_back(slot);
+    this->entities.push_back(entity);
+    this->positions.push_back(glm::vec3(entity->x, entity->y, entity->z));
+    this->rotations.push_back(glm::vec3(entity->rx, entity->ry, entity->rz));
+    this->scales.push_back(glm::vec3(entity->sx, entity->sy, entity->sz));
+    this->model_matrices.push_back(glm::mat4(1.0));
+    this->flags.push_back(entity_flags);
+
+    entity->components = this;
+    entity->component_handle = handle;
+    return handle;
+}
+
+void ComponentStore::remove(ComponentHandle handle) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    if(!this->is_valid(handle)) {
+        return;
+    }
+    uint32_t index = this->slots[handle.slot].dense;
+
+    // Give the transform back to the entity
+    se::Entity* entity = this->entities[index];
+    entity->components = nullptr;
+    entity->component_handle = ComponentHandle();
+    entity->x = this->positions[index].x;
+    entity->y = this->positions[index].y;
+    entity->z = this->positions[index].z;
+    entity->rx = this->rotations[index].x;
+    entity->ry = this->rotations[index].y;
+    entity->rz = this->rotations[index].z;
+    entity->sx = this->scales[index].x;
+    entity->sy = this->scales[index].y;
+    entity->sz = this->scales[index].z;
+
+    // Move the last entry into the hole
+    uint32_t last = this->dense_slots.size() - 1;
+    if(index != last) {
+        uint32_t moved_slot = this->dense_slots[last];
+        this->dense_slots[index] = moved_slot;
+        this->entities[index] = this->entities[last];
+        this->positions[index] = this->positions[last];
+        this->rotations[index] = this->rotations[last];
+        this->scales[index] = this->scales[last];
+        this->model_matrices[index] = this->model_matrices[last];
+        this->flags[index] = this->flags[last];
+        this->slots[moved_slot].dense = index;
+    }
+    this->dense_slots.pop_back();
+    this->entities.pop_back();
+    this->positions.pop_back();
+    this->rotations.pop_back();
+    this->scales.pop_back();
+    this->model_matrices.pop_back();
+    this->flags.pop_back();
+
+    // Release the slot
+    this->slots[handle.slot].generation++;
+    this->slots[handle.slot].dense = this->free_slot;
+    this->free_slot = handle.slot;
+}
+
+void ComponentStore::remove(se::Entity* entity) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    if(entity->components == this) {
+        this->remove(entity->component_handle);
+    }
+}
+
+bool ComponentStore::is_valid(ComponentHandle handle) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    return handle.slot < this->slots.size() &&
+        this->slots[handle.slot].generation == handle.generation &&
+        this->slots[handle.slot].dense < this->dense_slots.size() &&
+        this->dense_slots[this->slots[handle.slot].dense] == handle.slot;
+}
+
+uint32_t ComponentStore::get_index(ComponentHandle handle) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    return this->slots[handle.slot].dense;
+}
+
+glm::vec3 ComponentStore::get_position(ComponentHandle handle) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    return this->positions[this->slots[handle.slot].dense];
+}
+
+void ComponentStore::set_position(ComponentHandle handle, glm::vec3 position) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    this->positions[this->slots[handle.slot].dense] = position;
+}
+
+glm::vec3 ComponentStore::get_rotation(ComponentHandle handle) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    return this->rotations[this->slots[handle.slot].dense];
+}
+
+void ComponentStore::set_rotation(ComponentHandle handle, glm::vec3 rotation) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    this->rotations[this->slots[handle.slot].dense] = rotation;
+}
+
+glm::vec3 ComponentStore::get_scale(ComponentHandle handle) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    return this->scales[this->slots[handle.slot].dense];
+}
+
+void ComponentStore::set_scale(ComponentHandle handle, glm::vec3 scale) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    this->scales[this->slots[handle.slot].dense] = scale;
+}
+
+void ComponentStore::mark_dirty(ComponentHandle handle) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    this->flags[this->slots[handle.slot].dense] |= TRANSFORM_DIRTY;
+}
+
+void ComponentStore::update_transforms() {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    uint8_t* entry_flags = this->flags.data();
+    size_t count = this->flags.size();
+    for(size_t i = 0; i < count; i++) {
+        if(entry_flags[i] & TRANSFORM_DIRTY) {
+            /* The entity resolves its parents, which may not have been
+            updated yet, and caches the result for its children. */
+            this->model_matrices[i] = this->entities[i]->get_model_matrix();
+            entry_flags[i] &= ~TRANSFORM_DIRTY;
+        }
+    }
+}
+
+void ComponentStore::query(uint8_t mask, std::vector<uint32_t>& indices) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    indices.clear();
+    const uint8_t* entry_flags = this->flags.data();
+    size_t count = this->flags.size();
+    for(size_t i = 0; i < count; i++) {
+        if(entry_flags[i] & mask) {
+            indices.push_back(i);
+        }
+    }
+}
+
+size_t ComponentStore::size() {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    return this->dense_slots.size();
+}
+
+std::recursive_mutex& ComponentStore::get_mutex() {
+    return this->mutex;
+}
+
+se::Entity* const* ComponentStore::get_entities() {
+    return this->entities.data();
+}
+
+const glm::vec3* ComponentStore::get_positions() {
+    return this->positions.data();
+}
+
+const glm::mat4* ComponentStore::get_model_matrices() {
+    return this->model_matrices.data();
+}
+
+const uint8_t* ComponentStore::get_flags() {
+    return this->flags.data();
+}
@@ -15,6 +15,9 @@
 #include "se/util/log.hpp"
 #include "se/util/config.hpp"
 #include "se/util/dirs.hpp"
+#include "se/util/threadPool.hpp"
+
+#include <algorithm>
 
 se::Engine::Engine() {
     // Load the base configuration
@@ -24,6 +27,9 @@ se::Engine::Engine() {
     cfgfile += "/config.cfg";
     this->config->load(cfgfile.c_str());
 
+    // Initialize workers (0 or less uses the hardware thread count)
+    int worker_threads = this->config->get_int("engine.worker_threads", 0);
+    this->worker_pool = new se::util::ThreadPool(std::max(worker_threads, 0));
     // Initialize inputs
     this->input_controller = new se::input::InputController(this);
     // Initialize graphics
@@ -38,6 +44,9 @@ se::Engine::~Engine() {
 
     this->threads_run = false;
 
+    /* Workers go first, as pending jobs may still need to submit tasks to the
+    other controllers. */
+    delete this->worker_pool;
     delete this->graphics_controller;
     delete this->input_controller;
     delete this->logic_controller;
@@ -8,8 +8,11 @@
 
 #include "se/entity.hpp"
 
+#include "se/graphics/commandList.hpp"
+#include "se/graphics/renderQueue.hpp"
 #include "se/util/log.hpp"
 
+#include <algorithm>
 #include <cstdio>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/transform.hpp>
@@ -18,10 +21,30 @@
 // == VIRTUAL MEMBERS ==
 // =====================
 
-void se::Entity::render(glm::mat4 camera_matrix) {
+void se::Entity::render(glm::mat4 camera_matrix, glm::mat4 model_matrix) {
     WARN("Renderable entity failed to override `render()`!");
 }
 
+void se::Entity::record(const glm::mat4& model_matrix,
+    se::graphics::DrawCommand& command) {
+    command.type = se::graphics::DrawCommandType::RENDER;
+}
+
+void se::Entity::get_render_state(se::graphics::RenderState& state) {
+    // Defaults are fine
+}
+
+bool se::Entity::get_bounds(const glm::mat4& model_matrix, glm::vec3& center,
+    float& radius) {
+    return false;
+}
+
+bool se::Entity::get_occluder(glm::vec3& min, glm::vec3& max) {
+    return false;
+}
+
+void se::Entity::select_lod(const glm::mat4& model_matrix, float pixels_per_unit) {}
+
 void se::Entity::tick() {
     WARN("Tickable entity failed to override `tick()`!");
 }
@@ -35,9 +58,42 @@ se::Entity::Entity() {
 }
 
 se::Entity::~Entity() {
+    if(this->components != nullptr) {
+        this->components->remove(this->component_handle);
+    }
+    this->set_parent(nullptr);
+    for(Entity* child : this->children) {
+        child->parent = nullptr;
+        child->invalidate_world();
+    }
     free((void*) this->name);
 }
 
+void se::Entity::invalidate_world() {
+    if(this->world_dirty) {
+        return;
+    }
+    this->world_dirty = true;
+    if(this->components != nullptr) {
+        this->components->mark_dirty(this->component_handle);
+    }
+    for(Entity* child : this->children) {
+        child->invalidate_world();
+    }
+}
+
+void se::Entity::invalidate_transform() {
+    this->local_dirty = true;
+    this->invalidate_world();
+}
+
+std::unique_lock<std::recursive_mutex> se::Entity::lock_components() {
+    if(this->components == nullptr) {
+        return std::unique_lock<std::recursive_mutex>();
+    }
+    return std::unique_lock<std::recursive_mutex>(this->components->get_mutex());
+}
+
 #define MATRIX(a,b,c,d,e,f,g,h,i,j,k,l,m,n,o,p) { \
     {a,e,i,m}, \
     {b,f,j,n}, \
@@ -45,17 +101,24 @@ se::Entity::~Entity() {
     {d,h,l,p} \
 }
 
-glm::mat4 se::Entity::get_model_matrix() {
+const glm::mat4& se::Entity::get_local_matrix() {
+    if(!this->local_dirty) {
+        return this->local_matrix;
+    }
+    this->local_dirty = false;
+    glm::vec3 position = this->get_position();
+    glm::vec3 rotation = this->get_rotation();
+    glm::vec3 scale_factor = this->get_scale();
 
     glm::mat4 translate = MATRIX(
-        1.0, 0.0, 0.0, this->x,
-        0.0, 1.0, 0.0, this->y,
-        0.0, 0.0, 1.0, this->z,
+        1.0, 0.0, 0.0, position.x,
+        0.0, 1.0, 0.0, position.y,
+        0.0, 0.0, 1.0, position.z,
         0.0, 0.0, 0.0, 1.0
     );
 
-    float xcos = cos(this->rx);
-    float xsin = sin(this->rx);
+    float xcos = cos(rotation.x);
+    float xsin = sin(rotation.x);
     glm::mat4 rotate_x = MATRIX(
         1.0,  0.0,   0.0, 0.0,
         0.0, xcos, -xsin, 0.0,
@@ -63,8 +126,8 @@ glm::mat4 se::Entity::get_model_matrix() {
         0.0,  0.0,   0.0, 1.0
     );
 
-    float ycos = cos(this->ry);
-    float ysin = sin(this->ry);
+    float ycos = cos(rotation.y);
+    float ysin = sin(rotation.y);
     glm::mat4 rotate_y = MATRIX(
          ycos, 0.0, ysin, 0.0,
           0.0, 1.0,  0.0, 0.0,
@@ -72,8 +135,8 @@ glm::mat4 se::Entity::get_model_matrix() {
           0.0, 0.0,  0.0, 1.0
     );
 
-    float zcos = cos(this->rz);
-    float zsin = sin(this->rz);
+    float zcos = cos(rotation.z);
+    float zsin = sin(rotation.z);
     glm::mat4 rotate_z = MATRIX(
         zcos, -zsin, 0.0, 0.0,
         zsin,  zcos, 0.0, 0.0,
@@ -82,14 +145,122 @@ glm::mat4 se::Entity::get_model_matrix() {
     );
 
     glm::mat4 scale = MATRIX(
-        this->sx, 0.0, 0.0, 0.0,
-        0.0, this->sy, 0.0, 0.0,
-        0.0, 0.0, this->sz, 0.0,
+        scale_factor.x, 0.0, 0.0, 0.0,
+        0.0, scale_factor.y, 0.0, 0.0,
+        0.0, 0.0, scale_factor.z, 0.0,
         0.0, 0.0, 0.0, 1.0
     );
 
-    return translate * rotate_z * rotate_y * rotate_x * scale;
+    this->local_matrix = translate * rotate_z * rotate_y * rotate_x * scale;
+    return this->local_matrix;
+
+}
+
+const glm::mat4& se::Entity::get_model_matrix() {
+    if(!this->world_dirty) {
+        return this->world_matrix;
+    }
+    /* A dirty entity always has dirty descendants, so the parent chain is
+    resolved first and the subtree below is recalculated on demand as each
+    child is requested. */
+    if(this->parent == nullptr) {
+        this->world_matrix = this->get_local_matrix();
+    } else {
+        this->world_matrix = this->parent->get_model_matrix() *
+            this->get_local_matrix();
+    }
+    this->world_dirty = false;
+    return this->world_matrix;
+}
+
+void se::Entity::set_position(float x, float y, float z) {
+    auto lock = this->lock_components();
+    if(this->components != nullptr) {
+        this->components->set_position(this->component_handle, glm::vec3(x, y, z));
+    } else {
+        this->x = x;
+        this->y = y;
+        this->z = z;
+    }
+    this->invalidate_transform();
+}
+
+glm::vec3 se::Entity::get_position() {
+    if(this->components != nullptr) {
+        return this->components->get_position(this->component_handle);
+    }
+    return glm::vec3(this->x, this->y, this->z);
+}
+
+void se::Entity::set_rotation(float rx, float ry, float rz) {
+    auto lock = this->lock_components();
+    if(this->components != nullptr) {
+        this->components->set_rotation(this->component_handle, glm::vec3(rx, ry, rz));
+    } else {
+        this->rx = rx;
+        this->ry = ry;
+        this->rz = rz;
+    }
+    this->invalidate_transform();
+}
+
+glm::vec3 se::Entity::get_rotation() {
+    if(this->components != nullptr) {
+        return this->components->get_rotation(this->component_handle);
+    }
+    return glm::vec3(this->rx, this->ry, this->rz);
+}
+
+void se::Entity::set_scale(float sx, float sy, float sz) {
+    auto lock = this->lock_components();
+    if(this->components != nullptr) {
+        this->components->set_scale(this->component_handle, glm::vec3(sx, sy, sz));
+    } else {
+        this->sx = sx;
+        this->sy = sy;
+        this->sz = sz;
+    }
+    this->invalidate_transform();
+}
+
+glm::vec3 se::Entity::get_scale() {
+    if(this->components != nullptr) {
+        return this->components->get_scale(this->component_handle);
+    }
+    return glm::vec3(this->sx, this->sy, this->sz);
+}
+
+bool se::Entity::set_parent(Entity* parent) {
+    if(parent == this->parent) {
+        return true;
+    }
+    for(Entity* ancestor = parent; ancestor != nullptr; ancestor = ancestor->parent) {
+        if(ancestor == this) {
+            WARN("Refusing to parent [%s] to its own descendant [%s]",
+                this->name, parent->name);
+            return false;
+        }
+    }
+    auto lock = this->lock_components();
+    if(this->parent != nullptr) {
+        std::vector<Entity*>& siblings = this->parent->children;
+        siblings.erase(std::remove(siblings.begin(), siblings.end(), this),
+            siblings.end());
+    }
+    this->parent = parent;
+    if(parent != nullptr) {
+        parent->children.push_back(this);
+    }
+    this->invalidate_world();
+    return true;
+}
+
+se::Entity* se::Entity::get_parent() {
+    return this->parent;
+}
 
+const std::vector<se::Entity*>& se::Entity::get_children() {
+    return this->children;
 }
 
 void se::Entity::set_name(const char* name) {
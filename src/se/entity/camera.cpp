@@ -36,6 +36,10 @@ Camera::~Camera() {}
 }
 
 glm::mat4 Camera::get_camera_matrix() {
+    return this->get_projection_matrix() * this->get_view_matrix();
+}
+
+glm::mat4 Camera::get_view_matrix() {
 
     /* Okay here's a quick lesson in linear algebra.  If you have a point that
     is located somewhere in 3D space, and you want to transform that point to a
@@ -67,18 +71,22 @@ glm::mat4 Camera::get_camera_matrix() {
     /* Values are inverted because we're moving the world relative to the camera
     instead of moving the camera realative to the world. */
 
+    glm::vec3 position = this->get_position();
+    glm::vec3 rotation = this->get_rotation();
+    glm::vec3 scale_factor = this->get_scale();
+
     glm::mat4 translate = MATRIX(
-        1.0, 0.0, 0.0, -this->x,
-        0.0, 1.0, 0.0, -this->y,
-        0.0, 0.0, 1.0, -this->z,
+        1.0, 0.0, 0.0, -position.x,
+        0.0, 1.0, 0.0, -position.y,
+        0.0, 0.0, 1.0, -position.z,
         0.0, 0.0, 0.0, 1.0     
     );
 
     /* A 90 degree offset is applied to the angle to shift the world around so
     that Z is the up direction, and by default the camera is looking directly
     along the +Y axis */
-    float xcos = cos(-this->rx - 1.5708);
-    float xsin = sin(-this->rx - 1.5708);
+    float xcos = cos(-rotation.x - 1.5708);
+    float xsin = sin(-rotation.x - 1.5708);
     glm::mat4 rotate_x = MATRIX(
         1.0,  0.0,   0.0, 0.0,
         0.0, xcos, -xsin, 0.0,
@@ -86,8 +94,8 @@ glm::mat4 Camera::get_camera_matrix() {
         0.0,  0.0,   0.0, 1.0
     );
 
-    float ycos = cos(-this->ry);
-    float ysin = sin(-this->ry);
+    float ycos = cos(-rotation.y);
+    float ysin = sin(-rotation.y);
     glm::mat4 rotate_y = MATRIX(
          ycos, 0.0, ysin, 0.0,
           0.0, 1.0,  0.0, 0.0,
@@ -95,8 +103,8 @@ glm::mat4 Camera::get_camera_matrix() {
           0.0, 0.0,  0.0, 1.0
     );
 
-    float zcos = cos(-this->rz);
-    float zsin = sin(-this->rz);
+    float zcos = cos(-rotation.z);
+    float zsin = sin(-rotation.z);
     glm::mat4 rotate_z = MATRIX(
         zcos, -zsin, 0.0, 0.0,
         zsin,  zcos, 0.0, 0.0,
@@ -105,24 +113,28 @@ glm::mat4 Camera::get_camera_matrix() {
     );
 
     glm::mat4 scale = MATRIX(
-        1.0 / this->sx, 0.0, 0.0, 0.0,
-        0.0, 1.0 / this->sy, 0.0, 0.0,
-        0.0, 0.0, 1.0 / this->sz, 0.0,
+        1.0 / scale_factor.x, 0.0, 0.0, 0.0,
+        0.0, 1.0 / scale_factor.y, 0.0, 0.0,
+        0.0, 0.0, 1.0 / scale_factor.z, 0.0,
         0.0, 0.0, 0.0, 1.0
     );
 
-    /* I'm using the glm method here because there's basically no
-    performance to be saved by hand-calculating the values like there was above.
-    It might be worth a future expansion to save some cycles in not
-    recalculating values that don't need to be constantly recalculated, but
-    that sounds like a problem for the future. */
-    float aspect = ((float) *(this->width)) / ((float) *(this->height));
-    glm::mat4 projection = glm::perspective(*this->fov, aspect, *this->near, *this->far);
-
     /* Operations are performed from right to left, in the opposite order from
     models.  This means that the models will first be translated into position,
-    then rotated about the camera (in x->y->z order), scaled, and finally
-    projected into screen space. */
-    return projection * scale * rotate_x * rotate_y * rotate_z * translate;
+    then rotated about the camera (in x->y->z order), and scaled.  Projection
+    into screen space happens last (see `get_camera_matrix()`). */
+    return scale * rotate_x * rotate_y * rotate_z * translate;
+
+}
+
+glm::mat4 Camera::get_projection_matrix() {
+
+    /* I'm using the glm method here because there's basically no
+    performance to be saved by hand-calculating the values like there was in
+    the view matrix.  It might be worth a future expansion to save some cycles
+    in not recalculating values that don't need to be constantly recalculated,
+    but that sounds like a problem for the future. */
+    float aspect = ((float) *(this->width)) / ((float) *(this->height));
+    return glm::perspective(*this->fov, aspect, *this->near, *this->far);
 
 }
\ No newline at end of file
@@ -53,20 +53,8 @@ void FPCamera::sdl_event_handler(SDL_Event event) {
             this->key_d = (event.type == SDL_KEYDOWN);
         }
     } else if(event.type == SDL_MOUSEMOTION) {
-        int x = event.motion.xrel;
-        int y = event.motion.yrel;
-        this->rz -= (x / 600.0);
-        this->rx -= (y / 600.0);
-        if(this->rx > 1.5707) {
-            this->rx = 1.5707;
-        } else if(this->rx < -1.5707) {
-            this->rx = -1.5707;
-        }
-        if(this->rz > 6.2831) {
-            this->rz -= 6.2831;
-        } else if(this->rz < 0) {
-            this->rz += 6.2831;
-        }
+        this->mouse_dx += event.motion.xrel;
+        this->mouse_dy += event.motion.yrel;
     }
 }
 
@@ -97,7 +85,26 @@ void FPCamera::release_mouse() {
 void FPCamera::tick(uint64_t clock, uint32_t cdelta) {
     /* THIS IS A REALLY HACKY SOLUTION THAT SHOULD NOT BE DONE THIS WAY!  IT
     COMPLETELY IGNORES ENGINE TIME SCALING, WHICH IS LIKE SUPER ULTRA MEGA BAD. */
-    float move_angle = this->rz;
+    int x = this->mouse_dx.exchange(0);
+    int y = this->mouse_dy.exchange(0);
+    glm::vec3 rotation = this->get_rotation();
+    if(x != 0 || y != 0) {
+        rotation.z -= (x / 600.0);
+        rotation.x -= (y / 600.0);
+        if(rotation.x > 1.5707) {
+            rotation.x = 1.5707;
+        } else if(rotation.x < -1.5707) {
+            rotation.x = -1.5707;
+        }
+        if(rotation.z > 6.2831) {
+            rotation.z -= 6.2831;
+        } else if(rotation.z < 0) {
+            rotation.z += 6.2831;
+        }
+        this->set_rotation(rotation.x, rotation.y, rotation.z);
+    }
+
+    float move_angle = rotation.z;
     //if((this->key_a && !this->key_d && this->key_w) || (!this->key_a && this->key_d && this->key_s)) {
     //    move_angle += 3.14159 / 4;
     //} else if((!this->key_a && this->key_d && this->key_w) || (this->key_a && !this->key_d && this->key_s)) {
@@ -128,6 +135,6 @@ void FPCamera::tick(uint64_t clock, uint32_t cdelta) {
 
     float dx = sin(move_angle) * .05;
     float dy = cos(move_angle) * .05;
-    this->x -= dx;
-    this->y += dy;
+    glm::vec3 position = this->get_position();
+    this->set_position(position.x - dx, position.y + dy, position.z);
 }
\ No newline at end of file
@@ -9,14 +9,17 @@
 #include "se/entity/sign.hpp"
 
 #include "se/engine.hpp"
+#include "se/graphics/commandList.hpp"
 #include "se/graphics/geometry.hpp"
 #include "se/graphics/graphicsController.hpp"
 #include "se/graphics/renderManager.hpp"
 #include "se/graphics/shader.hpp"
 #include "se/graphics/shaderProgram.hpp"
 #include "se/graphics/imageTexture.hpp"
+#include "se/graphics/renderQueue.hpp"
 #include "se/graphics/textTexture.hpp"
 
+#include "se/util/frustum.hpp"
 #include "se/util/log.hpp"
 
 #include <string.h>
@@ -41,7 +44,7 @@ Sign::~Sign() {
     free((void*)this->model_name);
 }
 
-void Sign::render(glm::mat4 camera_matrix) {
+void Sign::render(glm::mat4 camera_matrix, glm::mat4 model_matrix) {
 
     if(this->geometry->get_resource_state() != se::util::LoadableResourceState::LOADED ||
         this->texture->get_resource_state() != se::util::LoadableResourceState::LOADED ||
@@ -53,15 +56,45 @@ void Sign::render(glm::mat4 camera_matrix) {
     this->shader_program->use_program();
     this->texture->use_texture(GL_TEXTURE0);
 
-    glm::mat4 model_matrix = this->get_model_matrix();
-    glm::mat4 mvp_matrix = camera_matrix * model_matrix;
-    glUniformMatrix4fv(SE_SHADER_LOC_IN_MVP, 1, GL_FALSE, &mvp_matrix[0][0]);
+    // The camera matrix is applied from the frame uniforms
     glUniformMatrix4fv(SE_SHADER_LOC_IN_MODEL_MAT, 1, GL_FALSE, &model_matrix[0][0]);
 
     this->geometry->use_geometry();
 
 }
 
+void Sign::record(const glm::mat4& model_matrix, DrawCommand& command) {
+    if(this->geometry->get_resource_state() != se::util::LoadableResourceState::LOADED ||
+        this->texture->get_resource_state() != se::util::LoadableResourceState::LOADED ||
+        this->shader_program->get_resource_state() != se::util::LoadableResourceState::LOADED){
+        command.type = DrawCommandType::SKIP;
+        return;
+    }
+    command.type = DrawCommandType::DRAW;
+    command.program = this->shader_program;
+    command.geometry = this->geometry;
+    command.texture = this->texture;
+}
+
+void Sign::get_render_state(RenderState& state) {
+    state.layer = RenderLayer::OPAQUE;
+    state.program = this->shader_program;
+    state.texture = this->texture;
+    state.geometry = this->geometry;
+}
+
+bool Sign::get_bounds(const glm::mat4& model_matrix, glm::vec3& center,
+    float& radius) {
+    if(this->geometry->get_resource_state() != se::util::LoadableResourceState::LOADED) {
+        return false;
+    }
+    GeometryBounds bounds = this->geometry->get_bounds();
+    center = bounds.center;
+    radius = bounds.radius;
+    se::util::frustum::transform_sphere(model_matrix, center, radius);
+    return true;
+}
+
 void Sign::set_text(std::string text) {
     this->texture->update_text(text);
 }
\ No newline at end of file
@@ -9,12 +9,15 @@
 #include "se/entity/skybox.hpp"
 
 #include "se/engine.hpp"
+#include "se/graphics/commandList.hpp"
 #include "se/graphics/geometry.hpp"
+#include "se/graphics/glState.hpp"
 #include "se/graphics/graphicsController.hpp"
 #include "se/graphics/renderManager.hpp"
 #include "se/graphics/shader.hpp"
 #include "se/graphics/shaderProgram.hpp"
 #include "se/graphics/imageTexture.hpp"
+#include "se/graphics/renderQueue.hpp"
 
 #include "se/util/log.hpp"
 
@@ -50,7 +53,7 @@ Skybox::~Skybox() {
     free((void*)this->texture_name);
 }
 
-void Skybox::render(glm::mat4 camera_matrix) {
+void Skybox::render(glm::mat4 camera_matrix, glm::mat4 model_matrix) {
 
     if(this->geometry->get_resource_state() != se::util::LoadableResourceState::LOADED ||
         this->texture->get_resource_state() != se::util::LoadableResourceState::LOADED ||
@@ -69,14 +72,37 @@ void Skybox::render(glm::mat4 camera_matrix) {
 
     //glUniform1i(SE_SHADER_LOC_OUT_BG, SE_SHADER_LOC_OUT_BG);
 
-    glUniformMatrix4fv(SE_SHADER_LOC_IN_MVP, 1, GL_FALSE, &camera_matrix[0][0]);
     /* The skybox does not have a model matrix because it is statically
-    positioned in 3D space. */
+    positioned in 3D space.  The camera matrix is applied from the frame
+    uniforms. */
 
     /* The depth buffer is used to determine when to show the skybox.  Writing
     to the buffer is disabled so that clipped values can be used to show the
     skybox. */
-    glDepthMask(GL_FALSE);
+    GLState::depth_mask(false);
     this->geometry->use_geometry();
-    glDepthMask(GL_TRUE);
+    GLState::depth_mask(true);
+}
+
+void Skybox::record(const glm::mat4& model_matrix, DrawCommand& command) {
+    if(this->geometry->get_resource_state() != se::util::LoadableResourceState::LOADED ||
+        this->texture->get_resource_state() != se::util::LoadableResourceState::LOADED ||
+        this->shader_program->get_resource_state() != se::util::LoadableResourceState::LOADED){
+        command.type = DrawCommandType::SKIP;
+        return;
+    }
+    // See `render()`, the skybox has no model matrix and doesn't write depth
+    command.type = DrawCommandType::DRAW;
+    command.flags = DrawCommand::NO_DEPTH_WRITE;
+    command.program = this->shader_program;
+    command.geometry = this->geometry;
+    command.texture = this->texture;
+}
+
+void Skybox::get_render_state(RenderState& state) {
+    // The skybox doesn't write depth, so it has to go first
+    state.layer = RenderLayer::BACKGROUND;
+    state.program = this->shader_program;
+    state.texture = this->texture;
+    state.geometry = this->geometry;
 }
\ No newline at end of file
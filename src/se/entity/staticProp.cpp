@@ -9,15 +9,22 @@
 #include "se/entity/staticProp.hpp"
 
 #include "se/engine.hpp"
+#include "se/graphics/commandList.hpp"
 #include "se/graphics/geometry.hpp"
 #include "se/graphics/graphicsController.hpp"
 #include "se/graphics/renderManager.hpp"
 #include "se/graphics/shader.hpp"
 #include "se/graphics/shaderProgram.hpp"
 #include "se/graphics/imageTexture.hpp"
+#include "se/graphics/renderQueue.hpp"
+#include "se/graphics/textureArray.hpp"
 
+#include "se/util/config.hpp"
+#include "se/util/frustum.hpp"
 #include "se/util/log.hpp"
 
+#include <algorithm>
+#include <glm/geometric.hpp>
 #include <string.h>
 
 using namespace se::entity;
@@ -28,32 +35,58 @@ StaticProp::StaticProp(se::Engine* engine, const char* model, const char* textur
     this->model_name = strdup(model);
     this->texture_name = strdup(texture);
     this->geometry = se::graphics::Geometry::get_geometry(engine, model);
-    this->texture = se::graphics::ImageTexture::get_texture(engine, texture);
-    this->shader_program = se::graphics::ShaderProgram::get_program(
-        engine, "static_prop", "", "static_prop", "");
+    bool instancing = engine->config->get_bool("render.instancing", false);
+    TextureArrayManager* arrays = engine->graphics_controller->get_texture_array_manager();
+    if(arrays != nullptr) {
+        this->texture_layer = arrays->get_layer(texture);
+        this->texture_resource = this->texture_layer;
+        this->shader_program = se::graphics::ShaderProgram::get_program(
+            engine, "static_prop", "", "static_prop", "#define TEXTURE_ARRAY\n");
+        if(instancing) {
+            this->instanced_program = se::graphics::ShaderProgram::get_program(
+                engine, "static_prop", "#define INSTANCED\n", "static_prop",
+                "#define INSTANCED\n#define TEXTURE_ARRAY\n");
+        }
+    } else {
+        this->texture = se::graphics::ImageTexture::get_texture(engine, texture);
+        this->texture_resource = this->texture;
+        this->shader_program = se::graphics::ShaderProgram::get_program(
+            engine, "static_prop", "", "static_prop", "");
+        if(instancing) {
+            this->instanced_program = se::graphics::ShaderProgram::get_program(
+                engine, "static_prop", "#define INSTANCED\n", "static_prop",
+                "#define INSTANCED\n");
+        }
+    }
     this->geometry->increment_resource_user_counter();
-    this->texture->increment_resource_user_counter();
+    this->texture_resource->increment_resource_user_counter();
     this->shader_program->increment_resource_user_counter();
+    if(this->instanced_program != nullptr) {
+        this->instanced_program->increment_resource_user_counter();
+    }
 }
 
 StaticProp::~StaticProp() {
     this->geometry->decrement_resource_user_counter();
-    this->texture->decrement_resource_user_counter();
+    this->texture_resource->decrement_resource_user_counter();
     this->shader_program->decrement_resource_user_counter();
+    if(this->instanced_program != nullptr) {
+        this->instanced_program->decrement_resource_user_counter();
+    }
     free((void*)this->model_name);
     free((void*)this->texture_name);
 }
 
-void StaticProp::render(glm::mat4 camera_matrix) {
+void StaticProp::render(glm::mat4 camera_matrix, glm::mat4 model_matrix) {
 
     if(this->geometry->get_resource_state() != se::util::LoadableResourceState::LOADED ||
-        this->texture->get_resource_state() != se::util::LoadableResourceState::LOADED ||
+        this->texture_resource->get_resource_state() != se::util::LoadableResourceState::LOADED ||
         this->shader_program->get_resource_state() != se::util::LoadableResourceState::LOADED){
         // Not ready to render
         DEBUG("Static prop [m: %s t: %s] not ready [m: %s t: %s s: %s]",
             this->model_name, this->texture_name,
             se::util::loadable_resource_state_name(this->geometry->get_resource_state()),
-            se::util::loadable_resource_state_name(this->texture->get_resource_state()),
+            se::util::loadable_resource_state_name(this->texture_resource->get_resource_state()),
             se::util::loadable_resource_state_name(this->shader_program->get_resource_state()));
         return;
     }
@@ -62,13 +95,127 @@ void StaticProp::render(glm::mat4 camera_matrix) {
     //    this->model_name, this->texture_name);
 
     this->shader_program->use_program();
-    this->texture->use_texture(GL_TEXTURE0);
+    if(this->texture_layer != nullptr) {
+        this->texture_layer->use_layer(GL_TEXTURE0);
+    } else {
+        this->texture->use_texture(GL_TEXTURE0);
+    }
 
-    glm::mat4 model_matrix = this->get_model_matrix();
-    glm::mat4 mvp_matrix = camera_matrix * model_matrix;
-    glUniformMatrix4fv(SE_SHADER_LOC_IN_MVP, 1, GL_FALSE, &mvp_matrix[0][0]);
+    // The camera matrix is applied from the frame uniforms
     glUniformMatrix4fv(SE_SHADER_LOC_IN_MODEL_MAT, 1, GL_FALSE, &model_matrix[0][0]);
 
-    this->geometry->use_geometry();
+    this->geometry->use_geometry(this->lod);
+
+}
+
+void StaticProp::record(const glm::mat4& model_matrix, DrawCommand& command) {
+    /* Instanced props are batched when the commands are replayed, but can
+    still be drawn on their own (see `se::graphics::OcclusionCuller`). */
+    bool ready = this->geometry->get_resource_state() == se::util::LoadableResourceState::LOADED &&
+        this->texture_resource->get_resource_state() == se::util::LoadableResourceState::LOADED &&
+        this->shader_program->get_resource_state() == se::util::LoadableResourceState::LOADED;
+    command.type = DrawCommandType::DRAW;
+    command.program = this->shader_program;
+    if(this->instanced_program != nullptr) {
+        command.type = DrawCommandType::INSTANCED;
+        command.instanced_program = this->instanced_program;
+        ready = ready && this->is_ready_for_batching();
+    }
+    if(!ready) {
+        command.type = DrawCommandType::SKIP;
+        return;
+    }
+    command.geometry = this->geometry;
+    command.texture = this->texture;
+    command.texture_layer = this->texture_layer;
+    command.lod = this->lod;
+}
+
+void StaticProp::get_render_state(RenderState& state) {
+    state.layer = RenderLayer::OPAQUE;
+    state.geometry = this->geometry;
+    if(this->instanced_program != nullptr) {
+        state.program = this->instanced_program;
+    } else {
+        state.program = this->shader_program;
+    }
+    if(this->texture_layer != nullptr) {
+        state.texture = this->texture_layer->get_array();
+    } else {
+        state.texture = this->texture;
+    }
+}
+
+bool StaticProp::get_bounds(const glm::mat4& model_matrix, glm::vec3& center,
+    float& radius) {
+    if(this->geometry->get_resource_state() != se::util::LoadableResourceState::LOADED) {
+        return false;
+    }
+    GeometryBounds bounds = this->geometry->get_bounds();
+    center = bounds.center;
+    radius = bounds.radius;
+    se::util::frustum::transform_sphere(model_matrix, center, radius);
+    return true;
+}
+
+bool StaticProp::get_occluder(glm::vec3& min, glm::vec3& max) {
+    if(!this->occluder) {
+        return false;
+    }
+    if(this->occluder_box_set) {
+        min = this->occluder_min;
+        max = this->occluder_max;
+        return true;
+    }
+    if(this->geometry->get_resource_state() != se::util::LoadableResourceState::LOADED) {
+        return false;
+    }
+    GeometryBounds bounds = this->geometry->get_bounds();
+    min = bounds.min;
+    max = bounds.max;
+    return true;
+}
+
+void StaticProp::set_occluder(bool occluder) {
+    this->occluder = occluder;
+}
+
+void StaticProp::set_occluder_box(glm::vec3 min, glm::vec3 max) {
+    this->occluder_min = min;
+    this->occluder_max = max;
+    this->occluder_box_set = true;
+}
+
+void StaticProp::select_lod(const glm::mat4& model_matrix, float pixels_per_unit) {
+    // Geometry errors are in model space
+    float scale = std::max(glm::length(glm::vec3(model_matrix[0])),
+        std::max(glm::length(glm::vec3(model_matrix[1])), glm::length(glm::vec3(model_matrix[2]))));
+    this->lod = this->geometry->select_lod(pixels_per_unit * scale, this->lod);
+}
+
+unsigned int StaticProp::get_lod() {
+    return this->lod;
+}
+
+bool StaticProp::is_ready_for_batching() {
+    return this->geometry->get_resource_state() == se::util::LoadableResourceState::LOADED &&
+        this->texture_resource->get_resource_state() == se::util::LoadableResourceState::LOADED &&
+        (this->instanced_program == nullptr ||
+            this->instanced_program->get_resource_state() == se::util::LoadableResourceState::LOADED);
+}
+
+Geometry* StaticProp::get_geometry() {
+    return this->geometry;
+}
 
-}
\ No newline at end of file
+ImageTexture* StaticProp::get_texture() {
+    return this->texture;
+}
+
+TextureLayer* StaticProp::get_texture_layer() {
+    return this->texture_layer;
+}
+
+ShaderProgram* StaticProp::get_instanced_program() {
+    return this->instanced_program;
+}
@@ -0,0 +1,82 @@
+/*!
+ *  @file src/se/graphics/commandList.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/graphics/commandList.hpp"
+
+#include "se/entity.hpp"
+#include "se/graphics/geometry.hpp"
+#include "se/graphics/glState.hpp"
+#include "se/graphics/instancedRenderer.hpp"
+#include "se/graphics/renderSnapshot.hpp"
+#include "se/graphics/shader.hpp"
+#include "se/graphics/shaderProgram.hpp"
+#include "se/graphics/texture.hpp"
+#include "se/graphics/textureArray.hpp"
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+using namespace se::graphics;
+
+// ====================
+// == PUBLIC METHODS ==
+// ====================
+
+void CommandList::clear() {
+    this->commands.clear();
+}
+
+void CommandList::push(const DrawCommand& command) {
+    this->commands.push_back(command);
+}
+
+size_t CommandList::size() {
+    return this->commands.size();
+}
+
+void CommandList::replay(const RenderSnapshot& snapshot,
+    InstancedRenderer* instanced_renderer) {
+    for(const DrawCommand& command : this->commands) {
+        CommandList::execute(snapshot, command, instanced_renderer);
+    }
+    // Everything drawn after this expects depth writes
+    GLState::depth_mask(true);
+}
+
+void CommandList::execute(const RenderSnapshot& snapshot,
+    const DrawCommand& command, InstancedRenderer* instanced_renderer) {
+    const RenderSnapshotItem& item = snapshot.items[command.index];
+    switch(command.type) {
+        case DrawCommandType::SKIP:
+            break;
+        case DrawCommandType::RENDER:
+            item.entity->render(snapshot.camera_matrix, item.model_matrix);
+            break;
+        case DrawCommandType::INSTANCED:
+            if(instanced_renderer != nullptr) {
+                instanced_renderer->submit(command, item.model_matrix);
+                break;
+            }
+            // Drawn individually with the regular program
+            [[fallthrough]];
+        case DrawCommandType::DRAW:
+            command.program->use_program();
+            if(command.texture_layer != nullptr) {
+                command.texture_layer->use_layer(GL_TEXTURE0);
+            } else if(command.texture != nullptr) {
+                command.texture->use_texture(GL_TEXTURE0);
+            }
+            if(command.flags & DrawCommand::MODEL_MATRIX) {
+                glUniformMatrix4fv(SE_SHADER_LOC_IN_MODEL_MAT, 1, GL_FALSE,
+                    &item.model_matrix[0][0]);
+            }
+            GLState::depth_mask(!(command.flags & DrawCommand::NO_DEPTH_WRITE));
+            command.geometry->use_geometry(command.lod);
+            break;
+    }
+}
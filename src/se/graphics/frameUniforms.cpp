@@ -0,0 +1,33 @@
+/*!
+ *  @file src/se/graphics/frameUniforms.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/graphics/frameUniforms.hpp"
+
+#include "se/graphics/glState.hpp"
+#include "se/graphics/shader.hpp"
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+using namespace se::graphics;
+
+// ====================
+// == PUBLIC METHODS ==
+// ====================
+
+void FrameUniformBuffer::update(const FrameUniforms& uniforms) {
+    /* The buffer is not deleted with this object, because it may be
+    destroyed outside of the graphics thread.  It goes with the context. */
+    if(this->gl_buffer_id == 0) {
+        glGenBuffers(1, &this->gl_buffer_id);
+    }
+    GLState::bind_buffer(GL_UNIFORM_BUFFER, this->gl_buffer_id);
+    // Orphan the previous contents so the upload doesn't wait on the GPU
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), &uniforms, GL_STREAM_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, SE_SHADER_BINDING_FRAME, this->gl_buffer_id);
+}
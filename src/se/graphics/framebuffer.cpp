@@ -9,6 +9,7 @@
 #include "se/graphics/framebuffer.hpp"
 
 #include "se/engine.hpp"
+#include "se/graphics/glState.hpp"
 #include "se/graphics/graphicsController.hpp"
 #include "se/graphics/shader.hpp"
 #include "se/graphics/texture.hpp"
@@ -24,11 +25,14 @@ using namespace se::graphics;
 // =====================
 
 void Framebuffer::re_init() {
+    /* Resizing often changes several configuration values at once, each of
+    which triggers a re-initialization.  Coalescing means only the most recent
+    one is actually executed. */
     // TODO: Sanity check the values
-    this->engine->graphics_controller->submit_graphics_task([this](){
+    this->init_handle = this->engine->graphics_controller->submit_graphics_task([this](){
         this->deinit();
         this->init();
-    });
+    }, GraphicsTaskPriority::CRITICAL, graphics_task_key(this, 0));
 }
 
 void Framebuffer::init() {
@@ -43,7 +47,7 @@ void Framebuffer::init() {
 
     // Generate and bind framebuffer
     glGenFramebuffers(1, &this->gl_framebuffer_id);
-    glBindFramebuffer(GL_FRAMEBUFFER, this->gl_framebuffer_id);
+    GLState::bind_framebuffer(this->gl_framebuffer_id);
 
     std::vector<GLenum> color_attachments;
 
@@ -82,7 +86,7 @@ void Framebuffer::init() {
 void Framebuffer::deinit() {
     this->state = FramebufferState::DE_INITIALIZING;
 
-    glDeleteFramebuffers(1, &this->gl_framebuffer_id);
+    GLState::delete_framebuffers(1, &this->gl_framebuffer_id);
 
     for(auto texture : this->textures) {
         texture->unbind();
@@ -95,22 +99,34 @@ void Framebuffer::deinit() {
 // == PUBLIC MEMBERS ==
 // ====================
 
-Framebuffer::Framebuffer(se::Engine* engine, std::vector<Texture*> textures) {
+Framebuffer::Framebuffer(se::Engine* engine, std::vector<Texture*> textures,
+    std::vector<GraphicsTaskHandle> dependencies) {
     this->engine = engine;
     this->textures = textures;
 
-    this->engine->graphics_controller->submit_graphics_task([this](){
+    this->init_handle = this->engine->graphics_controller->submit_graphics_task([this](){
         this->init();
-    });
+    }, GraphicsTaskPriority::CRITICAL, graphics_task_key(this, 0), dependencies);
 }
 
 Framebuffer::~Framebuffer() {
     this->engine->graphics_controller->submit_graphics_task([this](){
         this->deinit();
-    });
+    }, GraphicsTaskPriority::CRITICAL);
     // TODO: Wait for de-init somehow
 }
 
 void Framebuffer::use_as_target() {
-    glBindFramebuffer(GL_FRAMEBUFFER, this->gl_framebuffer_id);
+    GLState::bind_framebuffer(this->gl_framebuffer_id);
+}
+
+FramebufferState Framebuffer::wait_for_init() {
+    if(this->init_handle != nullptr) {
+        this->init_handle->wait();
+    }
+    return this->state;
+}
+
+GraphicsTaskHandle Framebuffer::get_init_handle() {
+    return this->init_handle;
 }
\ No newline at end of file
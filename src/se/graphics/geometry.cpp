@@ -9,22 +9,37 @@
 #include "se/graphics/geometry.hpp"
 
 #include "se/engine.hpp"
+#include "se/graphics/glState.hpp"
 #include "se/graphics/shader.hpp"
 #include "se/graphics/graphicsController.hpp"
+#include "se/graphics/objParser.hpp"
 
+#include "se/util/config.hpp"
 #include "se/util/dirs.hpp"
 #include "se/util/hash.hpp"
 #include "se/util/log.hpp"
 #include "se/util/debugstrings.hpp"
-
+#include "se/util/mappedFile.hpp"
+#include "se/util/simplify.hpp"
+#include "se/util/threadPool.hpp"
+#include "se/util/vertexCache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <string.h>
 #include <string>
+#include <sys/stat.h>
+#include <unordered_map>
 #include <png.h>
 #include <SDL2/SDL.h>
 #include <GL/glew.h>
 #include <SDL2/SDL_opengl.h>
 #include <GL/glu.h>
 #include <GL/gl.h>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
@@ -37,45 +52,226 @@ using namespace se::util;
 
 #define GEOM_HASH_FORMAT "geometry:%p:%s"
 
+/// Mesh cache file magic number
+#define GEOM_CACHE_MAGIC "SEMESH\0\0"
+/// Mesh cache format version, increment whenever the layout changes
+#define GEOM_CACHE_VERSION 5
+/// Maximum number of levels of detail, including the full detail mesh
+#define GEOM_MAX_LODS 4
+/// Meshes with fewer triangles than this don't get levels of detail
+#define GEOM_LOD_MIN_TRIANGLES 64
+/// Levels which don't remove at least this fraction of triangles are dropped
+#define GEOM_LOD_MIN_REDUCTION 0.2
+/// Fraction of the error threshold a level must pass by before it changes
+#define GEOM_LOD_HYSTERESIS 0.25
+
+/// Used if `render.lod_error_pixels` is not configured
+static float default_lod_error_pixels = 1.0;
+
+uint64_t Geometry::stat_triangles_drawn = 0;
+uint64_t Geometry::stat_triangles_full = 0;
+
+/*!
+ *  Compact Vertex.
+ * 
+ *  Packed layout for `VertexFormat::COMPACT`.
+ */
+struct CompactVertex {
+    /// Vertex position
+    float position[3];
+    /// Texture coordinate (half precision)
+    uint16_t uv[2];
+    /// Vertex normal (`GL_INT_2_10_10_10_REV`)
+    uint32_t normal;
+};
+static_assert(sizeof(CompactVertex) == 20, "Unexpected compact vertex size");
+
+/*!
+ *  Quantized Vertex.
+ * 
+ *  Packed layout for `VertexFormat::QUANTIZED`.  The fourth position component
+ *  is padding, which keeps the following attributes four byte aligned.
+ */
+struct QuantizedVertex {
+    /// Vertex position (normalized within the bounding box)
+    uint16_t position[4];
+    /// Texture coordinate (half precision)
+    uint16_t uv[2];
+    /// Vertex normal (`GL_INT_2_10_10_10_REV`)
+    uint32_t normal;
+};
+static_assert(sizeof(QuantizedVertex) == 16, "Unexpected quantized vertex size");
+
+/*!
+ *  Convert a float to a half precision float.
+ * 
+ *  Values out of range are clamped to infinity, and values too small to be
+ *  represented as a normal half are flushed to zero.
+ */
+static uint16_t float_to_half(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = ((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+    if(((bits >> 23) & 0xff) == 0xff) {
+        // Infinity or NaN
+        return sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0);
+    } else if(exponent >= 0x1f) {
+        return sign | 0x7c00;
+    } else if(exponent <= 0) {
+        return sign;
+    }
+    // Round to nearest
+    uint32_t half = sign | (exponent << 10) | (mantissa >> 13);
+    if(mantissa & 0x1000) {
+        half++;
+    }
+    return half;
+}
+
+/// Pack a unit vector as a signed normalized `GL_INT_2_10_10_10_REV` value
+static uint32_t pack_normal(glm::vec3 normal) {
+    uint32_t packed = 0;
+    for(int i = 0; i < 3; i++) {
+        int32_t component = (int32_t) roundf(std::clamp(normal[i], -1.0f, 1.0f) * 511.0f);
+        packed |= ((uint32_t) component & 0x3ff) << (i * 10);
+    }
+    return packed;
+}
+
+/*!
+ *  Mesh Cache Header.
+ * 
+ *  Compiled meshes are stored in the cache as this header, followed by the
+ *  packed vertex array and the index array (padded to a multiple of four
+ *  bytes), exactly as they are uploaded to the GPU.
+ */
+struct MeshCacheHeader {
+    /// Magic number (`GEOM_CACHE_MAGIC`)
+    char magic[8];
+    /// Format version (`GEOM_CACHE_VERSION`)
+    uint32_t version;
+    /// Number of vertices
+    uint32_t vertex_count;
+    /// Number of indices
+    uint32_t index_count;
+    /// Size of each index in bytes
+    uint32_t index_size;
+    /// Modification time of the source file (nanoseconds)
+    int64_t source_mtime_ns;
+    /// Size of the source file
+    uint64_t source_size;
+    /// Vertex format
+    uint32_t vertex_format;
+    /// Size of each vertex in bytes
+    uint32_t vertex_size;
+    /// Position dequantization scale
+    float position_scale[3];
+    /// Position dequantization offset
+    float position_offset[3];
+    /// Bounding box minimum corner
+    float bounds_min[3];
+    /// Bounding box maximum corner
+    float bounds_max[3];
+    /// Bounding sphere center
+    float bounds_center[3];
+    /// Bounding sphere radius
+    float bounds_radius;
+    /// Number of levels of detail
+    uint32_t lod_count;
+    /// First index of each level of detail
+    uint32_t lod_index_offset[GEOM_MAX_LODS];
+    /// Number of indices in each level of detail
+    uint32_t lod_index_count[GEOM_MAX_LODS];
+    /// Geometric error of each level of detail
+    float lod_error[GEOM_MAX_LODS];
+};
+
+const char* se::graphics::vertex_format_name(VertexFormat format) {
+    switch(format) {
+        case VertexFormat::FLOAT: return "float";
+        case VertexFormat::COMPACT: return "compact";
+        case VertexFormat::QUANTIZED: return "quantized";
+        default: return "unknown";
+    }
+}
+
 Geometry::Geometry(se::Engine* engine, const char* name) {
     this->engine = engine;
     this->name = strdup(name); 
+    this->lod_error_pixels = engine->config->get_floatp("render.lod_error_pixels",
+        &default_lod_error_pixels);
     this->cache_resource(this);
 }
 
 Geometry::~Geometry() {
     free((void*)this->name);
+    delete this->mesh_cache;
 }
 
 void Geometry::bind() {
 
+    // Upload from the cache mapping if there is one, otherwise the parsed data
+    const void* vertices = this->packed_vertex_data.data();
+    const void* indices = this->index_data.data();
+    if(this->mesh_cache != nullptr) {
+        const char* base = (const char*) this->mesh_cache->get_data();
+        vertices = base + sizeof(MeshCacheHeader);
+        indices = (const char*) vertices + this->vertex_count * this->vertex_size;
+    }
+
     glGenVertexArrays(1, &this->gl_vertex_array_object_id);
-    glBindVertexArray(this->gl_vertex_array_object_id);
+    GLState::bind_vertex_array(this->gl_vertex_array_object_id);
 
     glGenBuffers(1, &this->gl_vertex_buffer_id);
-    glBindBuffer(GL_ARRAY_BUFFER, this->gl_vertex_buffer_id);
-    glBufferData(GL_ARRAY_BUFFER, this->vertex_data.size() * sizeof(glm::vec3),
-        &this->vertex_data[0], GL_STATIC_DRAW);
-    glVertexAttribPointer(SE_SHADER_LOC_IN_VERT, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    GLState::bind_buffer(GL_ARRAY_BUFFER, this->gl_vertex_buffer_id);
+    glBufferData(GL_ARRAY_BUFFER, this->vertex_count * this->vertex_size,
+        vertices, GL_STATIC_DRAW);
+    switch(this->vertex_format) {
+        case VertexFormat::FLOAT:
+            glVertexAttribPointer(SE_SHADER_LOC_IN_VERT, 3, GL_FLOAT, GL_FALSE,
+                sizeof(GeometryVertex), (void*) offsetof(GeometryVertex, position));
+            glVertexAttribPointer(SE_SHADER_LOC_IN_UV, 2, GL_FLOAT, GL_FALSE,
+                sizeof(GeometryVertex), (void*) offsetof(GeometryVertex, uv));
+            glVertexAttribPointer(SE_SHADER_LOC_IN_NORM, 3, GL_FLOAT, GL_FALSE,
+                sizeof(GeometryVertex), (void*) offsetof(GeometryVertex, normal));
+            break;
+        case VertexFormat::COMPACT:
+            glVertexAttribPointer(SE_SHADER_LOC_IN_VERT, 3, GL_FLOAT, GL_FALSE,
+                sizeof(CompactVertex), (void*) offsetof(CompactVertex, position));
+            glVertexAttribPointer(SE_SHADER_LOC_IN_UV, 2, GL_HALF_FLOAT, GL_FALSE,
+                sizeof(CompactVertex), (void*) offsetof(CompactVertex, uv));
+            glVertexAttribPointer(SE_SHADER_LOC_IN_NORM, 4, GL_INT_2_10_10_10_REV, GL_TRUE,
+                sizeof(CompactVertex), (void*) offsetof(CompactVertex, normal));
+            break;
+        case VertexFormat::QUANTIZED:
+            glVertexAttribPointer(SE_SHADER_LOC_IN_VERT, 3, GL_UNSIGNED_SHORT, GL_TRUE,
+                sizeof(QuantizedVertex), (void*) offsetof(QuantizedVertex, position));
+            glVertexAttribPointer(SE_SHADER_LOC_IN_UV, 2, GL_HALF_FLOAT, GL_FALSE,
+                sizeof(QuantizedVertex), (void*) offsetof(QuantizedVertex, uv));
+            glVertexAttribPointer(SE_SHADER_LOC_IN_NORM, 4, GL_INT_2_10_10_10_REV, GL_TRUE,
+                sizeof(QuantizedVertex), (void*) offsetof(QuantizedVertex, normal));
+            break;
+    }
     glEnableVertexAttribArray(SE_SHADER_LOC_IN_VERT);
-
-    glGenBuffers(1, &this->gl_uv_buffer_id);
-    glBindBuffer(GL_ARRAY_BUFFER, this->gl_uv_buffer_id);
-    glBufferData(GL_ARRAY_BUFFER, this->uv_data.size() * sizeof(glm::vec2),
-        &this->uv_data[0], GL_STATIC_DRAW);
-    glVertexAttribPointer(SE_SHADER_LOC_IN_UV, 2, GL_FLOAT, GL_FALSE, 0, 0);
     glEnableVertexAttribArray(SE_SHADER_LOC_IN_UV);
-
-    glGenBuffers(1, &this->gl_normal_buffer_id);
-    glBindBuffer(GL_ARRAY_BUFFER, this->gl_normal_buffer_id);
-    glBufferData(GL_ARRAY_BUFFER, this->normal_data.size() * sizeof(glm::vec3),
-        &this->normal_data[0], GL_STATIC_DRAW);
-    glVertexAttribPointer(SE_SHADER_LOC_IN_NORM, 3, GL_FLOAT, GL_FALSE, 0, 0);
     glEnableVertexAttribArray(SE_SHADER_LOC_IN_NORM);
 
-    this->vertex_data.clear();
-    this->uv_data.clear();
-    this->normal_data.clear();
+    // The element buffer binding is part of the vertex array object state
+    glGenBuffers(1, &this->gl_index_buffer_id);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->gl_index_buffer_id);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->index_count * this->index_size,
+        indices, GL_STATIC_DRAW);
+
+    GLState::bind_vertex_array(0);
+
+    this->packed_vertex_data.clear();
+    this->packed_vertex_data.shrink_to_fit();
+    this->index_data.clear();
+    this->index_data.shrink_to_fit();
+    delete this->mesh_cache;
+    this->mesh_cache = nullptr;
 
     DEBUG("Geometry [%s] bound successfuly as [%u]!", this->name,
         this->gl_vertex_array_object_id);
@@ -85,133 +281,505 @@ void Geometry::bind() {
 
 void Geometry::unbind() {
     
-    glDeleteBuffers(1, &this->gl_vertex_buffer_id);
-    glDeleteBuffers(1, &this->gl_uv_buffer_id);
-    glDeleteBuffers(1, &this->gl_normal_buffer_id);
+    GLState::delete_vertex_arrays(1, &this->gl_vertex_array_object_id);
+    GLState::delete_buffers(1, &this->gl_vertex_buffer_id);
+    GLState::delete_buffers(1, &this->gl_index_buffer_id);
 
+    this->gl_instance_buffer_id = 0;
+    this->gl_vertex_array_object_id = 0;
     this->gl_vertex_buffer_id = 0;
-    this->gl_uv_buffer_id = 0;
-    this->gl_normal_buffer_id = 0;
+    this->gl_index_buffer_id = 0;
 
     DEBUG("Geometry [%s] unbound", this->name);
 }
 
-// =======================
-// == PROTECTED METHODS ==
-// =======================
-
-void Geometry::load_() {
-    DEBUG("Loading geometry [%s]", this->name);
-    this->resource_state = LoadableResourceState::LOADING;
-
-    /* This OBJ loader was adapted from the awesome folks at
-    http://www.opengl-tutorial.org/ */
-    std::vector<unsigned int> vertex_indices;
-    std::vector<unsigned int> uv_indices;
-    std::vector<unsigned int> normal_indices;
-    std::vector<glm::vec3> temp_vertices;
-    std::vector<glm::vec2> temp_uvs;
-    std::vector<glm::vec3> temp_normals;
-
+bool Geometry::decode() {
     std::string fname = se::util::dirs::app_data();
     fname += "/models/";
     fname += name;
     fname += ".obj";
 
-    FILE* fp = fopen(fname.c_str(), "r");
-    if(fp == nullptr) {
-        ERROR("[%s] Failed to open model file [%s] [%i: %s]",
+    // The source file's metadata is used to validate the cached copy
+    struct stat source_stat;
+    if(stat(fname.c_str(), &source_stat) != 0) {
+        ERROR("[%s] Failed to stat model file [%s] [%i: %s]",
             this->name, fname.c_str(), errno, strerror(errno));
-        this->resource_state = LoadableResourceState::ERROR;
-        return;
+        return false;
+    }
+    int64_t source_mtime_ns = source_stat.st_mtim.tv_sec * 1000000000ll +
+        source_stat.st_mtim.tv_nsec;
+    uint64_t source_size = source_stat.st_size;
+
+    char cache_name[16];
+    snprintf(cache_name, sizeof(cache_name), "%08x",
+        se::util::hash::jenkins(fname.c_str(), fname.size()));
+    std::string cache_fname = se::util::dirs::cache_data();
+    cache_fname += "/models/";
+    cache_fname += cache_name;
+    cache_fname += ".mesh";
+
+    std::string format_name = this->engine->config->get_string("render.vertex_format", "compact");
+    this->vertex_format = VertexFormat::COMPACT;
+    if(format_name == "float") {
+        this->vertex_format = VertexFormat::FLOAT;
+    } else if(format_name == "quantized") {
+        this->vertex_format = VertexFormat::QUANTIZED;
+    } else if(format_name != "compact") {
+        WARN("[%s] Unknown vertex format [%s], using compact", this->name,
+            format_name.c_str());
     }
 
-    // It is time to read the OBJ file
+    if(this->read_cache(cache_fname, source_mtime_ns, source_size)) {
+        DEBUG("Loaded [%s] from mesh cache, waiting for bind", this->name);
+        return true;
+    }
+    if(!this->parse_obj(fname)) {
+        return false;
+    }
+    this->compute_bounds();
+    this->pack_vertices(this->vertex_format);
+    this->write_cache(cache_fname, source_mtime_ns, source_size);
 
-    while(true) {
+    DEBUG("Loaded [%s], waiting for bind", this->name);
+    return true;
+}
 
-        char line_header[128];
-        int res = fscanf(fp, "%127s", line_header);
-        if(res == EOF) {
-            break;
+bool Geometry::read_cache(std::string cache_fname, int64_t source_mtime_ns,
+    uint64_t source_size) {
+    delete this->mesh_cache;
+    this->mesh_cache = new se::util::MappedFile(cache_fname);
+    bool valid = false;
+    if(this->mesh_cache->is_valid() &&
+        this->mesh_cache->get_size() >= sizeof(MeshCacheHeader)) {
+        const MeshCacheHeader* header = (const MeshCacheHeader*) this->mesh_cache->get_data();
+        size_t index_bytes = (size_t) header->index_count * header->index_size;
+        size_t expected_size = sizeof(MeshCacheHeader) +
+            (size_t) header->vertex_count * header->vertex_size +
+            ((index_bytes + 3) & ~((size_t) 3));
+        valid = memcmp(header->magic, GEOM_CACHE_MAGIC, 8) == 0 &&
+            header->version == GEOM_CACHE_VERSION &&
+            header->source_mtime_ns == source_mtime_ns &&
+            header->source_size == source_size &&
+            header->vertex_format == (uint32_t) this->vertex_format &&
+            (header->index_size == 2 || header->index_size == 4) &&
+            header->lod_count >= 1 && header->lod_count <= GEOM_MAX_LODS &&
+            this->mesh_cache->get_size() == expected_size;
+        for(uint32_t i = 0; valid && i < header->lod_count; i++) {
+            valid = (uint64_t) header->lod_index_offset[i] + header->lod_index_count[i] <=
+                header->index_count;
         }
-
-        if(strcmp(line_header, "v") == 0) {
-            // This line defines a vertex
-            glm::vec3 vertex;
-            fscanf(fp, "%f %f %f\n", &vertex.x, &vertex.y, &vertex.z);
-            temp_vertices.push_back(vertex);
-        } else if(strcmp(line_header, "vt") == 0) {
-            // This line defines a uv coordinate
-            glm::vec2 uv;
-            fscanf(fp, "%f %f\n", &uv.x, &uv.y);
-            temp_uvs.push_back(uv);
-        } else if(strcmp(line_header, "vn") == 0) {
-            // This line defines a normal
-            glm::vec3 normal;
-            fscanf(fp, "%f %f %f\n", &normal.x, &normal.y, &normal.z);
-            temp_normals.push_back(normal);
-        } else if(strcmp(line_header, "f") == 0) {
-            // This line defines a face
-            unsigned int vertex_index[3];
-            unsigned int uv_index[3];
-            unsigned int normal_index[3];
-            int matches = fscanf(fp, "%d/%d/%d %d/%d/%d %d/%d/%d\n",
-                &vertex_index[0], &uv_index[0], &normal_index[0],
-                &vertex_index[1], &uv_index[1], &normal_index[1],
-                &vertex_index[2], &uv_index[2], &normal_index[2]);
-            if(matches != 9) {
-                ERROR("[%s] OBJ format unsupported [%s]",
-                    this->name, fname.c_str());
-                this->resource_state = LoadableResourceState::ERROR;
-                return;
+        if(valid) {
+            this->vertex_count = header->vertex_count;
+            this->index_count = header->index_count;
+            this->index_size = header->index_size;
+            this->vertex_size = header->vertex_size;
+            this->position_scale = glm::vec3(header->position_scale[0],
+                header->position_scale[1], header->position_scale[2]);
+            this->position_offset = glm::vec3(header->position_offset[0],
+                header->position_offset[1], header->position_offset[2]);
+            for(int i = 0; i < 3; i++) {
+                this->bounds.min[i] = header->bounds_min[i];
+                this->bounds.max[i] = header->bounds_max[i];
+                this->bounds.center[i] = header->bounds_center[i];
+            }
+            this->bounds.radius = header->bounds_radius;
+            this->lods.resize(header->lod_count);
+            for(uint32_t i = 0; i < header->lod_count; i++) {
+                this->lods[i].index_offset = header->lod_index_offset[i];
+                this->lods[i].index_count = header->lod_index_count[i];
+                this->lods[i].error = header->lod_error[i];
             }
-            vertex_indices.push_back(vertex_index[0]);
-            vertex_indices.push_back(vertex_index[1]);
-            vertex_indices.push_back(vertex_index[2]);
-            uv_indices    .push_back(uv_index[0]);
-            uv_indices    .push_back(uv_index[1]);
-            uv_indices    .push_back(uv_index[2]);
-            normal_indices.push_back(normal_index[0]);
-            normal_indices.push_back(normal_index[1]);
-            normal_indices.push_back(normal_index[2]);
+        } else {
+            DEBUG("[%s] Mesh cache is stale", this->name);
         }
+    }
+    if(!valid) {
+        delete this->mesh_cache;
+        this->mesh_cache = nullptr;
+    }
+    return valid;
+}
 
+void Geometry::write_cache(std::string cache_fname, int64_t source_mtime_ns,
+    uint64_t source_size) {
+    if(!se::util::dirs::create_directories(se::util::dirs::cache_data() + "/models")) {
+        return;
     }
+    /* Write to a temporary file and move it into place once it's complete, so
+    a partially written cache file can never be mapped. */
+    std::string temp_fname = cache_fname + ".tmp";
+    FILE* fp = fopen(temp_fname.c_str(), "wb");
+    if(fp == nullptr) {
+        WARN("[%s] Failed to open mesh cache file [%s] [%i: %s]",
+            this->name, temp_fname.c_str(), errno, strerror(errno));
+        return;
+    }
+    MeshCacheHeader header;
+    memcpy(header.magic, GEOM_CACHE_MAGIC, 8);
+    header.version = GEOM_CACHE_VERSION;
+    header.vertex_count = this->vertex_count;
+    header.index_count = this->index_count;
+    header.index_size = this->index_size;
+    header.source_mtime_ns = source_mtime_ns;
+    header.source_size = source_size;
+    header.vertex_format = (uint32_t) this->vertex_format;
+    header.vertex_size = this->vertex_size;
+    for(int i = 0; i < 3; i++) {
+        header.position_scale[i] = this->position_scale[i];
+        header.position_offset[i] = this->position_offset[i];
+        header.bounds_min[i] = this->bounds.min[i];
+        header.bounds_max[i] = this->bounds.max[i];
+        header.bounds_center[i] = this->bounds.center[i];
+    }
+    header.bounds_radius = this->bounds.radius;
+    header.lod_count = this->lods.size();
+    for(int i = 0; i < GEOM_MAX_LODS; i++) {
+        GeometryLOD lod;
+        if(i < (int) this->lods.size()) {
+            lod = this->lods[i];
+        }
+        header.lod_index_offset[i] = lod.index_offset;
+        header.lod_index_count[i] = lod.index_count;
+        header.lod_error[i] = lod.error;
+    }
+    size_t index_bytes = this->index_data.size();
+    const uint8_t padding[4] = {0, 0, 0, 0};
+    bool success =
+        fwrite(&header, sizeof(header), 1, fp) == 1 &&
+        fwrite(this->packed_vertex_data.data(), 1, this->packed_vertex_data.size(), fp) == this->packed_vertex_data.size() &&
+        fwrite(this->index_data.data(), 1, index_bytes, fp) == index_bytes &&
+        fwrite(padding, 1, (4 - index_bytes % 4) % 4, fp) == (4 - index_bytes % 4) % 4;
+    success = (fclose(fp) == 0) && success;
+    if(!success || rename(temp_fname.c_str(), cache_fname.c_str()) != 0) {
+        WARN("[%s] Failed to write mesh cache file [%s]", this->name, cache_fname.c_str());
+        remove(temp_fname.c_str());
+        return;
+    }
+    DEBUG("[%s] Wrote mesh cache [%s]", this->name, cache_fname.c_str());
+}
 
-    this->vertex_data.clear();
-    this->uv_data.clear();
-    this->normal_data.clear();
+bool Geometry::parse_obj(std::string fname) {
+    se::util::MappedFile file(fname);
+    if(!file.is_valid()) {
+        ERROR("[%s] Failed to read model file [%s]", this->name, fname.c_str());
+        return false;
+    }
 
-    // It is time to parse the OBJ data
-    for(unsigned int i = 0; i < vertex_indices.size(); i++) {
-        unsigned int vertex_index = vertex_indices[i];
-        glm::vec3 vertex = temp_vertices[vertex_index - 1];
+    auto bm_start_time = std::chrono::steady_clock::now();
+    obj::Model model;
+    if(!obj::parse((const char*) file.get_data(), file.get_size(), model,
+        this->engine->worker_pool, this->name)) {
+        return false;
+    }
+    uint64_t bm_parse_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - bm_start_time).count();
+
+    /* Face corners are deduplicated.  Each unique combination of position,
+    uv, and normal indices becomes one vertex. */
+    struct CornerHash {
+        size_t operator()(const obj::Corner& corner) const {
+            return (corner.position * 73856093u) ^ (corner.uv * 19349663u) ^
+                (corner.normal * 83492791u);
+        }
+    };
+    struct CornerEqual {
+        bool operator()(const obj::Corner& a, const obj::Corner& b) const {
+            return a.position == b.position && a.uv == b.uv && a.normal == b.normal;
+        }
+    };
+    std::unordered_map<obj::Corner, uint32_t, CornerHash, CornerEqual> corner_map;
+    corner_map.reserve(model.positions.size() * 2);
+    std::vector<obj::Corner> corners;
+    std::vector<uint32_t> indices;
+    indices.reserve(model.corners.size());
+    bool missing_normals = false;
+    for(auto& corner : model.corners) {
+        if(corner.position == 0 || corner.position > model.positions.size() ||
+            corner.uv > model.uvs.size() || corner.normal > model.normals.size()) {
+            ERROR("[%s] OBJ index out of range [%s]", this->name, fname.c_str());
+            return false;
+        }
+        missing_normals |= corner.normal == 0;
+        auto inserted = corner_map.emplace(corner, corners.size());
+        if(inserted.second) {
+            corners.push_back(corner);
+        }
+        indices.push_back(inserted.first->second);
+    }
+
+    /* Corners without a normal get a smooth normal, the area weighted average
+    of the faces sharing their position. */
+    std::vector<glm::vec3> smooth_normals;
+    if(missing_normals) {
+        smooth_normals.resize(model.positions.size(), glm::vec3(0.0, 0.0, 0.0));
+        for(size_t i = 0; i + 2 < model.corners.size(); i += 3) {
+            glm::vec3 a = model.positions[model.corners[i].position - 1];
+            glm::vec3 b = model.positions[model.corners[i + 1].position - 1];
+            glm::vec3 c = model.positions[model.corners[i + 2].position - 1];
+            glm::vec3 face_normal = glm::cross(b - a, c - a);
+            for(size_t j = i; j < i + 3; j++) {
+                smooth_normals[model.corners[j].position - 1] += face_normal;
+            }
+        }
+    }
+
+    this->vertex_data.clear();
+    this->vertex_data.reserve(corners.size());
+    for(auto& corner : corners) {
+        GeometryVertex vertex;
+        vertex.position = model.positions[corner.position - 1];
+        vertex.uv = corner.uv != 0 ? model.uvs[corner.uv - 1] : glm::vec2(0.0, 0.0);
+        if(corner.normal != 0) {
+            vertex.normal = model.normals[corner.normal - 1];
+        } else {
+            glm::vec3 normal = smooth_normals[corner.position - 1];
+            float length = glm::length(normal);
+            vertex.normal = length > 0.0 ? normal / length : glm::vec3(0.0, 0.0, 1.0);
+        }
         this->vertex_data.push_back(vertex);
     }
-    for(unsigned int i = 0; i < uv_indices.size(); i++) {
-        unsigned int uv_index = uv_indices[i];
-        glm::vec2 uv = temp_uvs[uv_index - 1];
-        this->uv_data.push_back(uv);
+
+    uint64_t bm_total_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - bm_start_time).count();
+    double bm_parse_time_ms = bm_parse_time_ns / 1000000.0;
+    double bm_parse_rate = bm_parse_time_ns > 0 ?
+        (file.get_size() / 1048576.0) / (bm_parse_time_ns / 1000000000.0) : 0.0;
+    INFO("[%s] Parsed %lu bytes in %.3fms (%.1fMiB/s), %.3fms including deduplication",
+        this->name, file.get_size(), bm_parse_time_ms, bm_parse_rate,
+        bm_total_time_ns / 1000000.0);
+
+    this->optimize(indices);
+    return true;
+}
+
+void Geometry::optimize(std::vector<uint32_t>& indices) {
+    size_t vertex_count = this->vertex_data.size();
+    size_t before_transforms = se::util::vertex_cache::count_transforms(
+        indices.data(), indices.size(), vertex_count);
+    se::util::vertex_cache::optimize(indices.data(), indices.size(), vertex_count);
+    size_t after_transforms = se::util::vertex_cache::count_transforms(
+        indices.data(), indices.size(), vertex_count);
+
+    // Reorder the vertices in the order they're first referenced
+    std::vector<uint32_t> remap(vertex_count, UINT32_MAX);
+    std::vector<GeometryVertex> ordered_vertices;
+    ordered_vertices.reserve(vertex_count);
+    for(auto& index : indices) {
+        if(remap[index] == UINT32_MAX) {
+            remap[index] = ordered_vertices.size();
+            ordered_vertices.push_back(this->vertex_data[index]);
+        }
+        index = remap[index];
+    }
+    this->vertex_data.swap(ordered_vertices);
+
+    size_t full_index_count = indices.size();
+    this->generate_lods(indices);
+
+    // Pack the indices
+    this->vertex_count = this->vertex_data.size();
+    this->index_count = indices.size();
+    this->index_size = this->vertex_count <= UINT16_MAX + 1 ? 2 : 4;
+    this->index_data.resize(this->index_count * this->index_size);
+    if(this->index_size == 2) {
+        uint16_t* packed = (uint16_t*) this->index_data.data();
+        for(size_t i = 0; i < indices.size(); i++) {
+            packed[i] = indices[i];
+        }
+    } else {
+        memcpy(this->index_data.data(), indices.data(), this->index_data.size());
     }
-    for(unsigned int i = 0; i < normal_indices.size(); i++) {
-        unsigned int normal_index = normal_indices[i];
-        glm::vec3 normal = temp_normals[normal_index - 1];
-        this->normal_data.push_back(normal);
+
+    // Report the savings compared to the old unindexed layout
+    size_t unindexed_bytes = full_index_count * sizeof(GeometryVertex);
+    size_t indexed_bytes = this->vertex_count * sizeof(GeometryVertex) +
+        full_index_count * this->index_size;
+    INFO("[%s] %lu triangles, %lu -> %u vertices, %lu -> %lu bytes (%.1f%%)",
+        this->name, full_index_count / 3, full_index_count, this->vertex_count,
+        unindexed_bytes, indexed_bytes,
+        unindexed_bytes > 0 ? 100.0 * indexed_bytes / unindexed_bytes : 0.0);
+    INFO("[%s] Vertex shader invocations %lu -> %lu (optimized from %lu, ACMR %.3f)",
+        this->name, full_index_count, after_transforms, before_transforms,
+        full_index_count > 0 ? 3.0 * after_transforms / full_index_count : 0.0);
+}
+
+void Geometry::generate_lods(std::vector<uint32_t>& indices) {
+    GeometryLOD full;
+    full.index_count = indices.size();
+    this->lods.clear();
+    this->lods.push_back(full);
+    if(full.index_count / 3 < GEOM_LOD_MIN_TRIANGLES) {
+        return;
     }
 
-    this->vertex_array_size = this->vertex_data.size();
+    auto start_time = std::chrono::steady_clock::now();
+    size_t vertex_count = this->vertex_data.size();
+    std::vector<glm::vec3> positions;
+    positions.reserve(vertex_count);
+    for(auto& vertex : this->vertex_data) {
+        positions.push_back(vertex.position);
+    }
+    std::vector<uint32_t> lod_indices;
+    for(int level = 1; level < GEOM_MAX_LODS; level++) {
+        // Always simplify the full mesh, so errors are relative to it
+        size_t target = (full.index_count >> level) / 3 * 3;
+        float error = se::util::simplify::simplify(indices.data(), full.index_count,
+            positions.data(), vertex_count, target, lod_indices);
+        const GeometryLOD& previous = this->lods.back();
+        if(lod_indices.size() == 0 ||
+            lod_indices.size() > previous.index_count * (1.0 - GEOM_LOD_MIN_REDUCTION)) {
+            break;
+        }
+        se::util::vertex_cache::optimize(lod_indices.data(), lod_indices.size(), vertex_count);
+        GeometryLOD lod;
+        lod.index_offset = indices.size();
+        lod.index_count = lod_indices.size();
+        lod.error = std::max(error, previous.error);
+        indices.insert(indices.end(), lod_indices.begin(), lod_indices.end());
+        this->lods.push_back(lod);
+        INFO("[%s] LOD %d: %u triangles, error %.5f", this->name, level,
+            lod.index_count / 3, lod.error);
+    }
+    DEBUG("[%s] Generated %lu levels of detail in %.3fms", this->name,
+        this->lods.size(), std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_time).count() / 1000000.0);
+}
 
-    DEBUG("Loaded [%s], waiting for bind", this->name);
-    std::function job = [this](){this->bind();};
-    this->engine->graphics_controller->submit_graphics_task(job);
+void Geometry::compute_bounds() {
+    GeometryBounds bounds;
+    if(this->vertex_data.size() > 0) {
+        bounds.min = bounds.max = this->vertex_data[0].position;
+    }
+    for(auto& vertex : this->vertex_data) {
+        bounds.min = glm::min(bounds.min, vertex.position);
+        bounds.max = glm::max(bounds.max, vertex.position);
+    }
+    bounds.center = (bounds.min + bounds.max) * 0.5f;
+    float radius_squared = 0.0;
+    for(auto& vertex : this->vertex_data) {
+        glm::vec3 delta = vertex.position - bounds.center;
+        radius_squared = std::max(radius_squared, glm::dot(delta, delta));
+    }
+    bounds.radius = sqrtf(radius_squared);
+    this->bounds = bounds;
+}
+
+void Geometry::pack_vertices(VertexFormat format) {
+    this->vertex_format = format;
+    this->position_scale = glm::vec3(1.0, 1.0, 1.0);
+    this->position_offset = glm::vec3(0.0, 0.0, 0.0);
+    size_t count = this->vertex_data.size();
+
+    if(format == VertexFormat::FLOAT) {
+        this->vertex_size = sizeof(GeometryVertex);
+        this->packed_vertex_data.resize(count * this->vertex_size);
+        memcpy(this->packed_vertex_data.data(), this->vertex_data.data(),
+            this->packed_vertex_data.size());
+    } else if(format == VertexFormat::COMPACT) {
+        this->vertex_size = sizeof(CompactVertex);
+        this->packed_vertex_data.resize(count * this->vertex_size);
+        CompactVertex* packed = (CompactVertex*) this->packed_vertex_data.data();
+        for(size_t i = 0; i < count; i++) {
+            const GeometryVertex& vertex = this->vertex_data[i];
+            for(int j = 0; j < 3; j++) {
+                packed[i].position[j] = vertex.position[j];
+            }
+            packed[i].uv[0] = float_to_half(vertex.uv.x);
+            packed[i].uv[1] = float_to_half(vertex.uv.y);
+            packed[i].normal = pack_normal(vertex.normal);
+        }
+    } else {
+        /* Positions are stored relative to the bounding box, and the vertex
+        shader maps them back using the scale and offset uniforms. */
+        glm::vec3 min_pos(0.0, 0.0, 0.0);
+        glm::vec3 max_pos(0.0, 0.0, 0.0);
+        if(count > 0) {
+            min_pos = max_pos = this->vertex_data[0].position;
+        }
+        for(auto& vertex : this->vertex_data) {
+            for(int j = 0; j < 3; j++) {
+                min_pos[j] = std::min(min_pos[j], vertex.position[j]);
+                max_pos[j] = std::max(max_pos[j], vertex.position[j]);
+            }
+        }
+        this->position_offset = min_pos;
+        this->position_scale = max_pos - min_pos;
+        this->vertex_size = sizeof(QuantizedVertex);
+        this->packed_vertex_data.resize(count * this->vertex_size);
+        QuantizedVertex* packed = (QuantizedVertex*) this->packed_vertex_data.data();
+        for(size_t i = 0; i < count; i++) {
+            const GeometryVertex& vertex = this->vertex_data[i];
+            for(int j = 0; j < 3; j++) {
+                float range = this->position_scale[j];
+                float normalized = range > 0.0 ? (vertex.position[j] - min_pos[j]) / range : 0.0;
+                packed[i].position[j] = (uint16_t) roundf(std::clamp(normalized, 0.0f, 1.0f) * 65535.0f);
+            }
+            packed[i].position[3] = 0;
+            packed[i].uv[0] = float_to_half(vertex.uv.x);
+            packed[i].uv[1] = float_to_half(vertex.uv.y);
+            packed[i].normal = pack_normal(vertex.normal);
+        }
+    }
+
+    this->vertex_data.clear();
+    this->vertex_data.shrink_to_fit();
+
+    INFO("[%s] Vertex format [%s], %u bytes per vertex, %lu bytes of vertex data (%lu with indices)",
+        this->name, vertex_format_name(format), this->vertex_size,
+        this->packed_vertex_data.size(),
+        this->packed_vertex_data.size() + this->index_data.size());
+}
+
+// =======================
+// == PROTECTED METHODS ==
+// =======================
+
+void Geometry::load_() {
+    DEBUG("Loading geometry [%s]", this->name);
+    uint32_t generation;
+    {
+        std::lock_guard<std::mutex> lock(this->state_mutex);
+        generation = ++this->load_generation;
+        this->resource_state = LoadableResourceState::LOADING;
+    }
+
+    // Parse on the worker pool, then bind (see `ImageTexture::load_()`)
+    GraphicsTaskHandle decoded = std::make_shared<GraphicsTaskCompletion>(
+        this->engine->graphics_controller);
+    std::function job = [this, generation](){
+        if(this->load_generation != generation) { return; }
+        std::lock_guard<std::mutex> lock(this->state_mutex);
+        if(this->load_generation != generation ||
+            this->resource_state != LoadableResourceState::LOADING) { return; }
+        this->bind();
+    };
+    this->bind_handle = this->engine->graphics_controller->submit_graphics_task(
+        job, GraphicsTaskPriority::BACKGROUND, 0, {decoded});
+    this->engine->worker_pool->submit([this, decoded, generation](){
+        {
+            std::lock_guard<std::mutex> decode_lock(this->decode_mutex);
+            if(this->load_generation == generation && !this->decode()) {
+                std::lock_guard<std::mutex> lock(this->state_mutex);
+                if(this->load_generation == generation) {
+                    this->resource_state = LoadableResourceState::ERROR;
+                }
+            }
+        }
+        decoded->mark_complete();
+    });
 }
 
 void Geometry::unload_() {
     DEBUG("Unloading [%s], waiting for unbind", this->name);
-    this->resource_state = LoadableResourceState::NOT_LOADED;
+    {
+        // A decode in progress is left to finish, and then dropped
+        std::lock_guard<std::mutex> lock(this->state_mutex);
+        this->load_generation++;
+        this->resource_state = LoadableResourceState::NOT_LOADED;
+    }
     std::function job = [this](){this->unbind();};
-    this->engine->graphics_controller->submit_graphics_task(job);
+    this->engine->graphics_controller->submit_graphics_task(job,
+        GraphicsTaskPriority::BACKGROUND, 0, {this->bind_handle});
 }
 
 uint32_t Geometry::resource_id() {
@@ -240,8 +808,109 @@ Geometry* Geometry::get_geometry(se::Engine* engine, const char* name) {
     return static_cast<Geometry*>(resource);
 }
 
-void Geometry::use_geometry() {
+LoadableResourceState Geometry::wait_for_loading() {
+    if(this->bind_handle != nullptr) {
+        this->bind_handle->wait();
+    }
+    return this->resource_state;
+}
+
+GraphicsTaskHandle Geometry::get_bind_handle() {
+    return this->bind_handle;
+}
+
+VertexFormat Geometry::get_vertex_format() {
+    return this->vertex_format;
+}
+
+unsigned int Geometry::get_vertex_size() {
+    return this->vertex_size;
+}
+
+GeometryBounds Geometry::get_bounds() {
+    return this->bounds;
+}
+
+unsigned int Geometry::get_lod_count() {
+    return this->lods.size();
+}
+
+unsigned int Geometry::select_lod(float pixels_per_unit, unsigned int current) {
+    if(this->resource_state != LoadableResourceState::LOADED) { return 0; }
+    unsigned int count = this->lods.size();
+    float threshold = *this->lod_error_pixels;
+    if(count <= 1 || threshold <= 0.0) {
+        return 0;
+    }
+    if(current >= count) {
+        current = count - 1;
+    }
+    float upper = threshold * (1.0 + GEOM_LOD_HYSTERESIS);
+    float lower = threshold * (1.0 - GEOM_LOD_HYSTERESIS);
+    while(current > 0 && this->lods[current].error * pixels_per_unit > upper) {
+        current--;
+    }
+    while(current + 1 < count && this->lods[current + 1].error * pixels_per_unit < lower) {
+        current++;
+    }
+    return current;
+}
+
+void Geometry::get_triangle_stats(uint64_t& drawn, uint64_t& full) {
+    drawn = stat_triangles_drawn;
+    full = stat_triangles_full;
+}
+
+void Geometry::use_geometry(unsigned int lod) {
+    if(this->resource_state != LoadableResourceState::LOADED) { return; }
+    if(lod >= this->lods.size()) {
+        lod = this->lods.size() - 1;
+    }
+    const GeometryLOD& range = this->lods[lod];
+    glUniform3fv(SE_SHADER_LOC_IN_POS_SCALE, 1, &this->position_scale[0]);
+    glUniform3fv(SE_SHADER_LOC_IN_POS_OFFSET, 1, &this->position_offset[0]);
+    GLState::bind_vertex_array(this->gl_vertex_array_object_id);
+    glDrawElements(GL_TRIANGLES, range.index_count,
+        this->index_size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+        (void*) ((size_t) range.index_offset * this->index_size));
+    stat_triangles_drawn += range.index_count / 3;
+    stat_triangles_full += this->lods[0].index_count / 3;
+}
+
+void Geometry::use_geometry_instanced(unsigned int instance_buffer,
+    uint64_t generation, unsigned int first_instance, unsigned int instance_count, unsigned int lod) {
     if(this->resource_state != LoadableResourceState::LOADED) { return; }
-    glBindVertexArray(this->gl_vertex_array_object_id);
-    glDrawArrays(GL_TRIANGLES, 0, this->vertex_array_size);
-}
\ No newline at end of file
+    if(lod >= this->lods.size()) {
+        lod = this->lods.size() - 1;
+    }
+    const GeometryLOD& range = this->lods[lod];
+    glUniform3fv(SE_SHADER_LOC_IN_POS_SCALE, 1, &this->position_scale[0]);
+    glUniform3fv(SE_SHADER_LOC_IN_POS_OFFSET, 1, &this->position_offset[0]);
+    GLState::bind_vertex_array(this->gl_vertex_array_object_id);
+    /* Instance attributes are part of the vertex array object state, so they
+    only need to be configured when the instance buffer changes.  Buffer names
+    can be reused once deleted, so the generation has to be compared too. */
+    if(this->gl_instance_buffer_id != instance_buffer ||
+        this->gl_instance_buffer_generation != generation) {
+        GLState::bind_buffer(GL_ARRAY_BUFFER, instance_buffer);
+        for(int i = 0; i < 4; i++) {
+            glVertexAttribPointer(SE_SHADER_LOC_IN_INSTANCE_MODEL + i, 4, GL_FLOAT,
+                GL_FALSE, sizeof(GeometryInstance),
+                (void*) (offsetof(GeometryInstance, model) + i * sizeof(glm::vec4)));
+            glVertexAttribDivisor(SE_SHADER_LOC_IN_INSTANCE_MODEL + i, 1);
+            glEnableVertexAttribArray(SE_SHADER_LOC_IN_INSTANCE_MODEL + i);
+        }
+        glVertexAttribIPointer(SE_SHADER_LOC_IN_INSTANCE_LAYER, 1, GL_UNSIGNED_INT,
+            sizeof(GeometryInstance), (void*) offsetof(GeometryInstance, layer));
+        glVertexAttribDivisor(SE_SHADER_LOC_IN_INSTANCE_LAYER, 1);
+        glEnableVertexAttribArray(SE_SHADER_LOC_IN_INSTANCE_LAYER);
+        this->gl_instance_buffer_id = instance_buffer;
+        this->gl_instance_buffer_generation = generation;
+    }
+    glDrawElementsInstancedBaseInstance(GL_TRIANGLES, range.index_count,
+        this->index_size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+        (void*) ((size_t) range.index_offset * this->index_size),
+        instance_count, first_instance);
+    stat_triangles_drawn += (uint64_t) range.index_count / 3 * instance_count;
+    stat_triangles_full += (uint64_t) this->lods[0].index_count / 3 * instance_count;
+}
@@ -0,0 +1,245 @@
+/*!
+ *  @file src/se/graphics/glState.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/graphics/glState.hpp"
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+using namespace se::graphics;
+
+// ====================
+// == STATIC MEMBERS ==
+// ====================
+
+thread_local unsigned int GLState::program = GLState::UNKNOWN;
+thread_local unsigned int GLState::active_texture = GLState::UNKNOWN;
+thread_local unsigned int GLState::texture_targets[GLState::TEXTURE_UNIT_COUNT] = {};
+thread_local unsigned int GLState::textures[GLState::TEXTURE_UNIT_COUNT] = {};
+thread_local unsigned int GLState::vertex_array = GLState::UNKNOWN;
+thread_local unsigned int GLState::framebuffer = GLState::UNKNOWN;
+thread_local unsigned int GLState::buffers[3] = {
+    GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN};
+thread_local int8_t GLState::capabilities[3] = {-1, -1, -1};
+thread_local int8_t GLState::depth_write = -1;
+thread_local int8_t GLState::color_write = -1;
+thread_local unsigned int GLState::depth_function = GLState::UNKNOWN;
+thread_local GLStateStats GLState::frame_stats;
+
+// =====================
+// == PRIVATE METHODS ==
+// =====================
+
+int GLState::buffer_index(GLenum target) {
+    switch(target) {
+        case GL_ARRAY_BUFFER: return 0;
+        case GL_PIXEL_UNPACK_BUFFER: return 1;
+        case GL_UNIFORM_BUFFER: return 2;
+        default: return -1;
+    }
+}
+
+int GLState::capability_index(GLenum cap) {
+    switch(cap) {
+        case GL_DEPTH_TEST: return 0;
+        case GL_BLEND: return 1;
+        case GL_CULL_FACE: return 2;
+        default: return -1;
+    }
+}
+
+bool GLState::update(unsigned int& cached, unsigned int value) {
+    if(cached == value) {
+        frame_stats.elided++;
+        return false;
+    }
+    cached = value;
+    frame_stats.issued++;
+    return true;
+}
+
+// ====================
+// == PUBLIC METHODS ==
+// ====================
+
+void GLState::invalidate() {
+    program = UNKNOWN;
+    active_texture = UNKNOWN;
+    for(unsigned int i = 0; i < TEXTURE_UNIT_COUNT; i++) {
+        // A target of zero never matches, so the next bind is always issued
+        texture_targets[i] = 0;
+        textures[i] = 0;
+    }
+    vertex_array = UNKNOWN;
+    framebuffer = UNKNOWN;
+    for(unsigned int& buffer : buffers) {
+        buffer = UNKNOWN;
+    }
+    for(int8_t& capability : capabilities) {
+        capability = -1;
+    }
+    depth_write = -1;
+    color_write = -1;
+    depth_function = UNKNOWN;
+}
+
+void GLState::begin_frame() {
+    frame_stats = GLStateStats();
+}
+
+GLStateStats GLState::get_frame_stats() {
+    return frame_stats;
+}
+
+void GLState::use_program(unsigned int program) {
+    if(update(GLState::program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void GLState::bind_texture(GLenum unit, GLenum target, unsigned int texture) {
+    if(update(active_texture, unit)) {
+        glActiveTexture(unit);
+    }
+    bind_texture(target, texture);
+}
+
+void GLState::bind_texture(GLenum target, unsigned int texture) {
+    unsigned int index = active_texture - GL_TEXTURE0;
+    if(active_texture == UNKNOWN || index >= TEXTURE_UNIT_COUNT) {
+        frame_stats.issued++;
+        glBindTexture(target, texture);
+        return;
+    }
+    /* Each unit has a binding for every target, but only the last one is
+    remembered.  Binding to a different target is always issued. */
+    if(texture_targets[index] == target && textures[index] == texture) {
+        frame_stats.elided++;
+        return;
+    }
+    texture_targets[index] = target;
+    textures[index] = texture;
+    frame_stats.issued++;
+    glBindTexture(target, texture);
+}
+
+void GLState::bind_vertex_array(unsigned int vertex_array) {
+    if(update(GLState::vertex_array, vertex_array)) {
+        glBindVertexArray(vertex_array);
+    }
+}
+
+void GLState::bind_framebuffer(unsigned int framebuffer) {
+    if(update(GLState::framebuffer, framebuffer)) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+}
+
+void GLState::bind_buffer(GLenum target, unsigned int buffer) {
+    int index = buffer_index(target);
+    if(index < 0) {
+        frame_stats.issued++;
+        glBindBuffer(target, buffer);
+    } else if(update(buffers[index], buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void GLState::set_enabled(GLenum cap, bool enabled) {
+    int index = capability_index(cap);
+    if(index >= 0) {
+        if(capabilities[index] == enabled) {
+            frame_stats.elided++;
+            return;
+        }
+        capabilities[index] = enabled;
+    }
+    frame_stats.issued++;
+    if(enabled) {
+        glEnable(cap);
+    } else {
+        glDisable(cap);
+    }
+}
+
+void GLState::depth_mask(bool enabled) {
+    if(depth_write == enabled) {
+        frame_stats.elided++;
+        return;
+    }
+    depth_write = enabled;
+    frame_stats.issued++;
+    glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void GLState::color_mask(bool enabled) {
+    if(color_write == enabled) {
+        frame_stats.elided++;
+        return;
+    }
+    color_write = enabled;
+    frame_stats.issued++;
+    GLboolean value = enabled ? GL_TRUE : GL_FALSE;
+    glColorMask(value, value, value, value);
+}
+
+void GLState::depth_func(GLenum function) {
+    if(update(depth_function, function)) {
+        glDepthFunc(function);
+    }
+}
+
+/* Deleting a bound object resets the binding to zero, except for the current
+program, which stays in use until another one replaces it. */
+
+void GLState::delete_program(unsigned int program) {
+    glDeleteProgram(program);
+    if(GLState::program == program) {
+        GLState::program = UNKNOWN;
+    }
+}
+
+void GLState::delete_textures(int count, const unsigned int* textures) {
+    glDeleteTextures(count, textures);
+    for(int i = 0; i < count; i++) {
+        for(unsigned int unit = 0; unit < TEXTURE_UNIT_COUNT; unit++) {
+            if(GLState::textures[unit] == textures[i]) {
+                GLState::textures[unit] = 0;
+            }
+        }
+    }
+}
+
+void GLState::delete_vertex_arrays(int count, const unsigned int* vertex_arrays) {
+    glDeleteVertexArrays(count, vertex_arrays);
+    for(int i = 0; i < count; i++) {
+        if(vertex_array == vertex_arrays[i]) {
+            vertex_array = 0;
+        }
+    }
+}
+
+void GLState::delete_framebuffers(int count, const unsigned int* framebuffers) {
+    glDeleteFramebuffers(count, framebuffers);
+    for(int i = 0; i < count; i++) {
+        if(framebuffer == framebuffers[i]) {
+            framebuffer = 0;
+        }
+    }
+}
+
+void GLState::delete_buffers(int count, const unsigned int* buffers) {
+    glDeleteBuffers(count, buffers);
+    for(int i = 0; i < count; i++) {
+        for(unsigned int& buffer : GLState::buffers) {
+            if(buffer == buffers[i]) {
+                buffer = 0;
+            }
+        }
+    }
+}
@@ -9,7 +9,10 @@
 #include "se/graphics/graphicsController.hpp"
 
 #include "se/engine.hpp"
+#include "se/graphics/glState.hpp"
 #include "se/graphics/renderManager.hpp"
+#include "se/graphics/textureArray.hpp"
+#include "se/graphics/textureStreamer.hpp"
 
 #include "se/util/config.hpp"
 #include "se/util/log.hpp"
@@ -124,6 +127,28 @@ void GraphicsController::graphics_thread_main() {
         INFO("Late Frames: %u", bm_late_frames);
         INFO("Average FPS: %.3f", bm_average_fps);
     }
+    uint64_t bm_task_count = this->stat_total_task_count;
+    if(bm_task_count == 0) {
+        WARN("No graphics tasks executed! Skipping task benchmarking");
+    } else {
+        uint64_t bm_task_time_ns = this->stat_total_task_time_ns;
+        uint64_t bm_average_task_time_ns = bm_task_time_ns / bm_task_count;
+        float bm_task_time_ms = bm_task_time_ns / 1000000.0;
+        INFO("Graphics tasks executed: %lu", bm_task_count);
+        INFO("Time spent on tasks: %luns (%.3fms)", bm_task_time_ns, bm_task_time_ms);
+        INFO("Average task time: %luns", bm_average_task_time_ns);
+    }
+    // Streamed uploads release their tasks on shutdown, so they can be dropped
+    if(this->texture_streamer != nullptr) {
+        this->texture_streamer.load()->shutdown();
+    }
+    this->drop_pending_tasks();
+    INFO("Graphics tasks merged: %lu", (uint64_t) this->stat_merged_task_count);
+    INFO("Graphics tasks dropped: %lu", (uint64_t) this->stat_dropped_task_count);
+
+    if(this->texture_array_manager != nullptr) {
+        this->texture_array_manager.load()->shutdown();
+    }
 
 
     DEBUG("Render thread terminated");
@@ -131,6 +156,12 @@ void GraphicsController::graphics_thread_main() {
 }
 
 void GraphicsController::do_frame() {
+    this->graphics_thread_id = std::this_thread::get_id();
+
+    if(this->texture_streamer != nullptr) {
+        this->texture_streamer.load()->process_uploads();
+    }
+
     this->process_tasks();
 
     if(this->render_manager != nullptr) {
@@ -147,14 +178,145 @@ void GraphicsController::recalculate_fps_limit(se::util::ConfigurationValue* val
 }
 
 void GraphicsController::process_tasks() {
-    /* Tasks are executed one at a time to allow a frame to render in between.
-     * While this could potentially increase the time it takes for all pending
-     * tasks to complete, it prevents the graphics thread from becoming
+    /* Critical tasks are needed to render this frame correctly, so they are
+     * always executed.  Everything else is executed until the budget for this
+     * frame has been used up.  At least one task is always executed so that
+     * a budget of zero behaves like the old one-task-per-frame scheduler.
+     * Stopping at the budget prevents the graphics thread from becoming
      * frozen if there is a surge of jobs. */
-    if(this->tasks.size() > 0) {
-        GraphicsTask task = this->tasks.front();
-        task();
-        this->tasks.pop();
+    auto start_time = std::chrono::steady_clock::now();
+    int budget_us = *this->task_budget_us;
+    uint64_t budget_ns = budget_us > 0 ? budget_us * 1000ull : 0;
+    uint32_t executed = 0;
+    while(this->run_next_task(GraphicsTaskPriority::CRITICAL)) {
+        executed++;
+    }
+    uint64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_time).count();
+    while(executed == 0 || elapsed_ns < budget_ns) {
+        if(!this->run_next_task(GraphicsTaskPriority::BACKGROUND)) { break; }
+        executed++;
+        elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_time).count();
+    }
+
+    // Update the statistics
+    this->stat_frame_task_count = executed;
+    this->stat_frame_task_time_ns = elapsed_ns;
+    this->stat_total_task_count += executed;
+    this->stat_total_task_time_ns += elapsed_ns;
+    this->drain_window_count += executed;
+    auto window_duration = std::chrono::steady_clock::now() - this->drain_window_start;
+    uint64_t window_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(window_duration).count();
+    if(window_ns >= 1000000000) {
+        this->stat_drain_rate = this->drain_window_count / (window_ns / 1000000000.0);
+        this->drain_window_count = 0;
+        this->drain_window_start = std::chrono::steady_clock::now();
+    }
+}
+
+bool GraphicsController::run_next_task(GraphicsTaskPriority lowest) {
+    QueuedGraphicsTask queued;
+    for(int i = 0; i <= (int) lowest; i++) {
+        while(this->tasks[i].pop(queued)) {
+            if(queued.coalesce_key == 0) {
+                queued.task();
+                queued.handle->mark_complete();
+                return true;
+            }
+            // Look up the most recent task submitted under this key
+            CoalescedGraphicsTask coalesced;
+            {
+                std::lock_guard<std::mutex> lock(this->coalesced_tasks_mutex);
+                auto it = this->coalesced_tasks.find(queued.coalesce_key);
+                if(it == this->coalesced_tasks.end() ||
+                    it->second.sequence != queued.sequence) {
+                    /* Left behind when the task was promoted to a higher
+                    priority queue, skip it. */
+                    continue;
+                }
+                coalesced = std::move(it->second);
+                this->coalesced_tasks.erase(it);
+            }
+            coalesced.task();
+            for(auto& handle : coalesced.handles) {
+                handle->mark_complete();
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void GraphicsController::enqueue_task(GraphicsTask task,
+    GraphicsTaskHandle handle, GraphicsTaskPriority priority,
+    GraphicsTaskKey coalesce_key) {
+    if(coalesce_key == 0) {
+        this->tasks[(int) priority].push({std::move(task), std::move(handle), 0});
+        return;
+    }
+    uint64_t sequence;
+    {
+        std::lock_guard<std::mutex> lock(this->coalesced_tasks_mutex);
+        auto it = this->coalesced_tasks.find(coalesce_key);
+        if(it == this->coalesced_tasks.end()) {
+            CoalescedGraphicsTask& coalesced = this->coalesced_tasks[coalesce_key];
+            coalesced.task = std::move(task);
+            coalesced.handles.push_back(std::move(handle));
+            coalesced.priority = priority;
+        } else {
+            // Replace the pending task
+            CoalescedGraphicsTask& coalesced = it->second;
+            coalesced.task = std::move(task);
+            coalesced.handles.push_back(std::move(handle));
+            this->stat_merged_task_count++;
+            if(priority >= coalesced.priority) {
+                // Already queued at this priority or higher
+                return;
+            }
+            coalesced.priority = priority;
+        }
+        // Any marker already queued for this key is now stale
+        sequence = ++this->coalesced_task_sequence;
+        this->coalesced_tasks[coalesce_key].sequence = sequence;
+    }
+    this->tasks[(int) priority].push({nullptr, nullptr, coalesce_key, sequence});
+}
+
+void GraphicsController::drop_pending_tasks() {
+    /* Nothing queued now will ever run, but completing the handles releases
+    anyone blocked in `wait()`.  Completions may queue dependent tasks, which
+    are dropped in turn. */
+    bool dropped = true;
+    while(dropped) {
+        dropped = false;
+        QueuedGraphicsTask queued;
+        for(int i = 0; i < SE_GRAPHICS_TASK_PRIORITY_COUNT; i++) {
+            while(this->tasks[i].pop(queued)) {
+                dropped = true;
+                if(queued.coalesce_key == 0) {
+                    this->stat_dropped_task_count++;
+                    queued.handle->mark_complete();
+                    continue;
+                }
+                CoalescedGraphicsTask coalesced;
+                {
+                    std::lock_guard<std::mutex> lock(this->coalesced_tasks_mutex);
+                    auto it = this->coalesced_tasks.find(queued.coalesce_key);
+                    if(it == this->coalesced_tasks.end() ||
+                        it->second.sequence != queued.sequence) {
+                        // Stale marker, not a task
+                        continue;
+                    }
+                    coalesced = std::move(it->second);
+                    this->coalesced_tasks.erase(it);
+                }
+                this->stat_dropped_task_count++;
+                for(auto& handle : coalesced.handles) {
+                    handle->mark_complete();
+                }
+            }
+        }
     }
 }
 
@@ -224,8 +386,27 @@ void GraphicsController::init_gl() {
     // 58 111 166
     glClearColor(0.227, 0.434, 0.648, 1.0);
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    GLState::invalidate();
+    GLState::set_enabled(GL_DEPTH_TEST, true);
+    GLState::depth_func(GL_LESS);
+
+    // Set up streaming texture uploads
+    int upload_slot_count = this->engine->config->get_int("render.upload_slot_count", 4);
+    int upload_slot_kb = this->engine->config->get_int("render.upload_slot_kb", 16384);
+    if(upload_slot_count <= 0 || upload_slot_kb <= 0) {
+        INFO("Texture streaming disabled");
+    } else if(!GLEW_ARB_buffer_storage) {
+        WARN("ARB_buffer_storage is not supported, texture streaming disabled");
+    } else if(this->texture_streamer == nullptr) {
+        this->texture_streamer = new TextureStreamer(this->engine,
+            upload_slot_count, upload_slot_kb * 1024ull);
+    }
+
+    // Set up texture arrays
+    if(this->engine->config->get_bool("render.texture_arrays", false) &&
+        this->texture_array_manager == nullptr) {
+        this->texture_array_manager = new TextureArrayManager(this->engine);
+    }
 }
 
 // ====================
@@ -236,6 +417,11 @@ GraphicsController::GraphicsController(se::Engine* engine) {
     DEBUG("Initializing new graphics controller");
     this->engine = engine;
 
+    static int default_task_budget_us = 2000;
+    this->task_budget_us = this->engine->config->get_intp(
+        "render.task_budget_us", &default_task_budget_us);
+    this->drain_window_start = std::chrono::steady_clock::now();
+
     // Start the graphics thread
     if(this->engine->config->get_bool("render.use_sdl")) {
         this->graphics_thread = std::thread(&GraphicsController::graphics_thread_main, this);
@@ -252,11 +438,50 @@ GraphicsController::~GraphicsController() {
         DEBUG("Waiting for graphics thread to exit");
         this->graphics_thread.join();
     }
+    delete this->texture_streamer.load();
+    delete this->texture_array_manager.load();
 
 }
 
-void GraphicsController::submit_graphics_task(GraphicsTask task) {
-    this->tasks.push(task);
+GraphicsTaskHandle GraphicsController::submit_graphics_task(GraphicsTask task,
+    std::vector<GraphicsTaskHandle> dependencies) {
+    return this->submit_graphics_task(std::move(task),
+        GraphicsTaskPriority::NORMAL, 0, std::move(dependencies));
+}
+
+GraphicsTaskHandle GraphicsController::submit_graphics_task(GraphicsTask task,
+    GraphicsTaskPriority priority, GraphicsTaskKey coalesce_key,
+    std::vector<GraphicsTaskHandle> dependencies) {
+    GraphicsTaskHandle handle = std::make_shared<GraphicsTaskCompletion>(this);
+
+    // Ignore null dependencies
+    for(size_t i = 0; i < dependencies.size(); i++) {
+        if(dependencies[i] == nullptr) {
+            dependencies.erase(dependencies.begin() + i);
+            i--;
+        }
+    }
+    if(dependencies.size() == 0) {
+        this->enqueue_task(std::move(task), handle, priority, coalesce_key);
+        return handle;
+    }
+
+    /* The task is queued by whichever dependency completes last.  Completion
+    callbacks run on the graphics thread, which is allowed to submit tasks. */
+    auto remaining = std::make_shared<std::atomic<size_t>>(dependencies.size());
+    auto pending = std::make_shared<GraphicsTask>(std::move(task));
+    for(auto& dependency : dependencies) {
+        dependency->on_complete([this, remaining, pending, handle, priority, coalesce_key](){
+            if(--(*remaining) == 0) {
+                this->enqueue_task(std::move(*pending), handle, priority, coalesce_key);
+            }
+        });
+    }
+    return handle;
+}
+
+bool GraphicsController::is_graphics_thread() {
+    return this->graphics_thread_id == std::this_thread::get_id();
 }
 
 void GraphicsController::set_render_manager(RenderManager* manager) {
@@ -267,6 +492,31 @@ RenderManager* GraphicsController::get_render_manager() {
     return this->render_manager;
 }
 
+TextureStreamer* GraphicsController::get_texture_streamer() {
+    return this->texture_streamer;
+}
+
+TextureArrayManager* GraphicsController::get_texture_array_manager() {
+    return this->texture_array_manager;
+}
+
 int GraphicsController::pending_task_count() {
-    return this->tasks.size();
+    size_t count = 0;
+    for(int i = 0; i < SE_GRAPHICS_TASK_PRIORITY_COUNT; i++) {
+        count += this->tasks[i].size();
+    }
+    return count;
+}
+
+GraphicsTaskStats GraphicsController::get_task_stats() {
+    GraphicsTaskStats stats;
+    stats.pending = this->pending_task_count();
+    stats.frame_task_count = this->stat_frame_task_count;
+    stats.frame_task_time_ns = this->stat_frame_task_time_ns;
+    stats.total_task_count = this->stat_total_task_count;
+    stats.total_task_time_ns = this->stat_total_task_time_ns;
+    stats.drain_rate = this->stat_drain_rate;
+    stats.merged_task_count = this->stat_merged_task_count;
+    stats.dropped_task_count = this->stat_dropped_task_count;
+    return stats;
 }
\ No newline at end of file
@@ -42,7 +42,7 @@ void GraphicsEventHandler::window_resize(SDL_Event event) {
             this->parent->engine->config->set("window.dimy", dimy);
             this->parent->submit_graphics_task([dimx,dimy](){
                 glViewport(0, 0, dimx, dimy);
-            });
+            }, GraphicsTaskPriority::CRITICAL, graphics_task_key(this, 0));
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+/*!
+ *  @file src/se/graphics/graphicsTask.cpp
+ *
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ *
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/graphics/graphicsTask.hpp"
+
+#include "se/graphics/graphicsController.hpp"
+
+#include "se/util/log.hpp"
+
+using namespace se::graphics;
+
+// =====================
+// == PRIVATE MEMBERS ==
+// =====================
+
+void GraphicsTaskCompletion::on_complete(std::function<void(void)> callback) {
+    {
+        std::lock_guard<std::mutex> lock(this->completion_mutex);
+        if(!this->complete) {
+            this->callbacks.push_back(std::move(callback));
+            return;
+        }
+    }
+    // Already complete, run it now
+    callback();
+}
+
+// ====================
+// == PUBLIC MEMBERS ==
+// ====================
+
+GraphicsTaskCompletion::GraphicsTaskCompletion(GraphicsController* controller) {
+    this->controller = controller;
+    this->submit_time = std::chrono::steady_clock::now();
+}
+
+void GraphicsTaskCompletion::mark_complete() {
+    std::vector<std::function<void(void)>> pending_callbacks;
+    {
+        std::lock_guard<std::mutex> lock(this->completion_mutex);
+        this->complete_time = std::chrono::steady_clock::now();
+        this->complete = true;
+        pending_callbacks.swap(this->callbacks);
+    }
+    this->completion_condition.notify_all();
+    for(auto& callback : pending_callbacks) {
+        callback();
+    }
+}
+
+bool GraphicsTaskCompletion::is_complete() {
+    return this->complete;
+}
+
+void GraphicsTaskCompletion::wait() {
+    if(this->complete) { return; }
+    if(this->controller->is_graphics_thread()) {
+        ERROR("Attempted to wait for an incomplete task from the graphics "
+            "thread! This would deadlock.");
+        return;
+    }
+    std::unique_lock<std::mutex> lock(this->completion_mutex);
+    this->completion_condition.wait(lock, [this](){ return (bool) this->complete; });
+}
+
+GraphicsTaskHandle GraphicsTaskCompletion::then(GraphicsTask task) {
+    return this->controller->submit_graphics_task(task, {this->shared_from_this()});
+}
+
+uint64_t GraphicsTaskCompletion::get_latency_ns() {
+    if(!this->complete) { return 0; }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        this->complete_time - this->submit_time).count();
+}
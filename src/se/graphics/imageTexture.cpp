@@ -16,9 +16,15 @@
 #include "se/util/hash.hpp"
 #include "se/util/log.hpp"
 #include "se/util/debugstrings.hpp"
+#include "se/util/mappedFile.hpp"
+#include "se/util/mipmap.hpp"
+#include "se/util/threadPool.hpp"
 
+#include <chrono>
 #include <string.h>
 #include <string>
+#include <sys/stat.h>
+#include <vector>
 #include <SDL2/SDL.h>
 #include <png.h>
 #include <GL/glew.h>
@@ -35,11 +41,44 @@ using namespace se::util;
 
 #define TEXTURE_HASH_FORMAT "imagetexture:%p:%s"
 
+/// Texture cache file magic number
+#define TEXTURE_CACHE_MAGIC "SETEX\0\0\0"
+/// Texture cache format version, increment whenever the layout changes
+#define TEXTURE_CACHE_VERSION 1
+
+/*!
+ *  Texture Cache Header.
+ * 
+ *  Decoded textures are stored in the cache as this header, followed by the
+ *  complete mip chain, exactly as it is uploaded to the GPU.
+ */
+struct TextureCacheHeader {
+    /// Magic number (`TEXTURE_CACHE_MAGIC`)
+    char magic[8];
+    /// Format version (`TEXTURE_CACHE_VERSION`)
+    uint32_t version;
+    /// Level 0 width
+    uint32_t width;
+    /// Level 0 height
+    uint32_t height;
+    /// Number of channels (3 or 4)
+    uint32_t channels;
+    /// Number of mip levels
+    uint32_t mip_levels;
+    /// Unused, keeps the following fields aligned
+    uint32_t reserved;
+    /// Modification time of the source file (nanoseconds)
+    int64_t source_mtime_ns;
+    /// Size of the source file
+    uint64_t source_size;
+};
+
 ImageTexture::ImageTexture(se::Engine* engine, const char* name) : Texture(engine, name) {
     this->cache_resource(this);
 }
 
 ImageTexture::~ImageTexture() {
+    delete this->texture_cache;
 }
 
 void ImageTexture::bind() {
@@ -47,112 +86,292 @@ void ImageTexture::bind() {
     Texture::bind();
 
     /* Deleting texture data is optional, but will help conserve some memory.
-    the texture re-loading process will re-read it from disk, so there's no
-    need to keep a copy cached in memory after it's been bound to the disk. */
-    delete this->texture_data;
+    The next load will map the texture cache again, so there's no need to keep
+    a copy in memory after it's been bound. */
     this->texture_data = nullptr;
+    this->release_texture_data();
 
 }
 
-// =======================
-// == PROTECTED METHODS ==
-// =======================
+void ImageTexture::release_texture_data() {
+    this->pixel_data.clear();
+    this->pixel_data.shrink_to_fit();
+    delete this->texture_cache;
+    this->texture_cache = nullptr;
+}
 
-void ImageTexture::load_() {
-    DEBUG("Loading texture [%s]", this->name);
-    this->resource_state = LoadableResourceState::LOADING;
-    
+bool ImageTexture::decode() {
     std::string fname = se::util::dirs::app_data();
     fname += "/textures/";
     fname += this->name;
     fname += ".png";
 
+    // The source file's metadata is used to validate the cached copy
+    struct stat source_stat;
+    if(stat(fname.c_str(), &source_stat) != 0) {
+        ERROR("[%s] Failed to stat texture file [%s] [%i: %s]",
+            this->name, fname.c_str(), errno, strerror(errno));
+        return false;
+    }
+    int64_t source_mtime_ns = source_stat.st_mtim.tv_sec * 1000000000ll +
+        source_stat.st_mtim.tv_nsec;
+    uint64_t source_size = source_stat.st_size;
+
+    char cache_name[16];
+    snprintf(cache_name, sizeof(cache_name), "%08x",
+        se::util::hash::jenkins(fname.c_str(), fname.size()));
+    std::string cache_fname = se::util::dirs::cache_data();
+    cache_fname += "/textures/";
+    cache_fname += cache_name;
+    cache_fname += ".tex";
+
+    if(this->read_cache(cache_fname, source_mtime_ns, source_size)) {
+        DEBUG("Loaded [%s] from texture cache, waiting for bind", this->name);
+        return true;
+    }
+
+    auto bm_start_time = std::chrono::steady_clock::now();
+    int channels = this->decode_png(fname);
+    if(channels == 0) {
+        return false;
+    }
+    auto bm_decode_time = std::chrono::steady_clock::now();
+    se::util::mipmap::generate(this->pixel_data.data(), this->options.dimx,
+        this->options.dimy, channels);
+    auto bm_end_time = std::chrono::steady_clock::now();
+    INFO("[%s] Decoded %ix%i in %.3fms, %u mip levels generated in %.3fms",
+        this->name, this->options.dimx, this->options.dimy,
+        std::chrono::duration_cast<std::chrono::microseconds>(bm_decode_time - bm_start_time).count() / 1000.0,
+        this->options.mip_levels,
+        std::chrono::duration_cast<std::chrono::microseconds>(bm_end_time - bm_decode_time).count() / 1000.0);
+
+    this->texture_data = (char*) this->pixel_data.data();
+    this->write_cache(cache_fname, source_mtime_ns, source_size, channels);
+
+    DEBUG("Loaded [%s], waiting for bind", this->name);
+    return true;
+}
+
+bool ImageTexture::read_cache(std::string cache_fname, int64_t source_mtime_ns,
+    uint64_t source_size) {
+    delete this->texture_cache;
+    this->texture_cache = new se::util::MappedFile(cache_fname);
+    bool valid = false;
+    if(this->texture_cache->is_valid() &&
+        this->texture_cache->get_size() >= sizeof(TextureCacheHeader)) {
+        const TextureCacheHeader* header = (const TextureCacheHeader*) this->texture_cache->get_data();
+        valid = memcmp(header->magic, TEXTURE_CACHE_MAGIC, 8) == 0 &&
+            header->version == TEXTURE_CACHE_VERSION &&
+            header->source_mtime_ns == source_mtime_ns &&
+            header->source_size == source_size &&
+            (header->channels == 3 || header->channels == 4) &&
+            header->mip_levels == se::util::mipmap::level_count(header->width, header->height) &&
+            this->texture_cache->get_size() == sizeof(TextureCacheHeader) +
+                se::util::mipmap::chain_size(header->width, header->height, header->channels);
+        if(valid) {
+            this->options.dimx = header->width;
+            this->options.dimy = header->height;
+            this->options.mip_levels = header->mip_levels;
+            this->options.gl_color_format = header->channels == 4 ? GL_RGBA : GL_RGB;
+            this->options.gl_data_format = header->channels == 4 ? GL_RGBA : GL_RGB;
+            this->options.gl_min_filter = GL_LINEAR_MIPMAP_LINEAR;
+            this->texture_data = (char*) this->texture_cache->get_data() + sizeof(TextureCacheHeader);
+        } else {
+            DEBUG("[%s] Texture cache is stale", this->name);
+        }
+    }
+    if(!valid) {
+        delete this->texture_cache;
+        this->texture_cache = nullptr;
+    }
+    return valid;
+}
+
+void ImageTexture::write_cache(std::string cache_fname, int64_t source_mtime_ns,
+    uint64_t source_size, int channels) {
+    if(!se::util::dirs::create_directories(se::util::dirs::cache_data() + "/textures")) {
+        return;
+    }
+    // Written to a temporary file first (see `Geometry::write_cache()`)
+    std::string temp_fname = cache_fname + ".tmp";
+    FILE* fp = fopen(temp_fname.c_str(), "wb");
+    if(fp == nullptr) {
+        WARN("[%s] Failed to open texture cache file [%s] [%i: %s]",
+            this->name, temp_fname.c_str(), errno, strerror(errno));
+        return;
+    }
+    TextureCacheHeader header;
+    memcpy(header.magic, TEXTURE_CACHE_MAGIC, 8);
+    header.version = TEXTURE_CACHE_VERSION;
+    header.width = this->options.dimx;
+    header.height = this->options.dimy;
+    header.channels = channels;
+    header.mip_levels = this->options.mip_levels;
+    header.reserved = 0;
+    header.source_mtime_ns = source_mtime_ns;
+    header.source_size = source_size;
+    bool success =
+        fwrite(&header, sizeof(header), 1, fp) == 1 &&
+        fwrite(this->pixel_data.data(), 1, this->pixel_data.size(), fp) == this->pixel_data.size();
+    success = (fclose(fp) == 0) && success;
+    if(!success || rename(temp_fname.c_str(), cache_fname.c_str()) != 0) {
+        WARN("[%s] Failed to write texture cache file [%s]", this->name, cache_fname.c_str());
+        remove(temp_fname.c_str());
+        return;
+    }
+    DEBUG("[%s] Wrote texture cache [%s]", this->name, cache_fname.c_str());
+}
+
+int ImageTexture::decode_png(std::string fname) {
+
     // Load the file header
     FILE* fp = fopen(fname.c_str(), "rb");
     if(fp == nullptr) {
         ERROR("[%s] Failed to open texture file [%s] [%i: %s]",
             this->name, fname.c_str(), errno, strerror(errno));
-        this->resource_state = LoadableResourceState::ERROR;
-        return;
+        return 0;
     }
     char png_signature[8];
     size_t header_read_count = fread(png_signature, 1, 8, fp);
     if(header_read_count != 8) {
         ERROR("[%s] Read wrong number of signature bytes (expected %i, got %i)",
-            8, header_read_count);
-        this->resource_state = LoadableResourceState::ERROR;
-        return;
+            this->name, 8, header_read_count);
+        fclose(fp);
+        return 0;
     }
     if(png_sig_cmp((png_const_bytep) png_signature, 0, 8)) {
         ERROR("[%s] Not a PNG file [%s]",
             this->name, fname.c_str());
-        this->resource_state = LoadableResourceState::ERROR;
-        return;
+        fclose(fp);
+        return 0;
     }
     png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
     if(!png_ptr) {
         ERROR("[%s] Failed to create png read structure", this->name);
-        this->resource_state = LoadableResourceState::ERROR;
-        return;
+        fclose(fp);
+        return 0;
     }
     png_infop info_ptr = png_create_info_struct(png_ptr);
     if(!info_ptr) {
         ERROR("[%s] Failed to create png info structure", this->name);
-        this->resource_state = LoadableResourceState::ERROR;
-        return;
+        png_destroy_read_struct(&png_ptr, NULL, NULL);
+        fclose(fp);
+        return 0;
     }
+    std::vector<png_bytep> rows;
     if(setjmp(png_jmpbuf(png_ptr))) {
-        ERROR("[%s] Encountered error during init_io", this->name);
-        this->resource_state = LoadableResourceState::ERROR;
-        return;
+        ERROR("[%s] Error while decoding [%s]", this->name, fname.c_str());
+        png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+        fclose(fp);
+        return 0;
     }
 
     png_init_io(png_ptr, fp);
     png_set_sig_bytes(png_ptr, 8);
     png_read_info(png_ptr, info_ptr);
+    // Whatever the source format is, decode it as 8 bit RGB or RGBA
+    png_set_expand(png_ptr);
+    png_set_strip_16(png_ptr);
+    png_set_gray_to_rgb(png_ptr);
+    png_read_update_info(png_ptr, info_ptr);
     this->options.dimx = png_get_image_width(png_ptr, info_ptr);
     this->options.dimy = png_get_image_height(png_ptr, info_ptr);
-    //png_byte color_type = png_get_color_type(png_ptr, info_ptr);
-    //png_byte bit_depth = png_get_bit_depth(png_ptr, info_ptr);
-    //int number_of_passes = png_set_interlace_handling(png_ptr);
-    // TODO: What do the above 3 variables actually mean, and why should I care?
-    uint32_t row_bytes = png_get_rowbytes(png_ptr, info_ptr);
-    png_read_update_info(png_ptr, info_ptr);
+    int channels = png_get_channels(png_ptr, info_ptr);
+    size_t row_bytes = png_get_rowbytes(png_ptr, info_ptr);
 
-    // This is the part where the png file actually gets read
-    if(setjmp(png_jmpbuf(png_ptr))) {
-        ERROR("[%s] Error during read_image", this->name);
-        this->resource_state = LoadableResourceState::ERROR;
-        return;
-    }
-    /* We're reading the image data into this multi-array structure first
-    because that's the way libpng does it. */
-    png_bytep* rows[this->options.dimx];
-    for(int y = 0; y < this->options.dimy; y++) {
-        rows[y] = new png_bytep[row_bytes];
-    }
-    png_read_image(png_ptr, (png_bytepp) rows);
-    /* Now we convert the row data into a single continuous string of bytes so
-    that it can be bound by opengl */
-    this->texture_data = new char[this->options.dimy * row_bytes];
+    /* Rows are decoded straight into the level 0 image, bottom row first
+    because that's what OpenGL expects. */
+    this->options.mip_levels = se::util::mipmap::level_count(this->options.dimx, this->options.dimy);
+    this->pixel_data.resize(se::util::mipmap::chain_size(this->options.dimx,
+        this->options.dimy, channels));
+    rows.resize(this->options.dimy);
     for(int y = 0; y < this->options.dimy; y++) {
-        unsigned int index = (this->options.dimy - y) - 1;
-        memcpy(this->texture_data + (y * row_bytes), rows[index], row_bytes);
-        delete[] rows[index];
+        rows[y] = this->pixel_data.data() + (this->options.dimy - y - 1) * row_bytes;
     }
+    png_read_image(png_ptr, rows.data());
+    png_read_end(png_ptr, NULL);
+    png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+    fclose(fp);
 
-    // Submit to binding queue
-    DEBUG("Loaded [%s], waiting for bind", this->name);
-    std::function job = [this](){this->bind();};
-    this->engine->graphics_controller->submit_graphics_task(job);
+    this->options.gl_color_format = channels == 4 ? GL_RGBA : GL_RGB;
+    this->options.gl_data_format = channels == 4 ? GL_RGBA : GL_RGB;
+    this->options.gl_min_filter = GL_LINEAR_MIPMAP_LINEAR;
+    return channels;
 
 }
 
+// =======================
+// == PROTECTED METHODS ==
+// =======================
+
+void ImageTexture::load_() {
+    DEBUG("Loading texture [%s]", this->name);
+    uint32_t generation;
+    {
+        std::lock_guard<std::mutex> lock(this->state_mutex);
+        generation = ++this->load_generation;
+        this->resource_state = LoadableResourceState::LOADING;
+    }
+
+    /* Decoding is done on the worker pool, and the bind task is queued behind
+    it so that only the upload itself happens on the graphics thread.  Decoded
+    data is staged in the texture streamer where possible, in which case the
+    bind task also waits for the upload to fit in the per-frame budget.  If the
+    decode fails the state will no longer be `LOADING`, and the bind is skipped.
+    If the texture is unloaded or reloaded in the meantime the generation will
+    have changed, and the decode and bind are both skipped.  Whatever they
+    staged has already been discarded by the unload.  A stale bind returns
+    before taking the state lock, and the state lock is never held across a
+    decode, so the graphics thread never waits for one. */
+    GraphicsTaskHandle decoded = std::make_shared<GraphicsTaskCompletion>(
+        this->engine->graphics_controller);
+    std::function job = [this, generation](){
+        if(this->load_generation != generation) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(this->state_mutex);
+        if(this->load_generation != generation) {
+            return;
+        }
+        if(this->resource_state != LoadableResourceState::LOADING) {
+            this->discard_upload();
+            return;
+        }
+        this->bind();
+    };
+    this->bind_handle = this->engine->graphics_controller->submit_graphics_task(
+        job, GraphicsTaskPriority::BACKGROUND, 0, {decoded});
+    this->engine->worker_pool->submit([this, decoded, generation](){
+        std::lock_guard<std::mutex> decode_lock(this->decode_mutex);
+        if(this->load_generation != generation) {
+            decoded->mark_complete();
+            return;
+        }
+        bool success = this->decode();
+        std::lock_guard<std::mutex> lock(this->state_mutex);
+        if(this->load_generation != generation) {
+            decoded->mark_complete();
+            return;
+        }
+        if(!success) {
+            this->resource_state = LoadableResourceState::ERROR;
+        }
+        this->stage_upload(decoded);
+    });
+}
+
 void ImageTexture::unload_() {
     DEBUG("Unloading [%s], waiting for unbind", this->name);
-    this->resource_state = LoadableResourceState::NOT_LOADED;
+    {
+        // A decode in progress is left to finish, and then dropped
+        std::lock_guard<std::mutex> lock(this->state_mutex);
+        this->load_generation++;
+        this->resource_state = LoadableResourceState::NOT_LOADED;
+        this->discard_upload();
+    }
     std::function job = [this](){this->unbind();};
-    this->engine->graphics_controller->submit_graphics_task(job);
+    this->engine->graphics_controller->submit_graphics_task(job,
+        GraphicsTaskPriority::BACKGROUND, 0, {this->bind_handle});
 }
 
 uint32_t ImageTexture::resource_id() {
@@ -0,0 +1,156 @@
+/*!
+ *  @file src/se/graphics/instancedRenderer.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/graphics/instancedRenderer.hpp"
+
+#include "se/engine.hpp"
+#include "se/graphics/commandList.hpp"
+#include "se/graphics/glState.hpp"
+#include "se/graphics/graphicsController.hpp"
+#include "se/graphics/imageTexture.hpp"
+#include "se/graphics/shader.hpp"
+#include "se/graphics/shaderProgram.hpp"
+#include "se/graphics/streamBuffer.hpp"
+#include "se/graphics/textureArray.hpp"
+
+#include "se/util/log.hpp"
+
+#include <algorithm>
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+using namespace se::graphics;
+
+// ====================
+// == PUBLIC METHODS ==
+// ====================
+
+InstancedRenderer::InstancedRenderer(se::Engine* engine) {
+    this->engine = engine;
+    this->stream = new StreamBuffer(sizeof(GeometryInstance));
+}
+
+InstancedRenderer::~InstancedRenderer() {
+    /* The instance buffer is not deleted here, because the renderer may be
+    destroyed outside of the graphics thread.  It goes with the context. */
+    delete this->stream;
+    if(this->stat_frame_count == 0) {
+        WARN("No instanced frames drawn! Skipping instancing benchmarks");
+    } else {
+        INFO("Instanced draw calls per frame: %.2f",
+            (double) this->stat_draw_count / this->stat_frame_count);
+        INFO("Instances per frame: %.2f",
+            (double) this->stat_instance_count / this->stat_frame_count);
+    }
+}
+
+void InstancedRenderer::submit(const DrawCommand& command, const glm::mat4& model_matrix) {
+    InstanceBatchKey key;
+    key.program = command.instanced_program;
+    key.geometry = command.geometry;
+    key.array = nullptr;
+    key.texture = command.texture;
+    key.lod = command.lod;
+    GeometryInstance instance;
+    instance.model = model_matrix;
+    instance.layer = 0;
+    if(command.texture_layer != nullptr) {
+        key.array = command.texture_layer->get_array();
+        instance.layer = command.texture_layer->get_layer();
+    }
+    this->batches[key].push_back(instance);
+}
+
+void InstancedRenderer::draw() {
+    size_t instance_count = 0;
+    for(auto& batch : this->batches) {
+        instance_count += batch.second.size();
+    }
+
+    /* Each batch is copied straight into the mapped stream buffer, with no
+    further staging or upload.  Without persistent mapping they're packed into
+    the staging buffer and uploaded instead. */
+    unsigned int instance_buffer = this->gl_instance_buffer_id;
+    uint64_t instance_buffer_generation = 0;
+    size_t base_instance = 0;
+    bool streamed = false;
+    if(instance_count > 0) {
+        GeometryInstance* mapped = (GeometryInstance*) this->stream->begin_frame(
+            instance_count * sizeof(GeometryInstance));
+        if(mapped != nullptr) {
+            for(auto& batch : this->batches) {
+                std::copy(batch.second.begin(), batch.second.end(), mapped);
+                mapped += batch.second.size();
+            }
+            instance_buffer = this->stream->get_buffer_id();
+            instance_buffer_generation = this->stream->get_generation();
+            base_instance = this->stream->get_offset() / sizeof(GeometryInstance);
+            streamed = true;
+        } else {
+            this->staging.clear();
+            for(auto& batch : this->batches) {
+                this->staging.insert(this->staging.end(), batch.second.begin(), batch.second.end());
+            }
+            if(this->gl_instance_buffer_id == 0) {
+                glGenBuffers(1, &this->gl_instance_buffer_id);
+            }
+            GLState::bind_buffer(GL_ARRAY_BUFFER, this->gl_instance_buffer_id);
+            if(this->staging.size() > this->instance_capacity) {
+                this->instance_capacity = std::max(this->staging.size(), this->instance_capacity * 2);
+            }
+            // Orphan the previous contents so the upload doesn't wait on the GPU
+            glBufferData(GL_ARRAY_BUFFER, this->instance_capacity * sizeof(GeometryInstance),
+                nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, this->staging.size() * sizeof(GeometryInstance),
+                this->staging.data());
+            instance_buffer = this->gl_instance_buffer_id;
+        }
+    }
+
+    TextureArrayManager* arrays = this->engine->graphics_controller->get_texture_array_manager();
+    this->frame_draw_count = 0;
+    this->frame_instance_count = instance_count;
+    size_t first_instance = base_instance;
+    for(auto it = this->batches.begin(); it != this->batches.end();) {
+        const InstanceBatchKey& key = it->first;
+        std::vector<GeometryInstance>& instances = it->second;
+        if(instances.size() == 0) {
+            // Nothing has used this batch since the last frame
+            it = this->batches.erase(it);
+            continue;
+        }
+        key.program->use_program();
+        if(key.array != nullptr) {
+            glUniform1i(SE_SHADER_LOC_TEX_0, 0);
+            arrays->bind_array(key.array, GL_TEXTURE0);
+        } else {
+            key.texture->use_texture(GL_TEXTURE0);
+        }
+        key.geometry->use_geometry_instanced(instance_buffer,
+            instance_buffer_generation, first_instance, instances.size(), key.lod);
+        first_instance += instances.size();
+        this->frame_draw_count++;
+        instances.clear();
+        it++;
+    }
+    if(streamed) {
+        this->stream->end_frame();
+    }
+
+    this->stat_frame_count++;
+    this->stat_draw_count += this->frame_draw_count;
+    this->stat_instance_count += this->frame_instance_count;
+}
+
+uint32_t InstancedRenderer::get_frame_draw_count() {
+    return this->frame_draw_count;
+}
+
+uint32_t InstancedRenderer::get_frame_instance_count() {
+    return this->frame_instance_count;
+}
@@ -0,0 +1,595 @@
+/*!
+ *  @file src/se/graphics/objParser.cpp
+ *
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ *
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/graphics/objParser.hpp"
+
+#include "se/util/dirs.hpp"
+#include "se/util/log.hpp"
+#include "se/util/mappedFile.hpp"
+#include "se/util/threadPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <errno.h>
+#include <functional>
+#include <stdio.h>
+#include <string>
+#include <string.h>
+
+using namespace se::graphics;
+
+/// Minimum number of bytes per parallel chunk
+#define OBJ_MIN_CHUNK_SIZE (1024 * 1024)
+/// Number of chunks per worker thread, for load balancing
+#define OBJ_CHUNKS_PER_THREAD 4
+/// Maximum number of significant digits parsed exactly
+#define OBJ_MAX_DIGITS 19
+
+/// Index used for relative references which fall outside of the file
+#define OBJ_INVALID_INDEX UINT32_MAX
+
+/// Per-chunk statement counts, determined by the pre-scan
+struct ChunkCounts {
+    /// Number of `v` statements
+    size_t positions = 0;
+    /// Number of `vt` statements
+    size_t uvs = 0;
+    /// Number of `vn` statements
+    size_t normals = 0;
+    /// Number of triangulated corners
+    size_t corners = 0;
+};
+
+/// Chunk of the input
+struct Chunk {
+    /// First byte of the chunk
+    const char* begin;
+    /// One past the last byte of the chunk
+    const char* end;
+    /// Statement counts
+    ChunkCounts counts;
+    /// Statement counts of all preceding chunks
+    ChunkCounts offsets;
+    /// Start of the offending line, if parsing failed
+    const char* error = nullptr;
+    /// Description of the error, if parsing failed
+    const char* error_desc = nullptr;
+};
+
+/// Powers of ten which are exactly representable as doubles
+static const double POW10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/// Check if a character is horizontal whitespace
+static inline bool is_space(char c) {
+    return c == ' ' || c == '\t';
+}
+
+/// Check if a character ends a statement
+static inline bool is_eol(char c) {
+    return c == '\n' || c == '\r' || c == '#';
+}
+
+/// Check if a character is a decimal digit
+static inline bool is_digit(char c) {
+    return (unsigned char) (c - '0') < 10;
+}
+
+/// Skip horizontal whitespace
+static inline void skip_space(const char*& p, const char* end) {
+    while(p < end && is_space(*p)) { p++; }
+}
+
+/// Advance to the start of the next line
+static inline void skip_line(const char*& p, const char* end) {
+    const char* newline = (const char*) memchr(p, '\n', end - p);
+    p = newline == nullptr ? end : newline + 1;
+}
+
+/*!
+ *  Parse a float.
+ *
+ *  Locale independent replacement for `strtof()`.  Up to `OBJ_MAX_DIGITS`
+ *  significant digits are accumulated in an integer and scaled once by a
+ *  power of ten, which is exact for everything a modelling tool will
+ *  realistically write out.
+ */
+static bool parse_float(const char*& p, const char* end, float& out) {
+    const char* s = p;
+    bool negative = false;
+    if(s < end && (*s == '-' || *s == '+')) {
+        negative = *s == '-';
+        s++;
+    }
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    bool any_digits = false;
+    // Integer part
+    for(; s < end && is_digit(*s); s++) {
+        any_digits = true;
+        if(digits < OBJ_MAX_DIGITS) {
+            mantissa = mantissa * 10 + (*s - '0');
+            // Leading zeros are not significant
+            if(mantissa != 0) { digits++; }
+        } else {
+            exponent++;
+        }
+    }
+    // Fractional part
+    if(s < end && *s == '.') {
+        s++;
+        for(; s < end && is_digit(*s); s++) {
+            any_digits = true;
+            if(digits < OBJ_MAX_DIGITS) {
+                mantissa = mantissa * 10 + (*s - '0');
+                exponent--;
+                if(mantissa != 0) { digits++; }
+            }
+        }
+    }
+    if(!any_digits) { return false; }
+    // Exponent
+    if(s < end && (*s == 'e' || *s == 'E')) {
+        const char* e = s + 1;
+        bool exponent_negative = false;
+        if(e < end && (*e == '-' || *e == '+')) {
+            exponent_negative = *e == '-';
+            e++;
+        }
+        if(e < end && is_digit(*e)) {
+            int value = 0;
+            for(; e < end && is_digit(*e); e++) {
+                if(value < 10000) { value = value * 10 + (*e - '0'); }
+            }
+            exponent += exponent_negative ? -value : value;
+            s = e;
+        }
+    }
+    double value = (double) mantissa;
+    if(exponent < 0) {
+        value = -exponent <= 22 ? value / POW10[-exponent] : value * std::pow(10.0, exponent);
+    } else if(exponent > 0) {
+        value = exponent <= 22 ? value * POW10[exponent] : value * std::pow(10.0, exponent);
+    }
+    out = (float) (negative ? -value : value);
+    p = s;
+    return true;
+}
+
+/// Parse a (possibly negative) integer
+static bool parse_int(const char*& p, const char* end, int64_t& out) {
+    const char* s = p;
+    bool negative = false;
+    if(s < end && (*s == '-' || *s == '+')) {
+        negative = *s == '-';
+        s++;
+    }
+    if(s >= end || !is_digit(*s)) { return false; }
+    int64_t value = 0;
+    for(; s < end && is_digit(*s); s++) {
+        if(value < INT32_MAX) { value = value * 10 + (*s - '0'); }
+    }
+    out = negative ? -value : value;
+    p = s;
+    return true;
+}
+
+/*!
+ *  Resolve an index.
+ *
+ *  Positive indices are absolute, negative indices are relative to the number
+ *  of elements defined so far.
+ */
+static inline uint32_t resolve_index(int64_t index, size_t defined) {
+    if(index > 0) { return index; }
+    int64_t resolved = (int64_t) defined + index + 1;
+    return resolved > 0 ? resolved : OBJ_INVALID_INDEX;
+}
+
+/// Statement types
+enum class Statement {
+    POSITION,
+    UV,
+    NORMAL,
+    FACE,
+    OTHER
+};
+
+/*!
+ *  Identify the statement at the start of a line.
+ *
+ *  Leading whitespace is skipped, and `p` is left after the keyword.
+ */
+static Statement identify(const char*& p, const char* end) {
+    skip_space(p, end);
+    if(p >= end) { return Statement::OTHER; }
+    char c0 = *p;
+    char c1 = p + 1 < end ? p[1] : '\n';
+    if(c0 == 'v') {
+        if(is_space(c1)) { p += 1; return Statement::POSITION; }
+        char c2 = p + 2 < end ? p[2] : '\n';
+        if(c1 == 't' && is_space(c2)) { p += 2; return Statement::UV; }
+        if(c1 == 'n' && is_space(c2)) { p += 2; return Statement::NORMAL; }
+    } else if(c0 == 'f' && is_space(c1)) {
+        p += 1;
+        return Statement::FACE;
+    }
+    return Statement::OTHER;
+}
+
+/*!
+ *  Pre-scan a chunk.
+ *
+ *  Counts statements so that the output can be allocated exactly.  Face
+ *  corners are counted as whitespace separated tokens, which must match the
+ *  tokenization used by `parse_face()`.
+ */
+static void scan_chunk(Chunk& chunk) {
+    const char* p = chunk.begin;
+    const char* end = chunk.end;
+    while(p < end) {
+        switch(identify(p, end)) {
+            case Statement::POSITION: chunk.counts.positions++; break;
+            case Statement::UV:       chunk.counts.uvs++;       break;
+            case Statement::NORMAL:   chunk.counts.normals++;   break;
+            case Statement::FACE: {
+                size_t tokens = 0;
+                while(true) {
+                    skip_space(p, end);
+                    if(p >= end || is_eol(*p)) { break; }
+                    tokens++;
+                    while(p < end && !is_space(*p) && !is_eol(*p)) { p++; }
+                }
+                if(tokens >= 3) {
+                    chunk.counts.corners += (tokens - 2) * 3;
+                }
+                break;
+            }
+            default: break;
+        }
+        skip_line(p, end);
+    }
+}
+
+/// Parse a single face corner
+static bool parse_corner(const char*& p, const char* end, const ChunkCounts& defined,
+    obj::Corner& corner) {
+    int64_t index;
+    if(!parse_int(p, end, index) || index == 0) { return false; }
+    corner.position = resolve_index(index, defined.positions);
+    corner.uv = 0;
+    corner.normal = 0;
+    if(p < end && *p == '/') {
+        p++;
+        if(p < end && *p != '/') {
+            if(!parse_int(p, end, index) || index == 0) { return false; }
+            corner.uv = resolve_index(index, defined.uvs);
+        }
+        if(p < end && *p == '/') {
+            p++;
+            if(!parse_int(p, end, index) || index == 0) { return false; }
+            corner.normal = resolve_index(index, defined.normals);
+        }
+    }
+    // Corners must be separated by whitespace
+    return p >= end || is_space(*p) || is_eol(*p);
+}
+
+/*!
+ *  Parse a chunk.
+ *
+ *  Output is written directly into the model at the offsets determined by
+ *  the pre-scan.
+ */
+static void parse_chunk(Chunk& chunk, obj::Model& model) {
+    // Running totals, used for resolving relative indices
+    ChunkCounts defined = chunk.offsets;
+    std::vector<obj::Corner> polygon;
+    const char* p = chunk.begin;
+    const char* end = chunk.end;
+    while(p < end) {
+        const char* line = p;
+        switch(identify(p, end)) {
+            case Statement::POSITION: {
+                glm::vec3& position = model.positions[defined.positions++];
+                for(int i = 0; i < 3; i++) {
+                    skip_space(p, end);
+                    if(!parse_float(p, end, position[i])) {
+                        chunk.error = line;
+                        chunk.error_desc = "Invalid vertex position";
+                        return;
+                    }
+                }
+                break;
+            }
+            case Statement::UV: {
+                glm::vec2& uv = model.uvs[defined.uvs++];
+                skip_space(p, end);
+                if(!parse_float(p, end, uv.x)) {
+                    chunk.error = line;
+                    chunk.error_desc = "Invalid texture coordinate";
+                    return;
+                }
+                // The second coordinate is optional
+                skip_space(p, end);
+                if(!parse_float(p, end, uv.y)) {
+                    uv.y = 0.0;
+                }
+                break;
+            }
+            case Statement::NORMAL: {
+                glm::vec3& normal = model.normals[defined.normals++];
+                for(int i = 0; i < 3; i++) {
+                    skip_space(p, end);
+                    if(!parse_float(p, end, normal[i])) {
+                        chunk.error = line;
+                        chunk.error_desc = "Invalid vertex normal";
+                        return;
+                    }
+                }
+                break;
+            }
+            case Statement::FACE: {
+                polygon.clear();
+                while(true) {
+                    skip_space(p, end);
+                    if(p >= end || is_eol(*p)) { break; }
+                    obj::Corner corner;
+                    if(!parse_corner(p, end, defined, corner)) {
+                        chunk.error = line;
+                        chunk.error_desc = "Invalid face corner";
+                        return;
+                    }
+                    polygon.push_back(corner);
+                }
+                if(polygon.size() < 3) {
+                    chunk.error = line;
+                    chunk.error_desc = "Face has fewer than three corners";
+                    return;
+                }
+                // Triangulate as a fan
+                for(size_t i = 2; i < polygon.size(); i++) {
+                    model.corners[defined.corners++] = polygon[0];
+                    model.corners[defined.corners++] = polygon[i - 1];
+                    model.corners[defined.corners++] = polygon[i];
+                }
+                break;
+            }
+            default: break;
+        }
+        skip_line(p, end);
+    }
+}
+
+bool se::graphics::obj::parse(const char* data, size_t size, Model& model,
+    se::util::ThreadPool* pool, const char* name) {
+
+    // Split the input into chunks on line boundaries
+    size_t chunk_count = 1;
+    if(pool != nullptr) {
+        size_t max_chunks = pool->get_thread_count() * OBJ_CHUNKS_PER_THREAD + 1;
+        chunk_count = std::max<size_t>(1, std::min(max_chunks, size / OBJ_MIN_CHUNK_SIZE));
+    }
+    std::vector<Chunk> chunks;
+    const char* end = data + size;
+    const char* begin = data;
+    for(size_t i = 1; i <= chunk_count && begin < end; i++) {
+        const char* chunk_end = i == chunk_count ? end : data + (size / chunk_count) * i;
+        if(chunk_end < begin) { chunk_end = begin; }
+        skip_line(chunk_end, end);
+        Chunk chunk;
+        chunk.begin = begin;
+        chunk.end = chunk_end;
+        chunks.push_back(chunk);
+        begin = chunk_end;
+    }
+
+    // Count everything and allocate the output
+    auto scan_one = [&chunks](size_t i){ scan_chunk(chunks[i]); };
+    if(pool != nullptr) {
+        pool->parallel_for(chunks.size(), scan_one);
+    } else {
+        for(size_t i = 0; i < chunks.size(); i++) { scan_one(i); }
+    }
+    ChunkCounts totals;
+    for(auto& chunk : chunks) {
+        chunk.offsets = totals;
+        totals.positions += chunk.counts.positions;
+        totals.uvs += chunk.counts.uvs;
+        totals.normals += chunk.counts.normals;
+        totals.corners += chunk.counts.corners;
+    }
+    model.positions.resize(totals.positions);
+    model.uvs.resize(totals.uvs);
+    model.normals.resize(totals.normals);
+    model.corners.resize(totals.corners);
+
+    // Parse everything in place
+    auto parse_one = [&chunks, &model](size_t i){ parse_chunk(chunks[i], model); };
+    if(pool != nullptr) {
+        pool->parallel_for(chunks.size(), parse_one);
+    } else {
+        for(size_t i = 0; i < chunks.size(); i++) { parse_one(i); }
+    }
+
+    for(auto& chunk : chunks) {
+        if(chunk.error != nullptr) {
+            size_t line_number = std::count(data, chunk.error, '\n') + 1;
+            ERROR("[%s] %s on line %lu", name, chunk.error_desc, line_number);
+            return false;
+        }
+    }
+    DEBUG("[%s] Parsed %lu positions, %lu uvs, %lu normals, %lu triangles in %lu chunks",
+        name, totals.positions, totals.uvs, totals.normals, totals.corners / 3,
+        chunks.size());
+    return true;
+}
+
+// ===============
+// == BENCHMARK ==
+// ===============
+
+/// Plain `fscanf()` reader, kept as the benchmark baseline
+static bool parse_scanf(const char* fname, obj::Model& model) {
+    FILE* fp = fopen(fname, "r");
+    if(fp == nullptr) {
+        return false;
+    }
+    model = obj::Model();
+    char line_header[128];
+    while(fscanf(fp, "%127s", line_header) != EOF) {
+        if(strcmp(line_header, "v") == 0) {
+            glm::vec3 position;
+            fscanf(fp, "%f %f %f\n", &position.x, &position.y, &position.z);
+            model.positions.push_back(position);
+        } else if(strcmp(line_header, "vt") == 0) {
+            glm::vec2 uv;
+            fscanf(fp, "%f %f\n", &uv.x, &uv.y);
+            model.uvs.push_back(uv);
+        } else if(strcmp(line_header, "vn") == 0) {
+            glm::vec3 normal;
+            fscanf(fp, "%f %f %f\n", &normal.x, &normal.y, &normal.z);
+            model.normals.push_back(normal);
+        } else if(strcmp(line_header, "f") == 0) {
+            obj::Corner face[3];
+            int matches = fscanf(fp, "%u/%u/%u %u/%u/%u %u/%u/%u\n",
+                &face[0].position, &face[0].uv, &face[0].normal,
+                &face[1].position, &face[1].uv, &face[1].normal,
+                &face[2].position, &face[2].uv, &face[2].normal);
+            if(matches != 9) {
+                fclose(fp);
+                return false;
+            }
+            model.corners.insert(model.corners.end(), face, face + 3);
+        }
+    }
+    fclose(fp);
+    return true;
+}
+
+/// Check that two models are identical
+static bool models_match(const obj::Model& a, const obj::Model& b) {
+    if(a.positions != b.positions || a.uvs != b.uvs || a.normals != b.normals ||
+        a.corners.size() != b.corners.size()) {
+        return false;
+    }
+    for(size_t i = 0; i < a.corners.size(); i++) {
+        if(a.corners[i].position != b.corners[i].position ||
+            a.corners[i].uv != b.corners[i].uv ||
+            a.corners[i].normal != b.corners[i].normal) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void se::graphics::obj::benchmark(const char* fname, se::util::ThreadPool* pool) {
+    auto now = [](){ return std::chrono::steady_clock::now(); };
+    auto elapsed_ms = [](auto start, auto end) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1000000.0;
+    };
+    // Fastest of three runs, or a negative time if the reader failed
+    auto time_reader = [&now, &elapsed_ms](const std::function<bool(void)>& reader) {
+        double best = -1.0;
+        for(int i = 0; i < 3; i++) {
+            auto start = now();
+            if(!reader()) {
+                return -1.0;
+            }
+            double time = elapsed_ms(start, now());
+            if(best < 0.0 || time < best) {
+                best = time;
+            }
+        }
+        return best;
+    };
+
+    Model reference;
+    Model single;
+    Model parallel;
+    size_t size = 0;
+    double scanf_time = time_reader([fname, &reference](){
+        return parse_scanf(fname, reference); });
+    double single_time = time_reader([fname, &single, &size](){
+        se::util::MappedFile file(fname);
+        size = file.get_size();
+        return file.is_valid() && parse((const char*) file.get_data(),
+            file.get_size(), single, nullptr, fname);
+    });
+    double parallel_time = time_reader([fname, &parallel, pool](){
+        se::util::MappedFile file(fname);
+        return file.is_valid() && parse((const char*) file.get_data(),
+            file.get_size(), parallel, pool, fname);
+    });
+
+    double mib = size / (1024.0 * 1024.0);
+    INFO("OBJ parser benchmark [%s] (%.1f MiB, %lu triangles)", fname, mib,
+        single.corners.size() / 3);
+    auto report = [mib](const char* label, double time) {
+        if(time < 0.0) {
+            INFO("  %s: failed", label);
+        } else {
+            INFO("  %s: %.3fms (%.1f MiB/s)", label, time, mib / (time / 1000.0));
+        }
+    };
+    report("fscanf", scanf_time);
+    report("parse (1 thread)", single_time);
+    report("parse (thread pool)", parallel_time);
+    if(scanf_time >= 0.0 && single_time >= 0.0 && !models_match(reference, single)) {
+        WARN("  Parsed model differs from the fscanf reader");
+    }
+    if(single_time >= 0.0 && parallel_time >= 0.0 && !models_match(single, parallel)) {
+        WARN("  Parallel parse differs from the single threaded parse");
+    }
+}
+
+void se::graphics::obj::benchmark_synthetic(size_t triangle_count, se::util::ThreadPool* pool) {
+    std::string folder = se::util::dirs::temp_data();
+    se::util::dirs::create_directories(folder);
+    std::string fname = folder + "/obj_benchmark.obj";
+    FILE* fp = fopen(fname.c_str(), "w");
+    if(fp == nullptr) {
+        ERROR("Failed to create benchmark model [%s] [%i: %s]", fname.c_str(),
+            errno, strerror(errno));
+        return;
+    }
+
+    // A square grid, two triangles per cell
+    size_t cells = (size_t) std::ceil(std::sqrt(triangle_count / 2.0));
+    size_t side = cells + 1;
+    for(size_t y = 0; y < side; y++) {
+        for(size_t x = 0; x < side; x++) {
+            fprintf(fp, "v %f %f %f\n", (float) x / cells, (float) y / cells,
+                std::sin(x * 0.1f) * std::cos(y * 0.1f));
+        }
+    }
+    for(size_t y = 0; y < side; y++) {
+        for(size_t x = 0; x < side; x++) {
+            fprintf(fp, "vt %f %f\n", (float) x / cells, (float) y / cells);
+        }
+    }
+    fprintf(fp, "vn 0.000000 0.000000 1.000000\n");
+    for(size_t y = 0; y < cells; y++) {
+        for(size_t x = 0; x < cells; x++) {
+            size_t a = y * side + x + 1;
+            size_t b = a + 1;
+            size_t c = a + side;
+            size_t d = c + 1;
+            fprintf(fp, "f %lu/%lu/1 %lu/%lu/1 %lu/%lu/1\n", a, a, b, b, d, d);
+            fprintf(fp, "f %lu/%lu/1 %lu/%lu/1 %lu/%lu/1\n", a, a, d, d, c, c);
+        }
+    }
+    fclose(fp);
+
+    benchmark(fname.c_str(), pool);
+    remove(fname.c_str());
+}
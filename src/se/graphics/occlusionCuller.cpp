@@ -0,0 +1,258 @@
+/*!
+ *  @file src/se/graphics/occlusionCuller.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/graphics/occlusionCuller.hpp"
+
+#include "se/entity.hpp"
+#include "se/graphics/commandList.hpp"
+#include "se/graphics/glState.hpp"
+#include "se/graphics/shader.hpp"
+#include "se/graphics/shaderProgram.hpp"
+
+#include "se/util/log.hpp"
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+using namespace se::graphics;
+
+/// Visible entities are only queried once every this many frames
+#define VISIBLE_QUERY_INTERVAL 4
+/// Entities which have not been seen for this many frames are forgotten
+#define STATE_EXPIRY_FRAMES 300
+/// Ratio of a bounding cube's corner distance to its half size
+#define CUBE_CORNER_RATIO 1.7320508
+
+// =====================
+// == PRIVATE METHODS ==
+// =====================
+
+void OcclusionCuller::init() {
+    static const GLfloat box_vertex_data[] = {
+        -1.0, -1.0, -1.0,
+         1.0, -1.0, -1.0,
+        -1.0,  1.0, -1.0,
+         1.0,  1.0, -1.0,
+        -1.0, -1.0,  1.0,
+         1.0, -1.0,  1.0,
+        -1.0,  1.0,  1.0,
+         1.0,  1.0,  1.0,
+    };
+    static const GLubyte box_index_data[] = {
+        0, 2, 1,  1, 2, 3,
+        4, 5, 6,  5, 7, 6,
+        0, 1, 4,  1, 5, 4,
+        2, 6, 3,  3, 6, 7,
+        0, 4, 2,  2, 4, 6,
+        1, 3, 5,  3, 7, 5,
+    };
+    glGenVertexArrays(1, &this->gl_box_vertex_array_id);
+    GLState::bind_vertex_array(this->gl_box_vertex_array_id);
+    glGenBuffers(1, &this->gl_box_vertex_buffer_id);
+    GLState::bind_buffer(GL_ARRAY_BUFFER, this->gl_box_vertex_buffer_id);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(box_vertex_data), box_vertex_data, GL_STATIC_DRAW);
+    glVertexAttribPointer(SE_SHADER_LOC_IN_VERT, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(SE_SHADER_LOC_IN_VERT);
+    glGenBuffers(1, &this->gl_box_index_buffer_id);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->gl_box_index_buffer_id);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(box_index_data), box_index_data, GL_STATIC_DRAW);
+    GLState::bind_vertex_array(0);
+
+    /* Conservative queries may report false positives, but never false
+    negatives, and are cheaper on most hardware. */
+    if(GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility) {
+        this->gl_query_target = GL_ANY_SAMPLES_PASSED_CONSERVATIVE;
+    } else {
+        WARN("Conservative occlusion queries not supported");
+        this->gl_query_target = GL_ANY_SAMPLES_PASSED;
+    }
+}
+
+void OcclusionCuller::poll(OcclusionState& state) {
+    GLuint available = 0;
+    glGetQueryObjectuiv(state.gl_query_id, GL_QUERY_RESULT_AVAILABLE, &available);
+    if(!available) {
+        return;
+    }
+    GLuint samples = 0;
+    glGetQueryObjectuiv(state.gl_query_id, GL_QUERY_RESULT, &samples);
+    state.pending = false;
+    state.visible = samples != 0;
+    if(!state.visible && state.conditional) {
+        this->stat_draws_saved++;
+    }
+    state.conditional = false;
+}
+
+// ====================
+// == PUBLIC METHODS ==
+// ====================
+
+OcclusionCuller::OcclusionCuller(se::Engine* engine) {
+    this->engine = engine;
+    this->box_program = ShaderProgram::get_program(
+        engine, "occlusion_box", "", "occlusion_box", "");
+    this->box_program->increment_resource_user_counter();
+}
+
+OcclusionCuller::~OcclusionCuller() {
+    /* Query objects and the box buffers are not deleted here, because the
+    culler may be destroyed outside of the graphics thread.  They go with the
+    context. */
+    this->box_program->decrement_resource_user_counter();
+    if(this->frame == 0) {
+        WARN("No frames occlusion culled - skipping occlusion benchmarks");
+    } else {
+        double frames = this->frame;
+        INFO("Entities occluded per frame: %.2f", this->stat_occluded_count / frames);
+        INFO("Occlusion queries per frame: %.2f", this->stat_query_count / frames);
+        INFO("Draws discarded by conditional rendering per frame: %.2f",
+            this->stat_draws_saved / frames);
+        INFO("Occlusion results not ready in time per frame: %.2f",
+            this->stat_late_results / frames);
+    }
+}
+
+void OcclusionCuller::begin_frame(const RenderSnapshot& snapshot,
+    const std::vector<uint8_t>& item_visible) {
+    if(this->gl_box_vertex_array_id == 0) {
+        this->init();
+    }
+    this->frame++;
+
+    // Forget entities which haven't been seen in a while
+    if(this->frame % STATE_EXPIRY_FRAMES == 0) {
+        for(auto it = this->states.begin(); it != this->states.end();) {
+            if(it->second.last_frame + STATE_EXPIRY_FRAMES < this->frame) {
+                if(it->second.gl_query_id != 0) {
+                    glDeleteQueries(1, &it->second.gl_query_id);
+                }
+                it = this->states.erase(it);
+            } else {
+                it++;
+            }
+        }
+    }
+
+    size_t item_count = snapshot.items.size();
+    this->item_deferred.assign(item_count, 0);
+    this->query_items.clear();
+    this->frame_occluded_count = 0;
+    for(size_t i = 0; i < item_count; i++) {
+        const RenderSnapshotItem& item = snapshot.items[i];
+        if(!item_visible[i] || !item.bounded) {
+            continue;
+        }
+        /* The faces of a box surrounding the camera (or clipped by the near
+        plane) would be culled or clipped, so it can't be tested. */
+        glm::vec3 delta = item.bounds_center - snapshot.camera_position;
+        float reach = item.bounds_radius * CUBE_CORNER_RATIO + snapshot.camera_near;
+        if(delta.x*delta.x + delta.y*delta.y + delta.z*delta.z < reach * reach) {
+            continue;
+        }
+
+        OcclusionState& state = this->states[item.entity];
+        state.last_frame = this->frame;
+        if(state.pending) {
+            this->poll(state);
+        }
+        if(state.visible) {
+            // Re-test visible entities occasionally, staggered across frames
+            if(!state.pending && (state.gl_query_id == 0 ||
+                (this->frame + state.gl_query_id) % VISIBLE_QUERY_INTERVAL == 0)) {
+                this->query_items.push_back(i);
+            }
+        } else {
+            this->item_deferred[i] = 1;
+            this->frame_occluded_count++;
+            if(state.pending) {
+                // Conditional rendering falls back to the last query
+                this->stat_late_results++;
+            } else {
+                this->query_items.push_back(i);
+            }
+        }
+    }
+    this->stat_occluded_count += this->frame_occluded_count;
+}
+
+bool OcclusionCuller::is_deferred(uint32_t index) {
+    return this->item_deferred[index];
+}
+
+void OcclusionCuller::issue_queries(const RenderSnapshot& snapshot) {
+    this->frame_query_count = 0;
+    if(this->query_items.size() == 0 ||
+        this->box_program->get_resource_state() != se::util::LoadableResourceState::LOADED) {
+        return;
+    }
+
+    this->box_program->use_program();
+    GLState::color_mask(false);
+    GLState::depth_mask(false);
+    GLState::bind_vertex_array(this->gl_box_vertex_array_id);
+    for(uint32_t index : this->query_items) {
+        const RenderSnapshotItem& item = snapshot.items[index];
+        OcclusionState& state = this->states[item.entity];
+        if(state.gl_query_id == 0) {
+            glGenQueries(1, &state.gl_query_id);
+        }
+        // Scale and translate the unit box onto the bounding sphere
+        glm::mat4 box_matrix(item.bounds_radius);
+        box_matrix[3] = glm::vec4(item.bounds_center, 1.0);
+        glm::mat4 mvp = snapshot.camera_matrix * box_matrix;
+        glUniformMatrix4fv(SE_SHADER_LOC_IN_MVP, 1, GL_FALSE, &mvp[0][0]);
+        glBeginQuery(this->gl_query_target, state.gl_query_id);
+        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, 0);
+        glEndQuery(this->gl_query_target);
+        state.pending = true;
+        state.conditional = false;
+    }
+    GLState::depth_mask(true);
+    GLState::color_mask(true);
+
+    this->frame_query_count = this->query_items.size();
+    this->stat_query_count += this->frame_query_count;
+}
+
+void OcclusionCuller::draw_deferred(const RenderSnapshot& snapshot,
+    const std::vector<RenderQueueItem>& items) {
+    if(this->frame_occluded_count == 0) {
+        return;
+    }
+    for(auto& queued : items) {
+        if(!this->item_deferred[queued.index]) {
+            continue;
+        }
+        const RenderSnapshotItem& item = snapshot.items[queued.index];
+        OcclusionState& state = this->states[item.entity];
+        DrawCommand command = item.command;
+        command.index = queued.index;
+        if(!state.pending) {
+            // No query was issued (the box program isn't loaded yet)
+            CommandList::execute(snapshot, command, nullptr);
+            continue;
+        }
+        /* If the result isn't available by the time the GPU gets here the
+        entity is drawn anyway, the GPU never stalls either. */
+        glBeginConditionalRender(state.gl_query_id, GL_QUERY_NO_WAIT);
+        CommandList::execute(snapshot, command, nullptr);
+        glEndConditionalRender();
+        state.conditional = true;
+    }
+    // Everything drawn after this expects depth writes
+    GLState::depth_mask(true);
+}
+
+uint32_t OcclusionCuller::get_frame_occluded_count() {
+    return this->frame_occluded_count;
+}
+
+uint32_t OcclusionCuller::get_frame_query_count() {
+    return this->frame_query_count;
+}
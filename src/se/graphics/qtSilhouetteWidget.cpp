@@ -9,6 +9,7 @@
 #ifdef SE_ENABLE_QT_WIDGET_SUPPORT
 
 #include "se/engine.hpp"
+#include "se/graphics/glState.hpp"
 #include "se/graphics/graphicsController.hpp"
 #include "se/graphics/qtSilhouetteWidget.hpp"
 
@@ -69,6 +70,8 @@ void QTSilhouetteWidget::paintGL() {
     this->engine->config->set(
         "internal.gl.outputfbid", (int) this->defaultFramebufferObject(),
         false, OUTPUT_FBID_PASSKEY);
+    // Qt binds its own framebuffer (and possibly more) before painting
+    GLState::invalidate();
     this->engine->graphics_controller->do_frame();
 
     // Check for pending tasks and initiate refresh
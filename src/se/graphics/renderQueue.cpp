@@ -0,0 +1,177 @@
+/*!
+ *  @file src/se/graphics/renderQueue.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/graphics/renderQueue.hpp"
+
+#include "se/util/log.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+using namespace se::graphics;
+
+// Key layout
+#define KEY_LAYER_SHIFT 60
+#define KEY_PROGRAM_SHIFT 48
+#define KEY_PROGRAM_MASK 0xFFF
+#define KEY_TEXTURE_SHIFT 32
+#define KEY_TEXTURE_MASK 0xFFFF
+#define KEY_GEOMETRY_SHIFT 16
+#define KEY_GEOMETRY_MASK 0xFFFF
+#define KEY_DEPTH_MASK 0xFFFF
+
+// Radix sort digit size
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+#define RADIX_PASSES (64 / RADIX_BITS)
+
+// =====================
+// == PRIVATE METHODS ==
+// =====================
+
+uint32_t RenderQueue::resource_id(const void* resource) {
+    if(resource == nullptr) {
+        return 0;
+    }
+    auto it = this->resource_ids.find(resource);
+    if(it != this->resource_ids.end()) {
+        return it->second;
+    }
+    uint32_t id = this->resource_ids.size() + 1;
+    this->resource_ids[resource] = id;
+    return id;
+}
+
+void RenderQueue::count_changes(uint32_t& programs, uint32_t& textures,
+    uint32_t& geometries) {
+    programs = 0;
+    textures = 0;
+    geometries = 0;
+    for(size_t i = 1; i < this->items.size(); i++) {
+        uint64_t a = this->items[i - 1].key;
+        uint64_t b = this->items[i].key;
+        if(((a >> KEY_PROGRAM_SHIFT) & KEY_PROGRAM_MASK) != ((b >> KEY_PROGRAM_SHIFT) & KEY_PROGRAM_MASK)) {
+            programs++;
+        }
+        if(((a >> KEY_TEXTURE_SHIFT) & KEY_TEXTURE_MASK) != ((b >> KEY_TEXTURE_SHIFT) & KEY_TEXTURE_MASK)) {
+            textures++;
+        }
+        if(((a >> KEY_GEOMETRY_SHIFT) & KEY_GEOMETRY_MASK) != ((b >> KEY_GEOMETRY_SHIFT) & KEY_GEOMETRY_MASK)) {
+            geometries++;
+        }
+    }
+}
+
+// ====================
+// == PUBLIC METHODS ==
+// ====================
+
+RenderQueue::~RenderQueue() {
+    if(this->stat_frame_count == 0) {
+        WARN("No frames were queued - skipping render queue benchmarks");
+    } else {
+        double frames = this->stat_frame_count;
+        INFO("Render queue program changes saved per frame: %.2f",
+            this->stat_program_changes_saved / frames);
+        INFO("Render queue texture changes saved per frame: %.2f",
+            this->stat_texture_changes_saved / frames);
+        INFO("Render queue geometry changes saved per frame: %.2f",
+            this->stat_geometry_changes_saved / frames);
+        INFO("Render queue average sort time: %.3fms",
+            this->stat_sort_time / frames / 1000000.0);
+    }
+}
+
+void RenderQueue::clear() {
+    this->items.clear();
+}
+
+void RenderQueue::push(uint32_t index, const RenderState& state, float depth) {
+    if(depth < 0.0) {
+        depth = 0.0;
+    } else if(depth > 1.0) {
+        depth = 1.0;
+    }
+    uint64_t key = 0;
+    key |= (uint64_t) state.layer << KEY_LAYER_SHIFT;
+    key |= (uint64_t) (this->resource_id(state.program) & KEY_PROGRAM_MASK) << KEY_PROGRAM_SHIFT;
+    key |= (uint64_t) (this->resource_id(state.texture) & KEY_TEXTURE_MASK) << KEY_TEXTURE_SHIFT;
+    key |= (uint64_t) (this->resource_id(state.geometry) & KEY_GEOMETRY_MASK) << KEY_GEOMETRY_SHIFT;
+    key |= (uint64_t) (depth * KEY_DEPTH_MASK);
+    this->items.push_back({key, index});
+}
+
+void RenderQueue::sort() {
+    auto sort_start = std::chrono::steady_clock::now();
+
+    RenderQueueStats& stats = this->frame_stats;
+    stats.item_count = this->items.size();
+    this->count_changes(stats.unsorted_program_changes,
+        stats.unsorted_texture_changes, stats.unsorted_geometry_changes);
+
+    size_t count = this->items.size();
+    if(count > 1) {
+        // Build the histograms for every digit in a single pass
+        uint32_t histograms[RADIX_PASSES][RADIX_SIZE];
+        memset(histograms, 0, sizeof(histograms));
+        for(size_t i = 0; i < count; i++) {
+            uint64_t key = this->items[i].key;
+            for(int pass = 0; pass < RADIX_PASSES; pass++) {
+                histograms[pass][(key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)]++;
+            }
+        }
+
+        this->scratch.resize(count);
+        RenderQueueItem* src = this->items.data();
+        RenderQueueItem* dst = this->scratch.data();
+        for(int pass = 0; pass < RADIX_PASSES; pass++) {
+            uint32_t* histogram = histograms[pass];
+            int shift = pass * RADIX_BITS;
+            /* Skip digits which are the same for every item.  Most of the
+            layer and program bits usually are. */
+            if(histogram[(src[0].key >> shift) & (RADIX_SIZE - 1)] == count) {
+                continue;
+            }
+            uint32_t offset = 0;
+            for(int digit = 0; digit < RADIX_SIZE; digit++) {
+                uint32_t digit_count = histogram[digit];
+                histogram[digit] = offset;
+                offset += digit_count;
+            }
+            for(size_t i = 0; i < count; i++) {
+                dst[histogram[(src[i].key >> shift) & (RADIX_SIZE - 1)]++] = src[i];
+            }
+            std::swap(src, dst);
+        }
+        if(src != this->items.data()) {
+            this->items.swap(this->scratch);
+        }
+    }
+
+    this->count_changes(stats.program_changes, stats.texture_changes,
+        stats.geometry_changes);
+
+    this->stat_frame_count++;
+    this->stat_program_changes_saved +=
+        (int64_t) stats.unsorted_program_changes - stats.program_changes;
+    this->stat_texture_changes_saved +=
+        (int64_t) stats.unsorted_texture_changes - stats.texture_changes;
+    this->stat_geometry_changes_saved +=
+        (int64_t) stats.unsorted_geometry_changes - stats.geometry_changes;
+    this->stat_sort_time += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - sort_start).count();
+}
+
+const std::vector<RenderQueueItem>& RenderQueue::get_items() {
+    return this->items;
+}
+
+RenderQueueStats RenderQueue::get_frame_stats() {
+    return this->frame_stats;
+}
@@ -10,6 +10,7 @@
 
 #include "se/engine.hpp"
 #include "se/graphics/framebuffer.hpp"
+#include "se/graphics/glState.hpp"
 #include "se/graphics/graphicsController.hpp"
 #include "se/graphics/shaderProgram.hpp"
 #include "se/graphics/shader.hpp"
@@ -36,9 +37,9 @@ void Screen::init() {
          1.0,  1.0, 0.0, 
     };
     glGenVertexArrays(1, &this->gl_screen_vert_array_id);
-    glBindVertexArray(this->gl_screen_vert_array_id);
+    GLState::bind_vertex_array(this->gl_screen_vert_array_id);
     glGenBuffers(1, &this->gl_screen_vert_buffer_id);
-    glBindBuffer(GL_ARRAY_BUFFER, this->gl_screen_vert_buffer_id);
+    GLState::bind_buffer(GL_ARRAY_BUFFER, this->gl_screen_vert_buffer_id);
     glBufferData(GL_ARRAY_BUFFER, sizeof(screen_vertex_data), screen_vertex_data, GL_STATIC_DRAW);
     glVertexAttribPointer(SE_SHADER_LOC_IN_VERT, 3, GL_FLOAT, GL_FALSE, 0, 0);
     glEnableVertexAttribArray(SE_SHADER_LOC_IN_VERT);
@@ -49,8 +50,8 @@ void Screen::init() {
 
 void Screen::deinit() {
     this->ready = false;
-    glDeleteVertexArrays(1, &this->gl_screen_vert_array_id);
-    glDeleteBuffers(1, &this->gl_screen_vert_buffer_id);
+    GLState::delete_vertex_arrays(1, &this->gl_screen_vert_array_id);
+    GLState::delete_buffers(1, &this->gl_screen_vert_buffer_id);
 }
 
 void Screen::reconfigure_textures() {
@@ -69,8 +70,11 @@ void Screen::reconfigure_textures() {
     this->post_color_tex->options.dimx = *this->dimx;
     this->post_color_tex->options.dimy = *this->dimy;
 
-    this->primarybuffer->re_init();
-    this->postprocessbuffer->re_init();
+    // Framebuffers created after this point pick up the new dimensions
+    if(this->primarybuffer != nullptr && this->postprocessbuffer != nullptr) {
+        this->primarybuffer->re_init();
+        this->postprocessbuffer->re_init();
+    }
 }
 
 // ===================
@@ -88,9 +92,6 @@ Screen::Screen(se::Engine* engine) {
     this->post_process_program = ShaderProgram::get_program(
         engine, "screen", "", "screen_post", "");
     this->post_process_program->increment_resource_user_counter();
-    this->engine->graphics_controller->submit_graphics_task([this](){
-        this->init();
-    });
     // Get pointers
     this->dimx = engine->config->get_intp("window.dimx");
     this->dimy = engine->config->get_intp("window.dimy");
@@ -119,15 +120,19 @@ Screen::Screen(se::Engine* engine) {
     this->post_color_tex->options.type = GL_TEXTURE_2D;
     this->post_color_tex->options.gl_tex_wrap_s = GL_CLAMP_TO_EDGE;
     this->post_color_tex->options.gl_tex_wrap_t = GL_CLAMP_TO_EDGE;
-    // Create framebuffers
+    // Create framebuffers, which can't be allocated until `init()` has set
+    // the texture dimensions
+    GraphicsTaskHandle init_handle = engine->graphics_controller->submit_graphics_task([this](){
+        this->init();
+    });
     std::vector<Texture*> primary_textures;
     primary_textures.push_back(this->primary_color_tex);
     primary_textures.push_back(this->primary_bg_tex);
     primary_textures.push_back(this->primary_depth_tex);
-    this->primarybuffer = new Framebuffer(engine, primary_textures);
+    this->primarybuffer = new Framebuffer(engine, primary_textures, {init_handle});
     std::vector<Texture*> post_textures;
     post_textures.push_back(this->post_color_tex);
-    this->postprocessbuffer = new Framebuffer(engine, post_textures);
+    this->postprocessbuffer = new Framebuffer(engine, post_textures, {init_handle});
 
     // Configure the resize and reconfiguration handlers
     auto handler = [this](se::util::ConfigurationValue* a,se::util::Configuration* b){
@@ -155,23 +160,18 @@ void Screen::render() {
     // First pass
     this->postprocessbuffer->use_as_target();
     this->screen_program->use_program();
-    glUniform1i(SE_SHADER_LOC_DIMX, *this->dimx);
-    glUniform1i(SE_SHADER_LOC_DIMY, *this->dimy);
-    glUniform1i(SE_SHADER_LOC_MSAA_LEVEL, *this->msaa);
-    //glUniform1f(SE_SHADER_LOC_CAM_NEAR, *this->cam_near);
-    //glUniform1f(SE_SHADER_LOC_CAM_FAR, *this->cam_far);
     this->primary_color_tex->use_texture(GL_TEXTURE0);
     this->primary_bg_tex->use_texture(GL_TEXTURE1);
     this->primary_depth_tex->use_texture(GL_TEXTURE2);
-    glBindVertexArray(this->gl_screen_vert_array_id);
-    glDisable(GL_DEPTH_TEST);
+    GLState::bind_vertex_array(this->gl_screen_vert_array_id);
+    GLState::set_enabled(GL_DEPTH_TEST, false);
     glDrawArrays(GL_TRIANGLES, 0, 6);
 
     // Second pass
-    glBindFramebuffer(GL_FRAMEBUFFER, *this->output_fbid);
+    GLState::bind_framebuffer(*this->output_fbid);
     this->post_process_program->use_program();
     this->post_color_tex->use_texture(GL_TEXTURE0);
-    glBindVertexArray(this->gl_screen_vert_array_id);
+    GLState::bind_vertex_array(this->gl_screen_vert_array_id);
     glDrawArrays(GL_TRIANGLES, 0, 6);
 
 }
\ No newline at end of file
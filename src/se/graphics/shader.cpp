@@ -18,7 +18,6 @@
 #include "se/util/log.hpp"
 
 #include <chrono>
-#include <thread>
 #include <SDL2/SDL.h>
 #include <GL/glew.h>
 #include <SDL2/SDL_opengl.h>
@@ -43,20 +42,38 @@ const char default_shader_defines[] =
     GLSL_DEF(LOC_IN_VERT)
     GLSL_DEF(LOC_IN_UV)
     GLSL_DEF(LOC_IN_NORM)
-    GLSL_DEF(LOC_CAM_NEAR)
-    GLSL_DEF(LOC_CAM_FAR)
-    GLSL_DEF(LOC_DIMX)
-    GLSL_DEF(LOC_DIMY)
-    GLSL_DEF(LOC_MSAA_LEVEL)
     GLSL_DEF(LOC_TEX_SCR_COLOR)
     GLSL_DEF(LOC_TEX_SCR_DEPTH)
     GLSL_DEF(LOC_TEX_SCR_BG)
+    GLSL_DEF(LOC_IN_POS_SCALE)
+    GLSL_DEF(LOC_IN_POS_OFFSET)
+    GLSL_DEF(LOC_IN_TEX_LAYER)
+    GLSL_DEF(LOC_IN_INSTANCE_MODEL)
+    GLSL_DEF(LOC_IN_INSTANCE_LAYER)
     GLSL_DEF(LOC_TEX_0)
     "#define LOC_TEX_(n) LOC_TEX_0 + n\n"
 
     GLSL_DEF(LOC_OUT_COLOR)
     GLSL_DEF(LOC_OUT_BG)
     GLSL_DEF(LOC_OUT_DEPTH)
+
+    /* Frame uniforms, shared by every program.  Must match
+    `se::graphics::FrameUniforms`. */
+    GLSL_DEF(BINDING_FRAME)
+    "layout(std140, binding = BINDING_FRAME) uniform SEFrameUniforms {\n"
+    "    mat4 view;\n"
+    "    mat4 projection;\n"
+    "    mat4 view_projection;\n"
+    "    mat4 inverse_view;\n"
+    "    mat4 inverse_projection;\n"
+    "    mat4 inverse_view_projection;\n"
+    "    vec4 viewport;\n"
+    "    vec4 camera_position;\n"
+    "    float time;\n"
+    "    float camera_near;\n"
+    "    float camera_far;\n"
+    "    int msaa_level;\n"
+    "} frame;\n"
 ;
 
 // ====================
@@ -113,6 +130,7 @@ Shader::Shader(se::Engine* engine, const char* name, GLuint type, const char* de
     } else {
         ERROR("[%s] Invalid or unsupported shader type [%u: %s]",
             name, type, se::util::string::gl_type_name(type));
+        this->state = ShaderState::ERROR;
         return;
     }
 
@@ -178,7 +196,7 @@ Shader::Shader(se::Engine* engine, const char* name, GLuint type, const char* de
 
     // Submit to the compilation queue
     std::function job = [this](){this->compile();};
-    this->engine->graphics_controller->submit_graphics_task(job);
+    this->compile_handle = this->engine->graphics_controller->submit_graphics_task(job);
 }
 
 Shader::~Shader() {
@@ -271,12 +289,16 @@ ShaderState Shader::get_state() {
 }
 
 ShaderState Shader::wait_for_loading() {
-    while(this->state == ShaderState::LOADING) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if(this->compile_handle != nullptr) {
+        this->compile_handle->wait();
     }
     return this->state;
 }
 
+GraphicsTaskHandle Shader::get_compile_handle() {
+    return this->compile_handle;
+}
+
 GLuint Shader::get_gl_id() {
     return this->gl_shader;
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "se/graphics/shaderProgram.hpp"
 
 #include "se/engine.hpp"
+#include "se/graphics/glState.hpp"
 #include "se/graphics/shader.hpp"
 #include "se/graphics/graphicsController.hpp"
 
@@ -17,7 +18,6 @@
 #include "se/util/debugstrings.hpp"
 
 #include <chrono>
-#include <thread>
 #include <SDL2/SDL.h>
 #include <GL/glew.h>
 #include <SDL2/SDL_opengl.h>
@@ -51,8 +51,6 @@ ShaderProgram* ShaderProgram::get_program(se::Engine* engine,
     return static_cast<ShaderProgram*>(resource);
 }
 
-thread_local unsigned int ShaderProgram::current_program = 0;
-
 // =====================
 // == PRIVATE METHODS ==
 // =====================
@@ -88,10 +86,12 @@ ShaderProgram::~ShaderProgram() {
 
 void ShaderProgram::link() {
 
-    ShaderState vstate = this->vshader->wait_for_loading();
-    ShaderState fstate = this->fshader->wait_for_loading();
+    /* This task depends on the compilation tasks of both shaders, so they are
+    guaranteed to have left the loading state by now. */
+    ShaderState vstate = this->vshader->get_state();
+    ShaderState fstate = this->fshader->get_state();
 
-    if(vstate == ShaderState::ERROR || fstate == ShaderState::ERROR) {
+    if(vstate != ShaderState::READY || fstate != ShaderState::READY) {
         ERROR("[%s] Child shader is in error state! [vert: %s frag: %s]",
             this->name.c_str(),
             shader_state_name(vstate),
@@ -147,7 +147,7 @@ void ShaderProgram::link() {
 }
 
 void ShaderProgram::unlink() {
-    glDeleteProgram(this->gl_program);
+    GLState::delete_program(this->gl_program);
 }
 
 // ====================
@@ -155,22 +155,20 @@ void ShaderProgram::unlink() {
 // ====================
 
 LoadableResourceState ShaderProgram::wait_for_loading() {
-    while(this->resource_state == LoadableResourceState::LOADING) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if(this->link_handle != nullptr) {
+        this->link_handle->wait();
     }
     return this->resource_state;
 }
 
+GraphicsTaskHandle ShaderProgram::get_link_handle() {
+    return this->link_handle;
+}
+
 void ShaderProgram::use_program() {
     if(this->resource_state != LoadableResourceState::LOADED) { return; }
-    /* Only update the current program if the current program is not already
-    the current program.  I'm not actually sure if this has any performance
-    benefit, but I don't thin it's going to have a significant performance
-    impact so I'm going to leave it in. */
-    if(this->current_program != this->gl_program) {
-        glUseProgram(this->gl_program);
-        this->current_program = this->gl_program;
-    }
+    // Consecutive entities using the same program don't switch programs
+    GLState::use_program(this->gl_program);
 }
 
 // =======================
@@ -187,9 +185,10 @@ void ShaderProgram::load_() {
     this->vshader = Shader::get_shader(engine, vsname, GL_VERTEX_SHADER, vdefines);
     this->fshader = Shader::get_shader(engine, fsname, GL_FRAGMENT_SHADER, fdefines);
 
-    // Submit to the linking queue
+    // Submit to the linking queue once both shaders have been compiled
     std::function job = [this](){this->link();};
-    this->engine->graphics_controller->submit_graphics_task(job);
+    this->link_handle = this->engine->graphics_controller->submit_graphics_task(
+        job, {this->vshader->get_compile_handle(), this->fshader->get_compile_handle()});
 
 }
 
@@ -8,112 +8,248 @@
 
 #include "se/graphics/simpleRenderManager.hpp"
 
+#include "se/componentStore.hpp"
 #include "se/entity/camera.hpp"
+#include "se/engine.hpp"
 #include "se/scene.hpp"
+#include "se/logic/logicController.hpp"
+#include "se/graphics/frameUniforms.hpp"
+#include "se/graphics/geometry.hpp"
+#include "se/graphics/glState.hpp"
+#include "se/graphics/instancedRenderer.hpp"
+#include "se/graphics/occlusionCuller.hpp"
 #include "se/graphics/screen.hpp"
 
+#include "se/util/config.hpp"
+#include "se/util/frustum.hpp"
 #include "se/util/log.hpp"
+#include "se/util/threadPool.hpp"
 
 #include <SDL2/SDL.h>
 #include <GL/glew.h>
 #include <SDL2/SDL_opengl.h>
 #include <GL/glu.h>
 #include <algorithm>
+#include <chrono>
+#include <glm/matrix.hpp>
 #include <math.h>
 
 using namespace se::graphics;
 
+/// Software occlusion depth buffer width
+#define SOFTWARE_OCCLUSION_WIDTH 256
+/// Software occlusion depth buffer height
+#define SOFTWARE_OCCLUSION_HEIGHT 128
+/// Minimum number of items recorded into each command list
+#define MIN_COMMAND_LIST_ITEMS 128
+
 // =====================
 // == PRIVATE MEMBERS ==
 // =====================
 
-void SimpleRenderManager::support_thread_main() {
-
-    se::util::log::set_thread_name("SRMSUP");
-    INFO("Hello from the simple render manager support thread");
-
-    // Variables for sorting benchmarking
-    uint64_t bm_sort_total_time = 0;
-    uint32_t bm_sort_total_count = 0;
-    uint64_t bm_sort_total_entity_count = 0;
+void SimpleRenderManager::publish_snapshot() {
+    se::Scene* scene = this->active_scene;
+    se::entity::Camera* camera = this->active_camera;
+    RenderSnapshot& snapshot = this->snapshots.get_back();
+    snapshot.sequence = ++this->snapshot_sequence;
+    snapshot.camera_view = camera->get_view_matrix();
+    snapshot.camera_projection = camera->get_projection_matrix();
+    snapshot.camera_matrix = snapshot.camera_projection * snapshot.camera_view;
+    snapshot.camera_position = camera->get_position();
+    snapshot.camera_near = *camera->near;
+    snapshot.camera_far = *camera->far;
+    snapshot.camera_pixel_scale = *this->window_height / (2.0 * tan(*camera->fov / 2.0));
+    snapshot.items.clear();
+    se::ComponentStore* components = scene->get_components();
+    if(components != nullptr) {
+        // Walk the dense arrays rather than the entity list
+        std::lock_guard<std::recursive_mutex> lock(components->get_mutex());
+        components->update_transforms();
+        se::Entity* const* entities = components->get_entities();
+        const glm::mat4* model_matrices = components->get_model_matrices();
+        const uint8_t* flags = components->get_flags();
+        size_t count = components->size();
+        for(size_t i = 0; i < count; i++) {
+            if(flags[i] & se::ComponentStore::RENDERABLE) {
+                this->snapshot_entity(snapshot, entities[i], model_matrices[i]);
+            }
+        }
+    } else {
+        for(auto entity : *scene->get_renderables()) {
+            this->snapshot_entity(snapshot, entity, entity->get_model_matrix());
+        }
+    }
+    this->snapshots.publish();
+}
 
-    while(this->run) {
+void SimpleRenderManager::snapshot_entity(RenderSnapshot& snapshot,
+    se::Entity* entity, const glm::mat4& model_matrix) {
+    RenderSnapshotItem item;
+    item.entity = entity;
+    item.model_matrix = model_matrix;
+    item.position = glm::vec3(model_matrix[3]);
+    entity->get_render_state(item.state);
+    item.bounded = entity->get_bounds(item.model_matrix, item.bounds_center,
+        item.bounds_radius);
+    item.occluder = entity->get_occluder(item.occluder_min, item.occluder_max);
+
+    /* The draw command is recorded here, while the entity is known to be
+    alive, so the render thread never has to read it.  Levels of detail are
+    chosen by the closest point of the bounds. */
+    glm::vec3 delta;
+    float distance;
+    if(item.bounded) {
+        delta = item.bounds_center - snapshot.camera_position;
+        distance = sqrt(delta.x*delta.x + delta.y*delta.y + delta.z*delta.z) -
+            item.bounds_radius;
+    } else {
+        delta = item.position - snapshot.camera_position;
+        distance = sqrt(delta.x*delta.x + delta.y*delta.y + delta.z*delta.z);
+    }
+    distance = std::max(distance, snapshot.camera_near);
+    entity->select_lod(item.model_matrix, snapshot.camera_pixel_scale / distance);
+    entity->record(item.model_matrix, item.command);
+    snapshot.items.push_back(item);
+}
 
-        // Debug code for calculating sort time
-        auto bm_sort_start = std::chrono::system_clock::now();
+void SimpleRenderManager::update_frame_uniforms(const RenderSnapshot& snapshot) {
+    FrameUniforms& uniforms = this->frame_uniforms;
+    uniforms.view = snapshot.camera_view;
+    uniforms.projection = snapshot.camera_projection;
+    uniforms.view_projection = snapshot.camera_matrix;
+    uniforms.inverse_view = glm::inverse(snapshot.camera_view);
+    uniforms.inverse_projection = glm::inverse(snapshot.camera_projection);
+    uniforms.inverse_view_projection = glm::inverse(snapshot.camera_matrix);
+    float width = *this->window_width;
+    float height = *this->window_height;
+    uniforms.viewport = glm::vec4(width, height, 1.0 / width, 1.0 / height);
+    uniforms.camera_position = glm::vec4(snapshot.camera_position, 1.0);
+    uniforms.time = std::chrono::duration<float>(
+        std::chrono::steady_clock::now() - this->render_start).count();
+    uniforms.camera_near = snapshot.camera_near;
+    uniforms.camera_far = snapshot.camera_far;
+    uniforms.msaa_level = *this->msaa_level;
+    this->frame_uniform_buffer->update(uniforms);
+}
 
-        this->sort_renderables();
+void SimpleRenderManager::cull(const RenderSnapshot& snapshot) {
+    size_t item_count = snapshot.items.size();
+    this->item_visible.assign(item_count, 1);
+    if(!this->frustum_culling) {
+        return;
+    }
 
-        auto bm_sort_duration = std::chrono::system_clock::now() - bm_sort_start;
-        uint64_t bm_sort_duration_ns = 
-            std::chrono::duration_cast<std::chrono::nanoseconds>(
-                bm_sort_duration).count();
-        //float bm_sort_duration_ms = ((float) bm_sort_duration_ns) / 1000000;
-        //DEBUG("Sorted %i renderable entities in %.3fms (%uns)",
-        //    this->renderables.size(), bm_sort_duration_ms, bm_sort_duration_ns);
-        bm_sort_total_time += bm_sort_duration_ns;
-        bm_sort_total_entity_count += (*this->active_scene->get_renderables()).size();
-        bm_sort_total_count += 1;
+    // Pack the bounds so the kernel can test several at once
+    this->cull_x.clear();
+    this->cull_y.clear();
+    this->cull_z.clear();
+    this->cull_radius.clear();
+    this->cull_index.clear();
+    for(size_t i = 0; i < item_count; i++) {
+        const RenderSnapshotItem& item = snapshot.items[i];
+        if(!item.bounded) {
+            continue;
+        }
+        this->cull_x.push_back(item.bounds_center.x);
+        this->cull_y.push_back(item.bounds_center.y);
+        this->cull_z.push_back(item.bounds_center.z);
+        this->cull_radius.push_back(item.bounds_radius);
+        this->cull_index.push_back(i);
+    }
+    this->cull_result.resize(this->cull_index.size());
+
+    glm::vec4 planes[6];
+    se::util::frustum::extract_planes(snapshot.camera_matrix, planes);
+    se::util::frustum::cull_spheres(planes, this->cull_x.data(),
+        this->cull_y.data(), this->cull_z.data(), this->cull_radius.data(),
+        this->cull_index.size(), this->cull_result.data());
+    for(size_t i = 0; i < this->cull_index.size(); i++) {
+        this->item_visible[this->cull_index[i]] = this->cull_result[i];
+    }
+}
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+void SimpleRenderManager::occlusion_cull(const RenderSnapshot& snapshot) {
+    auto start = std::chrono::steady_clock::now();
+    se::util::DepthRasterizer* rasterizer = this->depth_rasterizer;
+    rasterizer->clear();
+    size_t item_count = snapshot.items.size();
+    for(size_t i = 0; i < item_count; i++) {
+        const RenderSnapshotItem& item = snapshot.items[i];
+        if(this->item_visible[i] && item.occluder) {
+            rasterizer->add_box(snapshot.camera_matrix * item.model_matrix,
+                item.occluder_min, item.occluder_max);
+        }
+    }
+    this->engine->worker_pool->parallel_for(rasterizer->get_band_count(),
+        [rasterizer](size_t band){ rasterizer->rasterize_band(band); });
+
+    this->frame_occluded_count = 0;
+    for(size_t i = 0; i < item_count; i++) {
+        const RenderSnapshotItem& item = snapshot.items[i];
+        if(!this->item_visible[i] || !item.bounded || item.occluder) {
+            continue;
+        }
+        glm::vec3 extent(item.bounds_radius, item.bounds_radius, item.bounds_radius);
+        if(!rasterizer->test_box(snapshot.camera_matrix,
+            item.bounds_center - extent, item.bounds_center + extent)) {
+            this->item_visible[i] = 0;
+            this->frame_occluded_count++;
+        }
     }
+    this->stat_occluded_count += this->frame_occluded_count;
+    this->stat_occlusion_time += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
 
-    // Benchmarking information for entity sorting operation
-    if(bm_sort_total_count == 0 || bm_sort_total_entity_count == 0) {
-        WARN("No entities were sorted - skipping sorting benchmarks");
-    } else {
-        uint64_t average_time = bm_sort_total_time / bm_sort_total_count;
-        uint64_t average_entity_time = bm_sort_total_time / bm_sort_total_entity_count;
-        float total_time_ms = bm_sort_total_time / 1000000.0;
-        float average_time_ms = average_time / 1000000.0;
-        float averate_entity_time_ms = average_entity_time / 1000000.0;
-        INFO("Total sort operations: %u", bm_sort_total_count);
-        INFO("Total entities sorted: %u", bm_sort_total_entity_count);
-        INFO("Total time %.3fms (%uns)", total_time_ms, bm_sort_total_time);
-        INFO("Average time %.3fms (%uns)", average_time_ms, average_time);
-        INFO("Average entity time %.3fms (%uns)", averate_entity_time_ms, average_entity_time);
-    }
-
-    DEBUG("Simple render manager support thread terminated");
-}
-
-bool renderable_sort_check(se::Entity* e1, se::Entity* e2, se::entity::Camera* camera) {
-    /* In order to sort renderable entities, we want to calculate their
-    distances to/from the currently active camera. It might be worth revisiting
-    this method in the future with a faster or more suitable algorithm. */
-    float dist_e1 = 0.0;
-    float dist_e2 = 0.0;
-    { // Distance calculation for entity 1
-        float dx = e1->x - camera->x;
-        float dy = e1->y - camera->y;
-        float dz = e1->z - camera->z;
-        dx = dx*dx;
-        dy = dy*dy;
-        dz = dz*dz;
-        dist_e1 = sqrt(dx + dy + dz);
-    }
-    { // Distance calculation for entity 2
-        float dx = e2->x - camera->x;
-        float dy = e2->y - camera->y;
-        float dz = e2->z - camera->z;
-        dx = dx*dx;
-        dy = dy*dy;
-        dz = dz*dz;
-        dist_e2 = sqrt(dx + dy + dz);
-    }
-
-    return dist_e1 < dist_e2;
-}
-
-void SimpleRenderManager::sort_renderables() {
-    auto sort_function = [this](se::Entity* e1, se::Entity* e2){
-        return renderable_sort_check(e1, e2, this->active_camera);
+void SimpleRenderManager::record_commands(const RenderSnapshot& snapshot) {
+    auto start = std::chrono::steady_clock::now();
+    const std::vector<RenderQueueItem>& items = this->render_queue->get_items();
+    size_t item_count = items.size();
+
+    /* Small queues aren't worth waking the workers for, so every list gets a
+    reasonable number of items. */
+    size_t list_count = 1;
+    if(this->parallel_recording) {
+        list_count = std::min((size_t) this->engine->worker_pool->get_thread_count() + 1,
+            item_count / MIN_COMMAND_LIST_ITEMS);
+        list_count = std::max(list_count, (size_t) 1);
+    }
+    if(this->command_lists.size() < list_count) {
+        this->command_lists.resize(list_count);
+    }
+    this->frame_command_list_count = list_count;
+
+    size_t list_items = (item_count + list_count - 1) / list_count;
+    auto record_list = [this, &snapshot, &items, item_count, list_items](size_t list) {
+        CommandList& commands = this->command_lists[list];
+        commands.clear();
+        size_t end = std::min(item_count, (list + 1) * list_items);
+        for(size_t i = list * list_items; i < end; i++) {
+            this->record_item(snapshot, items[i].index, commands);
+        }
     };
+    if(list_count == 1) {
+        record_list(0);
+    } else {
+        this->engine->worker_pool->parallel_for(list_count, record_list);
+    }
+    this->stat_record_time += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
 
-    std::sort(
-        (*this->active_scene->get_renderables()).begin(),
-        (*this->active_scene->get_renderables()).end(),
-        sort_function);
+void SimpleRenderManager::record_item(const RenderSnapshot& snapshot, uint32_t index,
+    CommandList& commands) {
+    const RenderSnapshotItem& item = snapshot.items[index];
+
+    // Entities which were occluded are left until after the occlusion queries
+    if(this->occlusion_culler != nullptr && this->occlusion_culler->is_deferred(index)) {
+        return;
+    }
+    if(item.command.type != DrawCommandType::SKIP) {
+        DrawCommand command = item.command;
+        command.index = index;
+        commands.push(command);
+    }
 }
 
 // ====================
@@ -128,39 +264,143 @@ SimpleRenderManager::SimpleRenderManager(se::Engine* engine) {
     this->active_scene = new se::Scene(this->engine);
     this->default_scene = this->active_scene;
 
-    this->support_thread = std::thread(&SimpleRenderManager::support_thread_main, this);
+    this->render_queue = new RenderQueue();
+    this->window_height = engine->config->get_intp("window.dimy");
+    this->window_width = engine->config->get_intp("window.dimx");
+    this->msaa_level = engine->config->get_intp("render.msaa");
+    this->render_start = std::chrono::steady_clock::now();
+    this->frame_uniform_buffer = new FrameUniformBuffer();
+
+    engine->logic_controller->register_sync_handler(this,
+        [this](){ this->publish_snapshot(); });
 
     this->screen = new se::graphics::Screen(engine);
+
+    if(this->engine->config->get_bool("render.instancing", false)) {
+        this->instanced_renderer = new InstancedRenderer(engine);
+    }
+
+    this->frustum_culling = this->engine->config->get_bool("render.frustum_culling", true);
+    this->parallel_recording = this->engine->config->get_bool("render.parallel_recording", true);
+
+    std::string occlusion_mode = this->engine->config->get_string("render.occlusion_culling", "none");
+    if(occlusion_mode == "hardware") {
+        this->occlusion_culler = new OcclusionCuller(engine);
+    } else if(occlusion_mode == "software") {
+        this->depth_rasterizer = new se::util::DepthRasterizer(
+            SOFTWARE_OCCLUSION_WIDTH, SOFTWARE_OCCLUSION_HEIGHT);
+    } else if(occlusion_mode != "none") {
+        WARN("Unknown occlusion culling mode [%s]", occlusion_mode.c_str());
+    }
 }
 
 SimpleRenderManager::~SimpleRenderManager() {
-    this->run = false;
-    if(this->support_thread.joinable()) {
-        DEBUG("Waiting for the support thread to exit");
-        this->support_thread.join();
+    this->engine->logic_controller->deregister_sync_handler(this);
+
+    if(this->stat_frame_count == 0) {
+        WARN("No frames rendered - skipping culling benchmarks");
+    } else {
+        INFO("Entities drawn per frame: %.2f",
+            (double) this->stat_visible_count / this->stat_frame_count);
+        INFO("Entities frustum culled per frame: %.2f",
+            (double) this->stat_culled_count / this->stat_frame_count);
+        uint64_t triangles_drawn, triangles_full;
+        se::graphics::Geometry::get_triangle_stats(triangles_drawn, triangles_full);
+        INFO("Triangles per frame: %.0f (%.0f at full detail)",
+            (double) triangles_drawn / this->stat_frame_count,
+            (double) triangles_full / this->stat_frame_count);
+        if(this->depth_rasterizer != nullptr) {
+            INFO("Entities occluded per frame: %.2f",
+                (double) this->stat_occluded_count / this->stat_frame_count);
+            INFO("Average software occlusion time: %.3fms",
+                this->stat_occlusion_time / 1000000.0 / this->stat_frame_count);
+        }
+        INFO("Average command recording time: %.3fms",
+            this->stat_record_time / 1000000.0 / this->stat_frame_count);
+        INFO("GL state changes per frame: %.2f issued, %.2f elided",
+            (double) this->stat_gl_state_issued / this->stat_frame_count,
+            (double) this->stat_gl_state_elided / this->stat_frame_count);
     }
 
     delete this->default_camera;
     delete this->default_scene;
     delete this->screen;
+    delete this->instanced_renderer;
+    delete this->occlusion_culler;
+    delete this->depth_rasterizer;
+    delete this->render_queue;
+    delete this->frame_uniform_buffer;
 }
 
 void SimpleRenderManager::render_frame() {
 
+    GLState::begin_frame();
     this->screen->activate_framebuffer();
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glm::mat4 camera_matrix = this->active_camera->get_camera_matrix();
-
-    glEnable(GL_DEPTH_TEST);
+    /* Only the most recent published snapshot is used, the scene itself may
+    be changing while the frame is drawn.  If nothing new has been published
+    the previous snapshot is drawn again. */
+    this->snapshots.acquire();
+    const RenderSnapshot& snapshot = this->snapshots.get_front();
+    this->update_frame_uniforms(snapshot);
+
+    GLState::set_enabled(GL_DEPTH_TEST, true);
+
+    // Skip everything outside of the view frustum, or hidden behind occluders
+    size_t item_count = snapshot.items.size();
+    this->cull(snapshot);
+    this->frame_culled_count = std::count(this->item_visible.begin(),
+        this->item_visible.end(), 0);
+    if(this->depth_rasterizer != nullptr) {
+        this->occlusion_cull(snapshot);
+    }
+    if(this->occlusion_culler != nullptr) {
+        this->occlusion_culler->begin_frame(snapshot, this->item_visible);
+    }
 
-    for(auto entity : *this->active_scene->get_renderables()) {
-        entity->render(camera_matrix);
+    /* Renderables are sorted by layer and state, then front to back, so that
+    program, texture, and geometry changes are minimized.  Only one distance is
+    computed per entity. */
+    float inverse_far = 1.0 / snapshot.camera_far;
+    this->render_queue->clear();
+    this->frame_visible_count = 0;
+    for(size_t i = 0; i < item_count; i++) {
+        if(!this->item_visible[i]) {
+            continue;
+        }
+        const RenderSnapshotItem& item = snapshot.items[i];
+        this->frame_visible_count++;
+        glm::vec3 delta = item.position - snapshot.camera_position;
+        float distance = sqrt(delta.x*delta.x + delta.y*delta.y + delta.z*delta.z);
+        this->render_queue->push(i, item.state, distance * inverse_far);
+    }
+    this->render_queue->sort();
+    this->stat_frame_count++;
+    this->stat_visible_count += this->frame_visible_count;
+    this->stat_culled_count += this->frame_culled_count;
+
+    /* Draw commands are recorded on the worker threads, then replayed here in
+    queue order.  Static props are batched and drawn after everything else,
+    unless they can't be instanced. */
+    this->record_commands(snapshot);
+    for(size_t i = 0; i < this->frame_command_list_count; i++) {
+        this->command_lists[i].replay(snapshot, this->instanced_renderer);
+    }
+    if(this->instanced_renderer != nullptr) {
+        this->instanced_renderer->draw();
+    }
+    if(this->occlusion_culler != nullptr) {
+        this->occlusion_culler->issue_queries(snapshot);
+        this->occlusion_culler->draw_deferred(snapshot, this->render_queue->get_items());
     }
 
     this->screen->render();
-    
+
+    this->frame_gl_state_stats = GLState::get_frame_stats();
+    this->stat_gl_state_issued += this->frame_gl_state_stats.issued;
+    this->stat_gl_state_elided += this->frame_gl_state_stats.elided;
 }
 
 void SimpleRenderManager::set_active_camera(se::entity::Camera* camera) {
@@ -177,4 +417,27 @@ void SimpleRenderManager::set_active_scene(se::Scene* scene) {
 
 void SimpleRenderManager::use_default_scene() {
     this->active_scene = this->default_scene;
+}
+
+RenderQueueStats SimpleRenderManager::get_render_queue_stats() {
+    return this->render_queue->get_frame_stats();
+}
+
+uint32_t SimpleRenderManager::get_frame_visible_count() {
+    return this->frame_visible_count;
+}
+
+uint32_t SimpleRenderManager::get_frame_culled_count() {
+    return this->frame_culled_count;
+}
+
+uint32_t SimpleRenderManager::get_frame_occluded_count() {
+    if(this->occlusion_culler != nullptr) {
+        return this->occlusion_culler->get_frame_occluded_count();
+    }
+    return this->frame_occluded_count;
+}
+
+GLStateStats SimpleRenderManager::get_gl_state_stats() {
+    return this->frame_gl_state_stats;
 }
\ No newline at end of file
@@ -0,0 +1,134 @@
+/*!
+ *  @file src/se/graphics/streamBuffer.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/graphics/streamBuffer.hpp"
+
+#include "se/graphics/glState.hpp"
+
+#include "se/util/log.hpp"
+
+#include <algorithm>
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+using namespace se::graphics;
+
+/// Maximum time to wait for a region to become free (nanoseconds)
+#define REGION_WAIT_TIMEOUT 1000000000
+
+uint64_t StreamBuffer::last_generation = 0;
+
+// =====================
+// == PRIVATE METHODS ==
+// =====================
+
+void StreamBuffer::allocate(size_t region_size) {
+    // Every region has to be idle before the old buffer can go
+    for(unsigned int i = 0; i < REGION_COUNT; i++) {
+        if(this->fences[i] != nullptr) {
+            glClientWaitSync(this->fences[i], GL_SYNC_FLUSH_COMMANDS_BIT,
+                REGION_WAIT_TIMEOUT);
+            glDeleteSync(this->fences[i]);
+            this->fences[i] = nullptr;
+        }
+    }
+    /* The new buffer is created before the old one is deleted, so it can't
+    reuse the old name, but anything created later can.  Vertex array objects
+    which still reference the old buffer notice the change by generation. */
+    unsigned int old_buffer_id = this->gl_buffer_id;
+    this->region_size = (region_size + this->alignment - 1) / this->alignment * this->alignment;
+    size_t buffer_size = this->region_size * REGION_COUNT;
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &this->gl_buffer_id);
+    GLState::bind_buffer(GL_ARRAY_BUFFER, this->gl_buffer_id);
+    glBufferStorage(GL_ARRAY_BUFFER, buffer_size, nullptr, flags);
+    this->mapping = (char*) glMapBufferRange(GL_ARRAY_BUFFER, 0, buffer_size, flags);
+    this->generation = ++last_generation;
+    if(old_buffer_id != 0) {
+        GLState::delete_buffers(1, &old_buffer_id);
+        this->stat_grow_count++;
+    }
+    if(this->mapping == nullptr) {
+        ERROR("Failed to map stream buffer of %lu bytes", buffer_size);
+        GLState::delete_buffers(1, &this->gl_buffer_id);
+        this->gl_buffer_id = 0;
+        this->region_size = 0;
+        this->disabled = true;
+        return;
+    }
+    DEBUG("Allocated stream buffer with %u regions of %lu bytes",
+        REGION_COUNT, this->region_size);
+}
+
+// ====================
+// == PUBLIC METHODS ==
+// ====================
+
+StreamBuffer::StreamBuffer(size_t alignment) {
+    this->alignment = std::max(alignment, (size_t) 1);
+}
+
+StreamBuffer::~StreamBuffer() {
+    /* The buffer and fences are not deleted here, because the stream buffer
+    may be destroyed outside of the graphics thread.  They go with the
+    context. */
+    if(this->stat_frame_count > 0) {
+        INFO("Stream buffer frames: %lu (%lu stalled, %lu reallocations)",
+            this->stat_frame_count, this->stat_stall_count, this->stat_grow_count);
+    }
+}
+
+void* StreamBuffer::begin_frame(size_t size) {
+    if(this->disabled || !GLEW_ARB_buffer_storage) {
+        return nullptr;
+    }
+    if(size > this->region_size) {
+        // Leave some room so the buffer isn't reallocated every frame
+        this->allocate(std::max(size + size / 2, this->region_size * 2));
+        if(this->mapping == nullptr) {
+            return nullptr;
+        }
+    }
+    this->region = (this->region + 1) % REGION_COUNT;
+    GLsync& fence = this->fences[this->region];
+    if(fence != nullptr) {
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        if(result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+            // The GPU is more than two frames behind
+            this->stat_stall_count++;
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, REGION_WAIT_TIMEOUT);
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    this->stat_frame_count++;
+    return this->mapping + this->region * this->region_size;
+}
+
+void StreamBuffer::end_frame() {
+    if(this->mapping == nullptr) {
+        return;
+    }
+    GLsync& fence = this->fences[this->region];
+    if(fence != nullptr) {
+        glDeleteSync(fence);
+    }
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+size_t StreamBuffer::get_offset() {
+    return this->region * this->region_size;
+}
+
+unsigned int StreamBuffer::get_buffer_id() {
+    return this->gl_buffer_id;
+}
+
+uint64_t StreamBuffer::get_generation() {
+    return this->generation;
+}
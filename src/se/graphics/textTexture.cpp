@@ -137,10 +137,14 @@ void TextTexture::update_text(std::string text) {
         x += (advance.x / 64);
         y += (advance.y / 64);
     }
-    // Bind the texture
+    /* Bind the texture.  This is queued at the same priority as the initial
+    bind so that the two can't be reordered, and is coalesced so that only the
+    most recent update is uploaded if the text changes faster than the
+    graphics thread can keep up. */
     std::function job = [this](){
         this->unbind();
         this->bind();
     };
-    this->engine->graphics_controller->submit_graphics_task(job);
+    this->bind_handle = this->engine->graphics_controller->submit_graphics_task(
+        job, GraphicsTaskPriority::BACKGROUND, graphics_task_key(this, 0));
 }
\ No newline at end of file
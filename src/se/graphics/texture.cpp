@@ -9,14 +9,17 @@
 #include "se/graphics/texture.hpp"
 
 #include "se/engine.hpp"
+#include "se/graphics/glState.hpp"
 #include "se/graphics/shader.hpp"
 #include "se/graphics/graphicsController.hpp"
+#include "se/graphics/textureStreamer.hpp"
 
 #include "se/util/dirs.hpp"
 #include "se/util/hash.hpp"
 #include "se/util/log.hpp"
 #include "se/util/debugstrings.hpp"
 
+#include <algorithm>
 #include <string.h>
 #include <string>
 #include <SDL2/SDL.h>
@@ -30,6 +33,16 @@ using namespace se::util;
 
 #define TEXTURE_HASH_FORMAT "texture:%p:%s"
 
+/// Get the number of bytes per pixel of 8 bit per channel texture data
+static size_t texture_pixel_size(GLenum data_format) {
+    switch(data_format) {
+        case GL_RED: return 1;
+        case GL_RG: return 2;
+        case GL_RGB: case GL_BGR: return 3;
+        default: return 4;
+    }
+}
+
 // =======================
 // == PROTECTED METHODS ==
 // =======================
@@ -48,7 +61,7 @@ void Texture::bind() {
     }
 
     glGenTextures(1, &this->gl_texture);
-    glBindTexture(this->options.type, this->gl_texture);
+    GLState::bind_texture(this->options.type, this->gl_texture);
     
     // TODO: Add additional texture parameter configuration options
 
@@ -59,9 +72,41 @@ void Texture::bind() {
         glTexParameteri(this->options.type, GL_TEXTURE_WRAP_S,     this->options.gl_tex_wrap_s);
         glTexParameteri(this->options.type, GL_TEXTURE_WRAP_T,     this->options.gl_tex_wrap_t);
         // endd ebug
-        glTexImage2D(GL_TEXTURE_2D, 0, this->options.gl_color_format, this->options.dimx, 
-            this->options.dimy, 0, this->options.gl_data_format,
-            GL_UNSIGNED_BYTE, this->texture_data);
+        int levels = std::max(this->options.mip_levels, 1);
+        glTexParameteri(this->options.type, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(this->options.type, GL_TEXTURE_MAX_LEVEL, levels - 1);
+        // Texture data is tightly packed
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        /* Staged data is read from the upload buffer, in which case the data
+        pointer is an offset into the buffer and the copy is asynchronous. */
+        TextureStreamer* streamer = this->engine->graphics_controller->get_texture_streamer();
+        if(this->upload_slot != nullptr) {
+            GLState::bind_buffer(GL_PIXEL_UNPACK_BUFFER, streamer->get_buffer_id());
+        }
+        size_t level_offset = 0;
+        int level_x = this->options.dimx;
+        int level_y = this->options.dimy;
+        size_t pixel_size = texture_pixel_size(this->options.gl_data_format);
+        for(int level = 0; level < levels; level++) {
+            const void* level_data = nullptr;
+            if(this->upload_slot != nullptr) {
+                level_data = (const void*) (this->upload_slot->offset + level_offset);
+            } else if(this->texture_data != nullptr) {
+                level_data = this->texture_data + level_offset;
+            }
+            glTexImage2D(GL_TEXTURE_2D, level, this->options.gl_color_format,
+                level_x, level_y, 0, this->options.gl_data_format,
+                GL_UNSIGNED_BYTE, level_data);
+            level_offset += (size_t) level_x * level_y * pixel_size;
+            level_x = std::max(level_x / 2, 1);
+            level_y = std::max(level_y / 2, 1);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if(this->upload_slot != nullptr) {
+            GLState::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            streamer->release(this->upload_slot);
+            this->upload_slot = nullptr;
+        }
     } else if(this->options.type == GL_TEXTURE_2D_MULTISAMPLE) {
         glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, this->options.mscount,
             this->options.gl_color_format, this->options.dimx,
@@ -87,11 +132,49 @@ void Texture::bind() {
 }
 
 void Texture::unbind() {
-    glDeleteTextures(1, &this->gl_texture);
+    GLState::delete_textures(1, &this->gl_texture);
     this->gl_texture = 0;
     DEBUG("Texture [%s] unbound", this->name);
 }
 
+void Texture::stage_upload(GraphicsTaskHandle ready) {
+    TextureStreamer* streamer = this->engine->graphics_controller->get_texture_streamer();
+    if(streamer == nullptr || this->texture_data == nullptr ||
+        this->options.type != GL_TEXTURE_2D ||
+        this->resource_state != LoadableResourceState::LOADING) {
+        ready->mark_complete();
+        return;
+    }
+    size_t size = 0;
+    int level_x = this->options.dimx;
+    int level_y = this->options.dimy;
+    size_t pixel_size = texture_pixel_size(this->options.gl_data_format);
+    for(int level = 0; level < std::max(this->options.mip_levels, 1); level++) {
+        size += (size_t) level_x * level_y * pixel_size;
+        level_x = std::max(level_x / 2, 1);
+        level_y = std::max(level_y / 2, 1);
+    }
+    TextureUploadSlot* slot = streamer->acquire(size);
+    if(slot == nullptr) {
+        DEBUG("[%s] No upload slot available, uploading directly", this->name);
+        ready->mark_complete();
+        return;
+    }
+    memcpy(slot->data, this->texture_data, size);
+    this->upload_slot = slot;
+    this->texture_data = nullptr;
+    this->release_texture_data();
+    streamer->queue_upload(slot, ready);
+}
+
+void Texture::discard_upload() {
+    if(this->upload_slot == nullptr) { return; }
+    this->engine->graphics_controller->get_texture_streamer()->discard(this->upload_slot);
+    this->upload_slot = nullptr;
+}
+
+void Texture::release_texture_data() {}
+
 void Texture::load_() {
     if(this->resource_state != LoadableResourceState::NOT_LOADED) {
         WARN("Attempted to load texture in state [%s]",
@@ -100,7 +183,8 @@ void Texture::load_() {
     }
     DEBUG("Loaded [%s], waiting for bind", this->name);
     std::function job = [this](){this->bind();};
-    this->engine->graphics_controller->submit_graphics_task(job);
+    this->bind_handle = this->engine->graphics_controller->submit_graphics_task(
+        job, GraphicsTaskPriority::BACKGROUND);
 }
 
 void Texture::unload_() {
@@ -112,7 +196,8 @@ void Texture::unload_() {
     DEBUG("Unloading [%s], waiting for unbind", this->name);
     this->resource_state = LoadableResourceState::NOT_LOADED;
     std::function job = [this](){this->unbind();};
-    this->engine->graphics_controller->submit_graphics_task(job);
+    this->engine->graphics_controller->submit_graphics_task(job,
+        GraphicsTaskPriority::BACKGROUND);
 }
 
 // ====================
@@ -128,10 +213,20 @@ void Texture::use_texture(unsigned int tex_unit) {
     if(this->resource_state != LoadableResourceState::LOADED) { return; }
     int unit_num = tex_unit - GL_TEXTURE0;
     glUniform1i(SE_SHADER_LOC_TEX_0 + unit_num, unit_num);
-    glActiveTexture(tex_unit);
-    glBindTexture(this->options.type, this->gl_texture);
+    GLState::bind_texture(tex_unit, this->options.type, this->gl_texture);
 }
 
 unsigned int Texture::get_texture_id() {
     return this->gl_texture;
+}
+
+LoadableResourceState Texture::wait_for_loading() {
+    if(this->bind_handle != nullptr) {
+        this->bind_handle->wait();
+    }
+    return this->resource_state;
+}
+
+GraphicsTaskHandle Texture::get_bind_handle() {
+    return this->bind_handle;
 }
\ No newline at end of file
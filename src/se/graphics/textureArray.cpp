@@ -0,0 +1,281 @@
+/*!
+ *  @file src/se/graphics/textureArray.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/graphics/textureArray.hpp"
+
+#include "se/engine.hpp"
+#include "se/graphics/glState.hpp"
+#include "se/graphics/graphicsController.hpp"
+#include "se/graphics/imageTexture.hpp"
+#include "se/graphics/shader.hpp"
+
+#include "se/util/debugstrings.hpp"
+#include "se/util/log.hpp"
+
+#include <algorithm>
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+using namespace se::graphics;
+using namespace se::util;
+
+/// Number of layers allocated for a new array
+#define TEXTURE_ARRAY_INITIAL_CAPACITY 4
+
+// ===================
+// == TEXTURE ARRAY ==
+// ===================
+
+bool TextureArray::grow(int new_capacity) {
+    GLint max_layers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+    new_capacity = std::min(new_capacity, (int) max_layers);
+    if(new_capacity <= this->capacity) {
+        ERROR("Texture array [%ix%i] is full (%i layers)", this->dimx,
+            this->dimy, this->capacity);
+        return false;
+    }
+
+    // Texture storage must use a sized format
+    GLenum storage_format = this->gl_color_format == GL_RGBA ? GL_RGBA8 :
+        this->gl_color_format == GL_RGB ? GL_RGB8 : this->gl_color_format;
+    unsigned int new_texture = 0;
+    glGenTextures(1, &new_texture);
+    GLState::bind_texture(GL_TEXTURE_2D_ARRAY, new_texture);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, this->mip_levels, storage_format,
+        this->dimx, this->dimy, new_capacity);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER,
+        this->mip_levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, this->mip_levels - 1);
+
+    // Move the existing layers across
+    if(this->gl_texture != 0) {
+        int level_x = this->dimx;
+        int level_y = this->dimy;
+        for(int level = 0; level < this->mip_levels; level++) {
+            glCopyImageSubData(
+                this->gl_texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                new_texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                level_x, level_y, this->capacity);
+            level_x = std::max(level_x / 2, 1);
+            level_y = std::max(level_y / 2, 1);
+        }
+        GLState::delete_textures(1, &this->gl_texture);
+    }
+
+    DEBUG("Texture array [%ix%i] grown from %i to %i layers", this->dimx,
+        this->dimy, this->capacity, new_capacity);
+    this->gl_texture = new_texture;
+    this->capacity = new_capacity;
+    this->used_layers.resize(new_capacity, false);
+    return true;
+}
+
+TextureArray::TextureArray(const TextureOptions& options) {
+    this->dimx = options.dimx;
+    this->dimy = options.dimy;
+    this->mip_levels = std::max(options.mip_levels, 1);
+    this->gl_color_format = options.gl_color_format;
+}
+
+TextureArray::~TextureArray() {}
+
+bool TextureArray::matches(const TextureOptions& options) {
+    return options.type == GL_TEXTURE_2D &&
+        options.dimx == this->dimx &&
+        options.dimy == this->dimy &&
+        std::max(options.mip_levels, 1) == this->mip_levels &&
+        options.gl_color_format == this->gl_color_format;
+}
+
+int TextureArray::add_layer(Texture* source) {
+    auto free_layer = std::find(this->used_layers.begin(), this->used_layers.end(), false);
+    int layer = free_layer - this->used_layers.begin();
+    if(free_layer == this->used_layers.end()) {
+        int new_capacity = std::max(this->capacity * 2, TEXTURE_ARRAY_INITIAL_CAPACITY);
+        if(!this->grow(new_capacity)) {
+            return -1;
+        }
+    }
+    this->used_layers[layer] = true;
+
+    int level_x = this->dimx;
+    int level_y = this->dimy;
+    for(int level = 0; level < this->mip_levels; level++) {
+        glCopyImageSubData(
+            source->get_texture_id(), GL_TEXTURE_2D, level, 0, 0, 0,
+            this->gl_texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, layer,
+            level_x, level_y, 1);
+        level_x = std::max(level_x / 2, 1);
+        level_y = std::max(level_y / 2, 1);
+    }
+    return layer;
+}
+
+void TextureArray::free_layer(int layer) {
+    if(layer >= 0 && layer < this->capacity) {
+        this->used_layers[layer] = false;
+    }
+}
+
+void TextureArray::unbind() {
+    GLState::delete_textures(1, &this->gl_texture);
+    this->gl_texture = 0;
+    this->capacity = 0;
+    this->used_layers.clear();
+}
+
+void TextureArray::use_array(unsigned int tex_unit) {
+    GLState::bind_texture(tex_unit, GL_TEXTURE_2D_ARRAY, this->gl_texture);
+}
+
+int TextureArray::get_layer_count() {
+    return std::count(this->used_layers.begin(), this->used_layers.end(), true);
+}
+
+unsigned int TextureArray::get_texture_id() {
+    return this->gl_texture;
+}
+
+// ===================
+// == TEXTURE LAYER ==
+// ===================
+
+TextureLayer::TextureLayer(se::Engine* engine, TextureArrayManager* manager, std::string name) {
+    this->engine = engine;
+    this->manager = manager;
+    this->name = name;
+}
+
+void TextureLayer::bind() {
+    if(this->resource_state == LoadableResourceState::LOADING) {
+        if(this->source->get_resource_state() == LoadableResourceState::LOADED) {
+            this->array = this->manager->get_array(this->source->options);
+            this->layer = this->array->add_layer(this->source);
+            // The array may have been reallocated
+            this->manager->reset_bindings();
+            if(this->layer < 0) {
+                this->array = nullptr;
+                this->resource_state = LoadableResourceState::ERROR;
+            } else {
+                DEBUG("Texture [%s] stored in array layer [%i]", this->name.c_str(), this->layer);
+                this->resource_state = LoadableResourceState::LOADED;
+            }
+        } else {
+            this->resource_state = LoadableResourceState::CHILD_ERROR;
+        }
+    }
+    // The array holds its own copy, so the source texture is no longer needed
+    this->source->decrement_resource_user_counter();
+    this->source = nullptr;
+}
+
+void TextureLayer::unbind() {
+    if(this->array != nullptr) {
+        this->array->free_layer(this->layer);
+    }
+    this->array = nullptr;
+    this->layer = -1;
+}
+
+void TextureLayer::load_() {
+    DEBUG("Loading texture layer [%s]", this->name.c_str());
+    this->resource_state = LoadableResourceState::LOADING;
+    this->source = ImageTexture::get_texture(this->engine, this->name.c_str());
+    this->source->increment_resource_user_counter();
+    std::function job = [this](){this->bind();};
+    this->bind_handle = this->engine->graphics_controller->submit_graphics_task(
+        job, GraphicsTaskPriority::BACKGROUND, 0, {this->source->get_bind_handle()});
+}
+
+void TextureLayer::unload_() {
+    DEBUG("Unloading texture layer [%s]", this->name.c_str());
+    this->resource_state = LoadableResourceState::NOT_LOADED;
+    std::function job = [this](){this->unbind();};
+    this->engine->graphics_controller->submit_graphics_task(job,
+        GraphicsTaskPriority::BACKGROUND, 0, {this->bind_handle});
+}
+
+void TextureLayer::use_layer(unsigned int tex_unit) {
+    if(this->resource_state != LoadableResourceState::LOADED) { return; }
+    int unit_num = tex_unit - GL_TEXTURE0;
+    glUniform1i(SE_SHADER_LOC_TEX_0 + unit_num, unit_num);
+    glUniform1i(SE_SHADER_LOC_IN_TEX_LAYER, this->layer);
+    this->manager->bind_array(this->array, tex_unit);
+}
+
+TextureArray* TextureLayer::get_array() {
+    return this->array;
+}
+
+int TextureLayer::get_layer() {
+    return this->layer;
+}
+
+// ===========================
+// == TEXTURE ARRAY MANAGER ==
+// ===========================
+
+TextureArrayManager::TextureArrayManager(se::Engine* engine) {
+    this->engine = engine;
+}
+
+TextureArrayManager::~TextureArrayManager() {
+    INFO("Texture arrays: %lu, texture layers: %lu", this->arrays.size(), this->layers.size());
+    for(auto& layer : this->layers) {
+        delete layer.second;
+    }
+    for(auto array : this->arrays) {
+        delete array;
+    }
+}
+
+TextureLayer* TextureArrayManager::get_layer(const char* texture_name) {
+    std::lock_guard<std::mutex> lock(this->layers_mutex);
+    auto it = this->layers.find(texture_name);
+    if(it != this->layers.end()) {
+        return it->second;
+    }
+    TextureLayer* layer = new TextureLayer(this->engine, this, texture_name);
+    this->layers[texture_name] = layer;
+    return layer;
+}
+
+TextureArray* TextureArrayManager::get_array(const TextureOptions& options) {
+    for(auto array : this->arrays) {
+        if(array->matches(options)) {
+            return array;
+        }
+    }
+    DEBUG("Creating texture array for [%ix%i %s] textures", options.dimx,
+        options.dimy, se::util::string::gl_type_name(options.gl_color_format));
+    TextureArray* array = new TextureArray(options);
+    this->arrays.push_back(array);
+    return array;
+}
+
+void TextureArrayManager::bind_array(TextureArray* array, unsigned int tex_unit) {
+    auto it = this->bound_arrays.find(tex_unit);
+    if(it != this->bound_arrays.end() && it->second == array) { return; }
+    array->use_array(tex_unit);
+    this->bound_arrays[tex_unit] = array;
+}
+
+void TextureArrayManager::reset_bindings() {
+    this->bound_arrays.clear();
+}
+
+void TextureArrayManager::shutdown() {
+    for(auto array : this->arrays) {
+        array->unbind();
+    }
+    this->reset_bindings();
+}
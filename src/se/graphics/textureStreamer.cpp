@@ -0,0 +1,194 @@
+/*!
+ *  @file src/se/graphics/textureStreamer.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/graphics/textureStreamer.hpp"
+
+#include "se/engine.hpp"
+#include "se/graphics/glState.hpp"
+
+#include "se/util/config.hpp"
+#include "se/util/log.hpp"
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+using namespace se::graphics;
+
+// ====================
+// == PUBLIC METHODS ==
+// ====================
+
+TextureStreamer::TextureStreamer(se::Engine* engine, unsigned int slot_count, size_t slot_size) {
+    this->engine = engine;
+    this->slot_size = slot_size;
+
+    static int default_upload_budget_kb = 8192;
+    this->upload_budget_kb = this->engine->config->get_intp(
+        "render.upload_budget_kb", &default_upload_budget_kb);
+
+    /* The buffer is mapped once for its entire lifetime.  Coherent mapping
+    means writes from the workers become visible to the GPU without an explicit
+    flush, as long as they happen before the upload commands are issued. */
+    size_t buffer_size = slot_count * slot_size;
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &this->gl_buffer_id);
+    GLState::bind_buffer(GL_PIXEL_UNPACK_BUFFER, this->gl_buffer_id);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, buffer_size, nullptr, flags);
+    char* mapping = (char*) glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, buffer_size, flags);
+    GLState::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if(mapping == nullptr) {
+        ERROR("Failed to map texture upload buffer, streaming disabled");
+        this->stopped = true;
+        return;
+    }
+
+    this->slots.resize(slot_count);
+    for(unsigned int i = 0; i < slot_count; i++) {
+        this->slots[i].offset = i * slot_size;
+        this->slots[i].data = mapping + i * slot_size;
+    }
+    DEBUG("Texture streamer ready with %u slots of %lu bytes", slot_count, slot_size);
+}
+
+TextureStreamer::~TextureStreamer() {
+    // Print out benchmarking information
+    uint64_t bm_upload_count = this->stat_upload_count;
+    uint64_t bm_upload_bytes = this->stat_upload_bytes;
+    INFO("Textures streamed: %lu (%.3fMiB)", bm_upload_count, bm_upload_bytes / 1048576.0);
+    INFO("Texture uploads without a free slot: %lu", (uint64_t) this->stat_fallback_count);
+    INFO("Texture uploads discarded: %lu", (uint64_t) this->stat_discard_count);
+}
+
+void TextureStreamer::shutdown() {
+    std::vector<GraphicsTaskHandle> abandoned;
+    {
+        std::lock_guard<std::mutex> lock(this->slots_mutex);
+        if(this->gl_buffer_id != 0) {
+            for(auto& slot : this->slots) {
+                if(slot.fence != nullptr) {
+                    glDeleteSync(slot.fence);
+                    slot.fence = nullptr;
+                }
+            }
+            GLState::bind_buffer(GL_PIXEL_UNPACK_BUFFER, this->gl_buffer_id);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            GLState::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            GLState::delete_buffers(1, &this->gl_buffer_id);
+            this->gl_buffer_id = 0;
+        }
+        this->stopped = true;
+        for(auto& upload : this->queued_uploads) {
+            abandoned.push_back(std::move(upload.ready));
+        }
+        this->queued_uploads.clear();
+    }
+    /* Queued uploads will never be admitted.  Completing them lets the tasks
+    waiting on them be dropped instead of waiting forever. */
+    for(auto& ready : abandoned) {
+        ready->mark_complete();
+    }
+}
+
+TextureUploadSlot* TextureStreamer::acquire(size_t size) {
+    std::lock_guard<std::mutex> lock(this->slots_mutex);
+    if(!this->stopped && size <= this->slot_size) {
+        for(auto& slot : this->slots) {
+            if(slot.state == TextureUploadSlotState::FREE) {
+                slot.state = TextureUploadSlotState::STAGED;
+                slot.size = size;
+                return &slot;
+            }
+        }
+    }
+    this->stat_fallback_count++;
+    return nullptr;
+}
+
+void TextureStreamer::queue_upload(TextureUploadSlot* slot, GraphicsTaskHandle ready) {
+    {
+        std::lock_guard<std::mutex> lock(this->slots_mutex);
+        if(!this->stopped) {
+            this->queued_uploads.push_back({slot, slot->size, std::move(ready)});
+            return;
+        }
+    }
+    // Nothing is admitted after shutdown, see `shutdown()`
+    ready->mark_complete();
+}
+
+void TextureStreamer::release(TextureUploadSlot* slot) {
+    std::lock_guard<std::mutex> lock(this->slots_mutex);
+    if(this->stopped) { return; }
+    this->stat_upload_count++;
+    this->stat_upload_bytes += slot->size;
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot->state = TextureUploadSlotState::IN_FLIGHT;
+}
+
+void TextureStreamer::discard(TextureUploadSlot* slot) {
+    GraphicsTaskHandle ready;
+    {
+        std::lock_guard<std::mutex> lock(this->slots_mutex);
+        if(this->stopped) { return; }
+        this->stat_discard_count++;
+        slot->size = 0;
+        slot->state = TextureUploadSlotState::FREE;
+        // An upload still waiting for budget no longer needs any
+        for(auto it = this->queued_uploads.begin(); it != this->queued_uploads.end(); it++) {
+            if(it->slot == slot) {
+                ready = std::move(it->ready);
+                this->queued_uploads.erase(it);
+                break;
+            }
+        }
+    }
+    // Completion callbacks may submit tasks, so they're run outside the lock
+    if(ready != nullptr) {
+        ready->mark_complete();
+    }
+}
+
+void TextureStreamer::process_uploads() {
+    std::vector<GraphicsTaskHandle> admitted;
+    {
+        std::lock_guard<std::mutex> lock(this->slots_mutex);
+        if(this->stopped) { return; }
+
+        // Recycle slots the GPU has finished reading from
+        for(auto& slot : this->slots) {
+            if(slot.state != TextureUploadSlotState::IN_FLIGHT) { continue; }
+            GLenum result = glClientWaitSync(slot.fence, 0, 0);
+            if(result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+                glDeleteSync(slot.fence);
+                slot.fence = nullptr;
+                slot.size = 0;
+                slot.state = TextureUploadSlotState::FREE;
+            }
+        }
+
+        // Admit queued uploads
+        int budget_kb = *this->upload_budget_kb;
+        size_t budget = budget_kb > 0 ? budget_kb * 1024ull : 0;
+        size_t used = 0;
+        while(!this->queued_uploads.empty()) {
+            QueuedUpload& upload = this->queued_uploads.front();
+            if(admitted.size() > 0 && used + upload.size > budget) { break; }
+            used += upload.size;
+            admitted.push_back(std::move(upload.ready));
+            this->queued_uploads.pop_front();
+        }
+    }
+    // Completion callbacks may submit tasks, so they're run outside the lock
+    for(auto& ready : admitted) {
+        ready->mark_complete();
+    }
+}
+
+unsigned int TextureStreamer::get_buffer_id() {
+    return this->gl_buffer_id;
+}
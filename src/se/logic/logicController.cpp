@@ -48,6 +48,13 @@ void LogicController::logic_thread_main() {
             tickable->tick(this->scaled_clock, cdelta);
         }
 
+        {
+            std::lock_guard<std::mutex> lock(this->sync_handler_mutex);
+            for(auto& handler : this->sync_handlers) {
+                handler.second();
+            }
+        }
+
         auto tick_end = std::chrono::system_clock::now();
         auto duration_std = tick_end - tick_start;
         uint64_t duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration_std).count();
@@ -135,3 +142,19 @@ void LogicController::deregister_tickable(Tickable* tickable) {
     }
     WARN("Attemped to deregister nonexistant tickable!");
 }
+
+void LogicController::register_sync_handler(void* owner, std::function<void()> handler) {
+    std::lock_guard<std::mutex> lock(this->sync_handler_mutex);
+    this->sync_handlers.push_back(std::pair(owner, handler));
+}
+
+void LogicController::deregister_sync_handler(void* owner) {
+    std::lock_guard<std::mutex> lock(this->sync_handler_mutex);
+    for(size_t i = 0; i < this->sync_handlers.size(); i++) {
+        if(this->sync_handlers[i].first == owner) {
+            this->sync_handlers.erase(this->sync_handlers.begin() + i);
+            return;
+        }
+    }
+    WARN("Attemped to deregister nonexistant sync handler!");
+}
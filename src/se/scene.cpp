@@ -8,11 +8,17 @@
 
 #include "se/scene.hpp"
 
+#include "se/componentStore.hpp"
+#include "se/engine.hpp"
 #include "se/entity/staticProp.hpp"
+#include "se/logic/logicController.hpp"
 
+#include "se/util/config.hpp"
 #include "se/util/dirs.hpp"
+#include "se/util/frustum.hpp"
 #include "se/util/hash.hpp"
 #include "se/util/log.hpp"
+#include "se/util/threadPool.hpp"
 
 #include <fstream>
 
@@ -20,6 +26,13 @@ using namespace se;
 using namespace se::entity;
 using namespace nlohmann;
 
+/// Minimum number of indexed entities before the spatial index is rebuilt
+#define SPATIAL_REBUILD_MIN_SIZE 64
+/// Cost increase (relative to the last rebuild) which triggers a rebuild
+#define SPATIAL_REBUILD_THRESHOLD 1.25
+/// Number of updates between cost checks
+#define SPATIAL_COST_CHECK_INTERVAL 60
+
 // =====================
 // == PRIVATE MEMBERS ==
 // =====================
@@ -38,11 +51,104 @@ void Scene::generate_default_wrapped_entity_constructors() {
             }
             StaticProp* sp = new StaticProp(engine, geom_name.c_str(), text_name.c_str());
             sp->set_name(name.c_str());
+            sp->set_occluder(attribs.value<bool>("occluder", false));
+            try {
+                if(attribs.find("occluder_box") != attribs.end()) {
+                    auto& box = attribs["occluder_box"];
+                    sp->set_occluder_box(
+                        glm::vec3(box["min"].value("x", 0.0),
+                            box["min"].value("y", 0.0),
+                            box["min"].value("z", 0.0)),
+                        glm::vec3(box["max"].value("x", 0.0),
+                            box["max"].value("y", 0.0),
+                            box["max"].value("z", 0.0)));
+                }
+            }
+            catch(std::exception& e) {
+                WARN("Failed to process occluder box for static prop [%s], "
+                    "got error [%s]", name.c_str(), e.what());
+            }
             return sp;
         };
     this->register_constructor("staticprop", static_prop);
 }
 
+void Scene::update_spatial_index() {
+    std::lock_guard<std::mutex> lock(this->spatial_index_mutex);
+
+    if(this->spatial_rebuild != nullptr && this->spatial_rebuild->complete) {
+        this->spatial_index.finish_rebuild(*this->spatial_rebuild);
+        this->spatial_rebuild = nullptr;
+        this->spatial_rebuild_cost = this->spatial_index.cost();
+    }
+
+    if(this->components != nullptr) {
+        se::ComponentStore* store = this->components.get();
+        std::lock_guard<std::recursive_mutex> store_lock(store->get_mutex());
+        store->update_transforms();
+        se::Entity* const* entities = store->get_entities();
+        const glm::mat4* model_matrices = store->get_model_matrices();
+        const uint8_t* flags = store->get_flags();
+        size_t count = store->size();
+        for(size_t i = 0; i < count; i++) {
+            if(flags[i] & se::ComponentStore::RENDERABLE) {
+                this->index_entity(entities[i], model_matrices[i]);
+            }
+        }
+    } else {
+        for(auto entity : this->renderable_entities) {
+            this->index_entity(entity, entity->get_model_matrix());
+        }
+    }
+
+    /* Incremental updates slowly make the tree worse.  Once it has degraded
+    enough, a new tree is built on the worker pool. */
+    if(this->spatial_rebuild != nullptr ||
+        this->spatial_index.size() < SPATIAL_REBUILD_MIN_SIZE ||
+        ++this->spatial_cost_check_counter < SPATIAL_COST_CHECK_INTERVAL) {
+        return;
+    }
+    this->spatial_cost_check_counter = 0;
+    float cost = this->spatial_index.cost();
+    if(cost <= this->spatial_rebuild_cost * SPATIAL_REBUILD_THRESHOLD) {
+        return;
+    }
+    DEBUG("Rebuilding spatial index [size: %lu] [cost: %.1f -> %.1f]",
+        this->spatial_index.size(), this->spatial_rebuild_cost, cost);
+    auto rebuild = std::make_shared<se::util::BVHBuild>();
+    this->spatial_index.begin_rebuild(*rebuild);
+    this->spatial_rebuild = rebuild;
+    this->engine->worker_pool->submit([rebuild](){
+        se::util::BVH::build(*rebuild);
+        rebuild->complete = true;
+    });
+}
+
+void Scene::index_entity(se::Entity* entity, const glm::mat4& model_matrix) {
+    glm::vec3 center;
+    float radius;
+    auto proxy = this->spatial_proxies.find(entity);
+    if(entity->get_bounds(model_matrix, center, radius)) {
+        glm::vec3 extent(radius, radius, radius);
+        se::util::AABB box = {center - extent, center + extent};
+        if(proxy == this->spatial_proxies.end()) {
+            this->spatial_proxies[entity] = this->spatial_index.insert(box, entity);
+        } else {
+            this->spatial_index.move(proxy->second, box);
+        }
+    } else if(proxy != this->spatial_proxies.end()) {
+        this->spatial_index.remove(proxy->second);
+        this->spatial_proxies.erase(proxy);
+    }
+}
+
+void Scene::spatial_results(std::vector<void*>& found,
+    std::vector<se::Entity*>& results) {
+    for(void* entity : found) {
+        results.push_back((se::Entity*) entity);
+    }
+}
+
 // ====================
 // == PUBLIC MEMBERS ==
 // ====================
@@ -50,13 +156,21 @@ void Scene::generate_default_wrapped_entity_constructors() {
 Scene::Scene(se::Engine* engine) {
     this->engine = engine;
     this->generate_default_wrapped_entity_constructors();
+    if(engine->config->get_bool("logic.component_store", true)) {
+        this->components = std::make_unique<se::ComponentStore>();
+    }
+    engine->logic_controller->register_sync_handler(this,
+        [this](){ this->update_spatial_index(); });
 }
 
 Scene::~Scene() {
+    this->engine->logic_controller->deregister_sync_handler(this);
     // Remove everything from the active lists before deleting
     this->renderable_entities.clear();
     this->tickable_entities.clear();
     this->all_entities.clear();
+    // Hand the transforms back before the entities are deleted
+    this->components = nullptr;
     // Delete the entities
     for(auto entity : this->internally_loaded) {
         delete entity;
@@ -104,19 +218,22 @@ void Scene::load_scene(const char* fname) {
         try {
             /* Apply global options to entity */
             if(entity.find("pos") != entity.end()) {
-                new_ent->x = entity["pos"].value("x", 0.0);
-                new_ent->y = entity["pos"].value("y", 0.0);
-                new_ent->z = entity["pos"].value("z", 0.0);
+                new_ent->set_position(
+                    entity["pos"].value("x", 0.0),
+                    entity["pos"].value("y", 0.0),
+                    entity["pos"].value("z", 0.0));
             }
             if(entity.find("rot") != entity.end()) {
-                new_ent->rx = entity["rot"].value("x", 0.0);
-                new_ent->ry = entity["rot"].value("y", 0.0);
-                new_ent->rz = entity["rot"].value("z", 0.0);
+                new_ent->set_rotation(
+                    entity["rot"].value("x", 0.0),
+                    entity["rot"].value("y", 0.0),
+                    entity["rot"].value("z", 0.0));
             }
             if(entity.find("scale") != entity.end()) {
-                new_ent->sx = entity["scale"].value("x", 1.0);
-                new_ent->sy = entity["scale"].value("y", 1.0);
-                new_ent->sz = entity["scale"].value("z", 1.0);
+                new_ent->set_scale(
+                    entity["scale"].value("x", 1.0),
+                    entity["scale"].value("y", 1.0),
+                    entity["scale"].value("z", 1.0));
             }
         }
         catch(std::exception& e) {
@@ -127,6 +244,22 @@ void Scene::load_scene(const char* fname) {
         this->internally_loaded.push_back(new_ent);
         this->register_entity(new_ent);
     }
+    // Attach children once every entity they could refer to exists
+    for(auto entity : scene_data["entities"]) {
+        if(entity.find("parent") == entity.end()) {
+            continue;
+        }
+        std::string ename = entity.value<std::string>("name","<invalid>");
+        std::string pname = entity.value<std::string>("parent","<invalid>");
+        Entity* child = this->get_entity(ename.c_str());
+        Entity* parent = this->get_entity(pname.c_str());
+        if(child == nullptr || parent == nullptr) {
+            WARN("Failed to attach [%s] to parent [%s]", ename.c_str(),
+                pname.c_str());
+            continue;
+        }
+        child->set_parent(parent);
+    }
     
 }
 
@@ -142,6 +275,10 @@ std::map<uint8_t, se::Entity*>* Scene::get_entities() {
     return &this->all_entities;
 }
 
+se::ComponentStore* Scene::get_components() {
+    return this->components.get();
+}
+
 void Scene::register_entity(se::Entity* entity) {
     uint8_t entity_hash = se::util::hash::ejenkins("%s", entity->get_name());
 
@@ -156,12 +293,18 @@ void Scene::register_entity(se::Entity* entity) {
     this->all_entities.insert(std::pair(entity_hash, entity));
 
     if(entity->is_renderable()) {
+        // The spatial index walks this list when there is no component store
+        std::lock_guard<std::mutex> lock(this->spatial_index_mutex);
         this->renderable_entities.push_back(entity);
     }
 
     if(entity->is_tickable()) {
         this->tickable_entities.push_back(entity);
     }
+
+    if(this->components != nullptr) {
+        this->components->insert(entity);
+    }
 }
 
 void Scene::deregister_entity(se::Entity* entity) {
@@ -177,12 +320,25 @@ void Scene::deregister_entity(se::Entity* entity) {
     if(iter != this->all_entities.end()) {
         this->all_entities.erase(iter);
     }
-    // Delete from other lists
-    for(size_t i = 0; i < this->renderable_entities.size(); i++) {
-        if(this->renderable_entities[i] == entity) {
-            this->renderable_entities.erase(this->renderable_entities.begin() + i);
+    // Delete from the component store
+    if(this->components != nullptr) {
+        this->components->remove(entity);
+    }
+    // Delete from the spatial index
+    {
+        std::lock_guard<std::mutex> lock(this->spatial_index_mutex);
+        auto proxy = this->spatial_proxies.find(entity);
+        if(proxy != this->spatial_proxies.end()) {
+            this->spatial_index.remove(proxy->second);
+            this->spatial_proxies.erase(proxy);
+        }
+        for(size_t i = 0; i < this->renderable_entities.size(); i++) {
+            if(this->renderable_entities[i] == entity) {
+                this->renderable_entities.erase(this->renderable_entities.begin() + i);
+            }
         }
     }
+    // Delete from other lists
     for(size_t i = 0; i < this->tickable_entities.size(); i++) {
         if(this->tickable_entities[i] == entity) {
             this->tickable_entities.erase(this->tickable_entities.begin() + i);
@@ -209,4 +365,38 @@ se::Entity* Scene::get_entity(const char* name) {
     } else {
         return find->second;
     }
+}
+
+void Scene::query_frustum(const glm::mat4& camera_matrix,
+    std::vector<se::Entity*>& results) {
+    glm::vec4 planes[6];
+    se::util::frustum::extract_planes(camera_matrix, planes);
+    std::vector<void*> found;
+    std::lock_guard<std::mutex> lock(this->spatial_index_mutex);
+    this->spatial_index.query_frustum(planes, found);
+    this->spatial_results(found, results);
+}
+
+void Scene::query_ray(glm::vec3 origin, glm::vec3 direction, float max_distance,
+    std::vector<se::Entity*>& results) {
+    std::vector<void*> found;
+    std::lock_guard<std::mutex> lock(this->spatial_index_mutex);
+    this->spatial_index.query_ray(origin, direction, max_distance, found);
+    this->spatial_results(found, results);
+}
+
+void Scene::query_sphere(glm::vec3 center, float radius,
+    std::vector<se::Entity*>& results) {
+    std::vector<void*> found;
+    std::lock_guard<std::mutex> lock(this->spatial_index_mutex);
+    this->spatial_index.query_sphere(center, radius, found);
+    this->spatial_results(found, results);
+}
+
+void Scene::query_aabb(glm::vec3 min, glm::vec3 max,
+    std::vector<se::Entity*>& results) {
+    std::vector<void*> found;
+    std::lock_guard<std::mutex> lock(this->spatial_index_mutex);
+    this->spatial_index.query_aabb({min, max}, found);
+    this->spatial_results(found, results);
 }
\ No newline at end of file
@@ -0,0 +1,695 @@
+/*!
+ *  @file src/se/util/bvh.cpp
+ *
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ *
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/util/bvh.hpp"
+
+#include "se/util/log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+using namespace se::util;
+
+/// Number of bins used when searching for SAH splits
+#define BVH_SAH_BINS 16
+
+// ======================
+// == HELPER FUNCTIONS ==
+// ======================
+
+static inline AABB merge(const AABB& a, const AABB& b) {
+    AABB result;
+    for(int i = 0; i < 3; i++) {
+        result.min[i] = std::min(a.min[i], b.min[i]);
+        result.max[i] = std::max(a.max[i], b.max[i]);
+    }
+    return result;
+}
+
+static inline float surface_area(const AABB& box) {
+    float dx = box.max.x - box.min.x;
+    float dy = box.max.y - box.min.y;
+    float dz = box.max.z - box.min.z;
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static inline bool contains(const AABB& outer, const AABB& inner) {
+    for(int i = 0; i < 3; i++) {
+        if(inner.min[i] < outer.min[i] || inner.max[i] > outer.max[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline bool overlaps(const AABB& a, const AABB& b) {
+    for(int i = 0; i < 3; i++) {
+        if(a.max[i] < b.min[i] || a.min[i] > b.max[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline bool is_leaf(const BVHNode& node) {
+    return node.children[0] == -1;
+}
+
+// =====================
+// == PRIVATE METHODS ==
+// =====================
+
+int32_t BVH::allocate_node() {
+    if(this->free_list != -1) {
+        int32_t node = this->free_list;
+        this->free_list = this->nodes[node].proxy;
+        return node;
+    }
+    this->nodes.emplace_back();
+    return this->nodes.size() - 1;
+}
+
+void BVH::release_node(int32_t node) {
+    this->nodes[node].proxy = this->free_list;
+    this->nodes[node].parent = -1;
+    this->free_list = node;
+}
+
+void BVH::insert_leaf(int32_t proxy) {
+    int32_t leaf = this->allocate_node();
+    AABB leaf_box = this->proxies[proxy].box;
+    this->nodes[leaf].box = leaf_box;
+    this->nodes[leaf].parent = -1;
+    this->nodes[leaf].children[0] = -1;
+    this->nodes[leaf].children[1] = -1;
+    this->nodes[leaf].proxy = proxy;
+    this->proxies[proxy].node = leaf;
+
+    if(this->root == -1) {
+        this->root = leaf;
+        return;
+    }
+
+    /* Descend towards the sibling which increases the total surface area the
+    least.  Every ancestor of the new leaf grows, which is accounted for by
+    the inheritance cost. */
+    int32_t index = this->root;
+    while(!is_leaf(this->nodes[index])) {
+        const BVHNode& node = this->nodes[index];
+        float area = surface_area(node.box);
+        float combined_area = surface_area(merge(node.box, leaf_box));
+        // Cost of making a new parent for this node and the leaf
+        float cost = 2.0f * combined_area;
+        // Minimum cost of pushing the leaf further down
+        float inheritance_cost = 2.0f * (combined_area - area);
+        float child_cost[2];
+        for(int i = 0; i < 2; i++) {
+            const BVHNode& child = this->nodes[node.children[i]];
+            float merged_area = surface_area(merge(child.box, leaf_box));
+            if(is_leaf(child)) {
+                child_cost[i] = merged_area + inheritance_cost;
+            } else {
+                child_cost[i] = merged_area - surface_area(child.box) + inheritance_cost;
+            }
+        }
+        if(cost < child_cost[0] && cost < child_cost[1]) {
+            break;
+        }
+        index = child_cost[0] < child_cost[1] ? node.children[0] : node.children[1];
+    }
+
+    int32_t sibling = index;
+    int32_t old_parent = this->nodes[sibling].parent;
+    int32_t new_parent = this->allocate_node();
+    this->nodes[new_parent].parent = old_parent;
+    this->nodes[new_parent].box = merge(this->nodes[sibling].box, leaf_box);
+    this->nodes[new_parent].children[0] = sibling;
+    this->nodes[new_parent].children[1] = leaf;
+    this->nodes[new_parent].proxy = -1;
+    this->nodes[sibling].parent = new_parent;
+    this->nodes[leaf].parent = new_parent;
+    if(old_parent == -1) {
+        this->root = new_parent;
+    } else {
+        BVHNode& parent = this->nodes[old_parent];
+        parent.children[parent.children[0] == sibling ? 0 : 1] = new_parent;
+        this->refit(old_parent);
+    }
+}
+
+void BVH::remove_leaf(int32_t proxy) {
+    int32_t leaf = this->proxies[proxy].node;
+    this->proxies[proxy].node = -1;
+    if(leaf == this->root) {
+        this->root = -1;
+        this->release_node(leaf);
+        return;
+    }
+    int32_t parent = this->nodes[leaf].parent;
+    int32_t grandparent = this->nodes[parent].parent;
+    const BVHNode& parent_node = this->nodes[parent];
+    int32_t sibling = parent_node.children[0] == leaf ?
+        parent_node.children[1] : parent_node.children[0];
+    if(grandparent == -1) {
+        this->root = sibling;
+        this->nodes[sibling].parent = -1;
+    } else {
+        BVHNode& grandparent_node = this->nodes[grandparent];
+        grandparent_node.children[grandparent_node.children[0] == parent ? 0 : 1] = sibling;
+        this->nodes[sibling].parent = grandparent;
+        this->refit(grandparent);
+    }
+    this->release_node(parent);
+    this->release_node(leaf);
+}
+
+void BVH::refit(int32_t node) {
+    while(node != -1) {
+        BVHNode& current = this->nodes[node];
+        current.box = merge(this->nodes[current.children[0]].box,
+            this->nodes[current.children[1]].box);
+        node = current.parent;
+    }
+}
+
+void BVH::collect(int32_t node, std::vector<void*>& results) {
+    std::vector<int32_t> stack;
+    stack.push_back(node);
+    while(!stack.empty()) {
+        const BVHNode& current = this->nodes[stack.back()];
+        stack.pop_back();
+        if(is_leaf(current)) {
+            results.push_back(this->proxies[current.proxy].user_data);
+        } else {
+            stack.push_back(current.children[0]);
+            stack.push_back(current.children[1]);
+        }
+    }
+}
+
+int32_t BVH::build_node(BVHBuild& build, size_t begin, size_t end, int32_t parent) {
+    int32_t index = build.nodes.size();
+    build.nodes.emplace_back();
+    build.nodes[index].parent = parent;
+    build.nodes[index].proxy = -1;
+
+    AABB box = build.leaves[begin].box;
+    AABB centroids;
+    centroids.min = centroids.max = (box.min + box.max) * 0.5f;
+    for(size_t i = begin; i < end; i++) {
+        const AABB& leaf_box = build.leaves[i].box;
+        box = merge(box, leaf_box);
+        glm::vec3 centroid = (leaf_box.min + leaf_box.max) * 0.5f;
+        centroids = merge(centroids, {centroid, centroid});
+    }
+    build.nodes[index].box = box;
+
+    if(end - begin == 1) {
+        build.nodes[index].children[0] = -1;
+        build.nodes[index].children[1] = -1;
+        build.nodes[index].proxy = build.leaves[begin].proxy;
+        return index;
+    }
+
+    // Split along the axis with the largest centroid extent
+    int axis = 0;
+    glm::vec3 extent = centroids.max - centroids.min;
+    if(extent.y > extent[axis]) { axis = 1; }
+    if(extent.z > extent[axis]) { axis = 2; }
+    size_t middle = (begin + end) / 2;
+    auto leaf_centroid = [axis](const BVHLeaf& leaf) {
+        return leaf.box.min[axis] + leaf.box.max[axis];
+    };
+
+    if(extent[axis] > 0.0) {
+        // Bin the leaves by centroid, then find the cheapest split
+        unsigned int bin_count[BVH_SAH_BINS] = {0};
+        AABB bin_box[BVH_SAH_BINS];
+        float bin_scale = BVH_SAH_BINS / extent[axis];
+        float bin_offset = centroids.min[axis];
+        auto bin_of = [&](const BVHLeaf& leaf) {
+            int bin = (int) ((leaf_centroid(leaf) * 0.5f - bin_offset) * bin_scale);
+            return std::min(std::max(bin, 0), BVH_SAH_BINS - 1);
+        };
+        for(size_t i = begin; i < end; i++) {
+            int bin = bin_of(build.leaves[i]);
+            bin_box[bin] = bin_count[bin] == 0 ? build.leaves[i].box :
+                merge(bin_box[bin], build.leaves[i].box);
+            bin_count[bin]++;
+        }
+        // Sweep from the right to find the cost of everything after each split
+        float right_cost[BVH_SAH_BINS];
+        AABB right_box;
+        unsigned int right_count = 0;
+        for(int i = BVH_SAH_BINS - 1; i > 0; i--) {
+            if(bin_count[i] > 0) {
+                right_box = right_count == 0 ? bin_box[i] : merge(right_box, bin_box[i]);
+                right_count += bin_count[i];
+            }
+            right_cost[i] = right_count == 0 ? 0.0f : surface_area(right_box) * right_count;
+        }
+        // Sweep from the left, looking for the split with the lowest cost
+        float best_cost = INFINITY;
+        int best_split = -1;
+        AABB left_box;
+        unsigned int left_count = 0;
+        for(int i = 0; i < BVH_SAH_BINS - 1; i++) {
+            if(bin_count[i] > 0) {
+                left_box = left_count == 0 ? bin_box[i] : merge(left_box, bin_box[i]);
+                left_count += bin_count[i];
+            }
+            if(left_count == 0 || left_count == end - begin) {
+                continue;
+            }
+            float cost = surface_area(left_box) * left_count + right_cost[i + 1];
+            if(cost < best_cost) {
+                best_cost = cost;
+                best_split = i;
+            }
+        }
+        if(best_split != -1) {
+            auto split = std::partition(build.leaves.begin() + begin,
+                build.leaves.begin() + end, [&](const BVHLeaf& leaf) {
+                    return bin_of(leaf) <= best_split;
+                });
+            middle = split - build.leaves.begin();
+        }
+    }
+    if(middle == begin || middle == end) {
+        // Everything is in one place, split evenly
+        middle = (begin + end) / 2;
+        std::nth_element(build.leaves.begin() + begin, build.leaves.begin() + middle,
+            build.leaves.begin() + end, [&](const BVHLeaf& a, const BVHLeaf& b) {
+                return leaf_centroid(a) < leaf_centroid(b);
+            });
+    }
+
+    int32_t left = build_node(build, begin, middle, index);
+    int32_t right = build_node(build, middle, end, index);
+    build.nodes[index].children[0] = left;
+    build.nodes[index].children[1] = right;
+    return index;
+}
+
+// ====================
+// == PUBLIC METHODS ==
+// ====================
+
+BVH::BVH(float margin) {
+    this->margin = margin;
+}
+
+int32_t BVH::insert(const AABB& box, void* user_data) {
+    int32_t proxy;
+    if(this->free_proxies.size() > 0) {
+        proxy = this->free_proxies.back();
+        this->free_proxies.pop_back();
+    } else {
+        proxy = this->proxies.size();
+        this->proxies.emplace_back();
+    }
+    glm::vec3 margin(this->margin, this->margin, this->margin);
+    this->proxies[proxy].box = {box.min - margin, box.max + margin};
+    this->proxies[proxy].user_data = user_data;
+    this->proxies[proxy].alive = true;
+    this->insert_leaf(proxy);
+    this->proxy_count++;
+    if(this->tracking) {
+        this->changed.push_back(proxy);
+    }
+    return proxy;
+}
+
+void BVH::remove(int32_t proxy) {
+    this->remove_leaf(proxy);
+    this->proxies[proxy].alive = false;
+    this->free_proxies.push_back(proxy);
+    this->proxy_count--;
+    if(this->tracking) {
+        this->changed.push_back(proxy);
+    }
+}
+
+bool BVH::move(int32_t proxy, const AABB& box) {
+    if(contains(this->proxies[proxy].box, box)) {
+        return false;
+    }
+    this->remove_leaf(proxy);
+    glm::vec3 margin(this->margin, this->margin, this->margin);
+    this->proxies[proxy].box = {box.min - margin, box.max + margin};
+    this->insert_leaf(proxy);
+    if(this->tracking) {
+        this->changed.push_back(proxy);
+    }
+    return true;
+}
+
+void* BVH::get_user_data(int32_t proxy) {
+    return this->proxies[proxy].user_data;
+}
+
+size_t BVH::size() {
+    return this->proxy_count;
+}
+
+float BVH::cost() {
+    if(this->root == -1) {
+        return 0.0;
+    }
+    float root_area = surface_area(this->nodes[this->root].box);
+    if(root_area <= 0.0) {
+        return 0.0;
+    }
+    float total_area = 0.0;
+    std::vector<int32_t> stack;
+    stack.push_back(this->root);
+    while(!stack.empty()) {
+        const BVHNode& node = this->nodes[stack.back()];
+        stack.pop_back();
+        if(!is_leaf(node)) {
+            total_area += surface_area(node.box);
+            stack.push_back(node.children[0]);
+            stack.push_back(node.children[1]);
+        }
+    }
+    return total_area / root_area;
+}
+
+void BVH::query_aabb(const AABB& box, std::vector<void*>& results) {
+    if(this->root == -1) {
+        return;
+    }
+    std::vector<int32_t> stack;
+    stack.push_back(this->root);
+    while(!stack.empty()) {
+        const BVHNode& node = this->nodes[stack.back()];
+        stack.pop_back();
+        if(!overlaps(node.box, box)) {
+            continue;
+        }
+        if(is_leaf(node)) {
+            results.push_back(this->proxies[node.proxy].user_data);
+        } else {
+            stack.push_back(node.children[0]);
+            stack.push_back(node.children[1]);
+        }
+    }
+}
+
+void BVH::query_sphere(glm::vec3 center, float radius, std::vector<void*>& results) {
+    if(this->root == -1) {
+        return;
+    }
+    float radius_squared = radius * radius;
+    std::vector<int32_t> stack;
+    stack.push_back(this->root);
+    while(!stack.empty()) {
+        const BVHNode& node = this->nodes[stack.back()];
+        stack.pop_back();
+        // Distance from the center to the closest point in the box
+        float distance_squared = 0.0;
+        for(int i = 0; i < 3; i++) {
+            float d = std::max(std::max(node.box.min[i] - center[i], center[i] - node.box.max[i]), 0.0f);
+            distance_squared += d * d;
+        }
+        if(distance_squared > radius_squared) {
+            continue;
+        }
+        if(is_leaf(node)) {
+            results.push_back(this->proxies[node.proxy].user_data);
+        } else {
+            stack.push_back(node.children[0]);
+            stack.push_back(node.children[1]);
+        }
+    }
+}
+
+void BVH::query_ray(glm::vec3 origin, glm::vec3 direction, float max_distance,
+    std::vector<void*>& results) {
+    if(this->root == -1) {
+        return;
+    }
+    // Division by zero gives infinities, which the slab test handles
+    glm::vec3 inverse(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    std::vector<int32_t> stack;
+    stack.push_back(this->root);
+    while(!stack.empty()) {
+        const BVHNode& node = this->nodes[stack.back()];
+        stack.pop_back();
+        float t_min = 0.0;
+        float t_max = max_distance;
+        for(int i = 0; i < 3; i++) {
+            float t0 = (node.box.min[i] - origin[i]) * inverse[i];
+            float t1 = (node.box.max[i] - origin[i]) * inverse[i];
+            if(t0 > t1) { std::swap(t0, t1); }
+            // Written so that NaN (0 * infinity) leaves the range unchanged
+            t_min = t0 > t_min ? t0 : t_min;
+            t_max = t1 < t_max ? t1 : t_max;
+        }
+        if(t_min > t_max) {
+            continue;
+        }
+        if(is_leaf(node)) {
+            results.push_back(this->proxies[node.proxy].user_data);
+        } else {
+            stack.push_back(node.children[0]);
+            stack.push_back(node.children[1]);
+        }
+    }
+}
+
+void BVH::query_frustum(const glm::vec4 planes[6], std::vector<void*>& results) {
+    if(this->root == -1) {
+        return;
+    }
+    std::vector<int32_t> stack;
+    stack.push_back(this->root);
+    while(!stack.empty()) {
+        int32_t index = stack.back();
+        const BVHNode& node = this->nodes[index];
+        stack.pop_back();
+        /* Test the corner furthest along each plane normal (outside if it is
+        behind the plane) and the nearest corner (fully inside if every one of
+        them is in front of its plane). */
+        bool outside = false;
+        bool inside = true;
+        for(int p = 0; p < 6 && !outside; p++) {
+            const glm::vec4& plane = planes[p];
+            float far_distance = plane.w;
+            float near_distance = plane.w;
+            for(int i = 0; i < 3; i++) {
+                if(plane[i] >= 0.0) {
+                    far_distance += plane[i] * node.box.max[i];
+                    near_distance += plane[i] * node.box.min[i];
+                } else {
+                    far_distance += plane[i] * node.box.min[i];
+                    near_distance += plane[i] * node.box.max[i];
+                }
+            }
+            outside = far_distance < 0.0;
+            inside = inside && near_distance >= 0.0;
+        }
+        if(outside) {
+            continue;
+        }
+        if(inside) {
+            this->collect(index, results);
+        } else if(is_leaf(node)) {
+            results.push_back(this->proxies[node.proxy].user_data);
+        } else {
+            stack.push_back(node.children[0]);
+            stack.push_back(node.children[1]);
+        }
+    }
+}
+
+void BVH::rebuild() {
+    BVHBuild build;
+    this->begin_rebuild(build);
+    BVH::build(build);
+    this->finish_rebuild(build);
+}
+
+void BVH::begin_rebuild(BVHBuild& build) {
+    build.leaves.clear();
+    build.leaves.reserve(this->proxy_count);
+    for(size_t i = 0; i < this->proxies.size(); i++) {
+        if(this->proxies[i].alive) {
+            build.leaves.push_back({(int32_t) i, this->proxies[i].box});
+        }
+    }
+    build.nodes.clear();
+    build.root = -1;
+    build.complete = false;
+    this->tracking = true;
+    this->changed.clear();
+}
+
+void BVH::build(BVHBuild& build) {
+    build.nodes.clear();
+    build.nodes.reserve(build.leaves.size() * 2);
+    build.root = -1;
+    if(build.leaves.size() > 0) {
+        build.root = build_node(build, 0, build.leaves.size(), -1);
+    }
+}
+
+void BVH::finish_rebuild(BVHBuild& build) {
+    this->nodes.swap(build.nodes);
+    this->root = build.root;
+    this->free_list = -1;
+    for(auto& proxy : this->proxies) {
+        proxy.node = -1;
+    }
+    for(size_t i = 0; i < this->nodes.size(); i++) {
+        if(is_leaf(this->nodes[i])) {
+            this->proxies[this->nodes[i].proxy].node = i;
+        }
+    }
+
+    // Anything that changed while the tree was being built is done again
+    this->tracking = false;
+    std::sort(this->changed.begin(), this->changed.end());
+    this->changed.erase(std::unique(this->changed.begin(), this->changed.end()),
+        this->changed.end());
+    for(int32_t proxy : this->changed) {
+        if(this->proxies[proxy].node != -1) {
+            this->remove_leaf(proxy);
+        }
+        if(this->proxies[proxy].alive) {
+            this->insert_leaf(proxy);
+        }
+    }
+    this->changed.clear();
+    build.nodes.clear();
+    build.leaves.clear();
+}
+
+void BVH::benchmark(size_t object_count) {
+    INFO("BVH benchmark with %lu objects", object_count);
+    std::mt19937 random(1234);
+    // Keep the density constant, about one object per 1000 cubic meters
+    float world_size = std::cbrt((float) object_count) * 10.0f;
+    std::uniform_real_distribution<float> position(0.0, world_size);
+    std::uniform_real_distribution<float> size(0.5, 2.0);
+    std::uniform_real_distribution<float> jitter(-0.05, 0.05);
+    std::uniform_real_distribution<float> unit(-1.0, 1.0);
+
+    std::vector<AABB> boxes(object_count);
+    for(auto& box : boxes) {
+        glm::vec3 center(position(random), position(random), position(random));
+        glm::vec3 half(size(random), size(random), size(random));
+        box = {center - half, center + half};
+    }
+
+    auto now = [](){ return std::chrono::steady_clock::now(); };
+    auto elapsed_ms = [](auto start, auto end) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1000000.0;
+    };
+
+    BVH bvh;
+    std::vector<int32_t> proxies(object_count);
+    auto start = now();
+    for(size_t i = 0; i < object_count; i++) {
+        proxies[i] = bvh.insert(boxes[i], &boxes[i]);
+    }
+    INFO("  Incremental insert: %.3fms (cost %.1f)", elapsed_ms(start, now()), bvh.cost());
+
+    start = now();
+    bvh.rebuild();
+    INFO("  SAH rebuild: %.3fms (cost %.1f)", elapsed_ms(start, now()), bvh.cost());
+
+    // Small movements mostly stay within the fat boxes
+    start = now();
+    size_t reinserted = 0;
+    for(size_t i = 0; i < object_count; i++) {
+        glm::vec3 offset(jitter(random), jitter(random), jitter(random));
+        boxes[i] = {boxes[i].min + offset, boxes[i].max + offset};
+        reinserted += bvh.move(proxies[i], boxes[i]);
+    }
+    INFO("  Move all (small): %.3fms (%lu reinserted)", elapsed_ms(start, now()), reinserted);
+
+    // Large movements always need the tree to be updated
+    start = now();
+    size_t moved = object_count / 10;
+    for(size_t i = 0; i < moved; i++) {
+        glm::vec3 center(position(random), position(random), position(random));
+        glm::vec3 half = (boxes[i].max - boxes[i].min) * 0.5f;
+        boxes[i] = {center - half, center + half};
+        bvh.move(proxies[i], boxes[i]);
+    }
+    INFO("  Move 10%% (teleport): %.3fms (cost %.1f)", elapsed_ms(start, now()), bvh.cost());
+
+    const int query_count = 1000;
+    std::vector<void*> results;
+    size_t result_count = 0;
+    start = now();
+    for(int i = 0; i < query_count; i++) {
+        glm::vec3 center(position(random), position(random), position(random));
+        glm::vec3 half(5.0, 5.0, 5.0);
+        results.clear();
+        bvh.query_aabb({center - half, center + half}, results);
+        result_count += results.size();
+    }
+    INFO("  %i AABB queries: %.3fms (%lu results)", query_count, elapsed_ms(start, now()), result_count);
+
+    // The same queries by brute force, for comparison
+    std::mt19937 brute_random(5678);
+    start = now();
+    result_count = 0;
+    for(int i = 0; i < query_count / 10; i++) {
+        glm::vec3 center(position(brute_random), position(brute_random), position(brute_random));
+        glm::vec3 half(5.0, 5.0, 5.0);
+        AABB query = {center - half, center + half};
+        for(auto& box : boxes) {
+            result_count += overlaps(box, query);
+        }
+    }
+    INFO("  %i AABB queries (linear scan): %.3fms (%lu results)", query_count / 10,
+        elapsed_ms(start, now()), result_count);
+
+    start = now();
+    result_count = 0;
+    for(int i = 0; i < query_count; i++) {
+        glm::vec3 center(position(random), position(random), position(random));
+        results.clear();
+        bvh.query_sphere(center, 5.0, results);
+        result_count += results.size();
+    }
+    INFO("  %i sphere queries: %.3fms (%lu results)", query_count, elapsed_ms(start, now()), result_count);
+
+    start = now();
+    result_count = 0;
+    for(int i = 0; i < query_count; i++) {
+        glm::vec3 origin(position(random), position(random), position(random));
+        glm::vec3 direction(unit(random), unit(random), unit(random));
+        results.clear();
+        bvh.query_ray(origin, direction, 100.0, results);
+        result_count += results.size();
+    }
+    INFO("  %i ray queries: %.3fms (%lu results)", query_count, elapsed_ms(start, now()), result_count);
+
+    // Box shaped frustums covering about a thousandth of the world each
+    start = now();
+    result_count = 0;
+    for(int i = 0; i < query_count; i++) {
+        glm::vec3 center(position(random), position(random), position(random));
+        float half = world_size * 0.05f;
+        glm::vec4 planes[6] = {
+            { 1.0,  0.0,  0.0, half - center.x}, {-1.0,  0.0,  0.0, half + center.x},
+            { 0.0,  1.0,  0.0, half - center.y}, { 0.0, -1.0,  0.0, half + center.y},
+            { 0.0,  0.0,  1.0, half - center.z}, { 0.0,  0.0, -1.0, half + center.z}
+        };
+        results.clear();
+        bvh.query_frustum(planes, results);
+        result_count += results.size();
+    }
+    INFO("  %i frustum queries: %.3fms (%lu results)", query_count, elapsed_ms(start, now()), result_count);
+}
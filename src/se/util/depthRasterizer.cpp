@@ -0,0 +1,416 @@
+/*!
+ *  @file src/se/util/depthRasterizer.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/util/depthRasterizer.hpp"
+
+#include "se/util/log.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace se::util;
+
+/// Triangles with less screen space area than this are skipped
+#define MIN_TRIANGLE_AREA 1e-6
+
+/// Box triangles, as indices into the corner array
+static const uint8_t box_indices[36] = {
+    0, 2, 1,  1, 2, 3,
+    4, 5, 6,  5, 7, 6,
+    0, 1, 4,  1, 5, 4,
+    2, 6, 3,  3, 6, 7,
+    0, 4, 2,  2, 4, 6,
+    1, 3, 5,  3, 7, 5,
+};
+
+/// Get the corners of a box
+static void box_corners(glm::vec3 min, glm::vec3 max, glm::vec4 corners[8]) {
+    for(int i = 0; i < 8; i++) {
+        corners[i] = glm::vec4(
+            (i & 1) ? max.x : min.x,
+            (i & 2) ? max.y : min.y,
+            (i & 4) ? max.z : min.z, 1.0);
+    }
+}
+
+// =====================
+// == PRIVATE METHODS ==
+// =====================
+
+void DepthRasterizer::setup_triangle(const glm::vec4& a, const glm::vec4& b,
+    const glm::vec4& c) {
+    // Project to pixel coordinates, with inverse W as the depth
+    float x[3], y[3], z[3];
+    const glm::vec4* vertices[3] = {&a, &b, &c};
+    for(int i = 0; i < 3; i++) {
+        float inverse_w = 1.0 / vertices[i]->w;
+        x[i] = (vertices[i]->x * inverse_w * 0.5 + 0.5) * this->width;
+        y[i] = (vertices[i]->y * inverse_w * 0.5 + 0.5) * this->height;
+        z[i] = inverse_w;
+    }
+
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if(std::abs(area) < MIN_TRIANGLE_AREA) {
+        return;
+    }
+    // Both sides are drawn, so flip clockwise triangles
+    if(area < 0) {
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(z[1], z[2]);
+        area = -area;
+    }
+
+    Triangle triangle;
+    triangle.min_x = std::max((int) std::floor(std::min(x[0], std::min(x[1], x[2]))), 0);
+    triangle.min_y = std::max((int) std::floor(std::min(y[0], std::min(y[1], y[2]))), 0);
+    triangle.max_x = std::min((int) std::ceil(std::max(x[0], std::max(x[1], x[2]))), (int) this->width - 1);
+    triangle.max_y = std::min((int) std::ceil(std::max(y[0], std::max(y[1], y[2]))), (int) this->height - 1);
+    if(triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y) {
+        return;
+    }
+    // Edge functions are positive on the inside of each edge
+    for(int i = 0; i < 3; i++) {
+        int j = (i + 1) % 3;
+        triangle.edge_a[i] = y[i] - y[j];
+        triangle.edge_b[i] = x[j] - x[i];
+        triangle.edge_c[i] = -(triangle.edge_a[i] * x[i] + triangle.edge_b[i] * y[i]);
+    }
+    triangle.depth_a = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+    triangle.depth_b = ((x[1] - x[0]) * (z[2] - z[0]) - (x[2] - x[0]) * (z[1] - z[0])) / area;
+    triangle.depth_c = z[0] - triangle.depth_a * x[0] - triangle.depth_b * y[0];
+    this->triangles.push_back(triangle);
+}
+
+// ====================
+// == PUBLIC METHODS ==
+// ====================
+
+DepthRasterizer::DepthRasterizer(unsigned int width, unsigned int height) {
+    this->tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+    this->tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+    this->width = this->tiles_x * TILE_SIZE;
+    this->height = this->tiles_y * TILE_SIZE;
+    this->depth.resize(this->width * this->height, 0.0);
+    this->tile_depth.resize(this->tiles_x * this->tiles_y, 0.0);
+}
+
+void DepthRasterizer::clear() {
+    this->triangles.clear();
+    std::fill(this->depth.begin(), this->depth.end(), 0.0);
+    std::fill(this->tile_depth.begin(), this->tile_depth.end(), 0.0);
+}
+
+void DepthRasterizer::add_triangle(const glm::vec4& a, const glm::vec4& b,
+    const glm::vec4& c) {
+    /* Clip against the near plane (z = -w).  Anything in front of it would
+    project behind the camera. */
+    const glm::vec4* input[3] = {&a, &b, &c};
+    glm::vec4 output[4];
+    int output_count = 0;
+    for(int i = 0; i < 3; i++) {
+        const glm::vec4& current = *input[i];
+        const glm::vec4& next = *input[(i + 1) % 3];
+        float current_distance = current.z + current.w;
+        float next_distance = next.z + next.w;
+        if(current_distance >= 0) {
+            output[output_count++] = current;
+        }
+        if((current_distance >= 0) != (next_distance >= 0)) {
+            float t = current_distance / (current_distance - next_distance);
+            output[output_count++] = current + (next - current) * t;
+        }
+    }
+    for(int i = 2; i < output_count; i++) {
+        this->setup_triangle(output[0], output[i - 1], output[i]);
+    }
+}
+
+void DepthRasterizer::add_box(const glm::mat4& matrix, glm::vec3 min, glm::vec3 max) {
+    glm::vec4 corners[8];
+    box_corners(min, max, corners);
+    for(int i = 0; i < 8; i++) {
+        corners[i] = matrix * corners[i];
+    }
+    for(int i = 0; i < 36; i += 3) {
+        this->add_triangle(corners[box_indices[i]], corners[box_indices[i + 1]],
+            corners[box_indices[i + 2]]);
+    }
+}
+
+unsigned int DepthRasterizer::get_band_count() {
+    return this->tiles_y;
+}
+
+void DepthRasterizer::rasterize_band(unsigned int band) {
+    int band_min_y = band * TILE_SIZE;
+    int band_max_y = band_min_y + TILE_SIZE - 1;
+    for(const Triangle& triangle : this->triangles) {
+        if(triangle.max_y < band_min_y || triangle.min_y > band_max_y) {
+            continue;
+        }
+        int min_y = std::max(triangle.min_y, band_min_y);
+        int max_y = std::min(triangle.max_y, band_max_y);
+        // Rows are processed in groups of four pixels
+        int min_x = triangle.min_x & ~3;
+        int max_x = triangle.max_x;
+        for(int y = min_y; y <= max_y; y++) {
+            float* row = this->depth.data() + y * this->width;
+            float center_y = y + 0.5;
+            float row_edge[3];
+            for(int e = 0; e < 3; e++) {
+                row_edge[e] = triangle.edge_b[e] * center_y + triangle.edge_c[e];
+            }
+            float row_depth = triangle.depth_b * center_y + triangle.depth_c;
+            int x = min_x;
+
+            #ifdef __SSE2__
+            __m128 zero = _mm_setzero_ps();
+            __m128 offsets = _mm_set_ps(3.5, 2.5, 1.5, 0.5);
+            __m128 edge_a[3], edge_row[3];
+            for(int e = 0; e < 3; e++) {
+                edge_a[e] = _mm_set1_ps(triangle.edge_a[e]);
+                edge_row[e] = _mm_set1_ps(row_edge[e]);
+            }
+            __m128 depth_a = _mm_set1_ps(triangle.depth_a);
+            __m128 depth_row = _mm_set1_ps(row_depth);
+            for(; x <= max_x; x += 4) {
+                __m128 center_x = _mm_add_ps(_mm_set1_ps((float) x), offsets);
+                __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[0], center_x), edge_row[0]), zero);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[1], center_x), edge_row[1]), zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[2], center_x), edge_row[2]), zero));
+                if(_mm_movemask_ps(inside) == 0) {
+                    continue;
+                }
+                __m128 old_depth = _mm_loadu_ps(row + x);
+                __m128 new_depth = _mm_max_ps(old_depth,
+                    _mm_add_ps(_mm_mul_ps(depth_a, center_x), depth_row));
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, new_depth),
+                    _mm_andnot_ps(inside, old_depth)));
+            }
+            #endif
+
+            for(; x <= max_x; x++) {
+                float center_x = x + 0.5;
+                if(triangle.edge_a[0] * center_x + row_edge[0] >= 0 &&
+                    triangle.edge_a[1] * center_x + row_edge[1] >= 0 &&
+                    triangle.edge_a[2] * center_x + row_edge[2] >= 0) {
+                    row[x] = std::max(row[x], triangle.depth_a * center_x + row_depth);
+                }
+            }
+        }
+    }
+
+    // Update the farthest depth of each tile in the band
+    for(unsigned int tile = 0; tile < this->tiles_x; tile++) {
+        float farthest = INFINITY;
+        for(int y = band_min_y; y <= band_max_y; y++) {
+            const float* row = this->depth.data() + y * this->width + tile * TILE_SIZE;
+            for(unsigned int x = 0; x < TILE_SIZE; x++) {
+                farthest = std::min(farthest, row[x]);
+            }
+        }
+        this->tile_depth[band * this->tiles_x + tile] = farthest;
+    }
+}
+
+void DepthRasterizer::rasterize() {
+    for(unsigned int band = 0; band < this->tiles_y; band++) {
+        this->rasterize_band(band);
+    }
+}
+
+bool DepthRasterizer::test_box(const glm::mat4& matrix, glm::vec3 min, glm::vec3 max) {
+    glm::vec4 corners[8];
+    box_corners(min, max, corners);
+    float min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+    float closest = 0.0;
+    for(int i = 0; i < 8; i++) {
+        glm::vec4 corner = matrix * corners[i];
+        if(corner.z + corner.w < 0) {
+            return true;
+        }
+        float inverse_w = 1.0 / corner.w;
+        float x = (corner.x * inverse_w * 0.5 + 0.5) * this->width;
+        float y = (corner.y * inverse_w * 0.5 + 0.5) * this->height;
+        min_x = std::min(min_x, x);
+        min_y = std::min(min_y, y);
+        max_x = std::max(max_x, x);
+        max_y = std::max(max_y, y);
+        closest = std::max(closest, inverse_w);
+    }
+    return this->test_rect((int) std::floor(min_x), (int) std::floor(min_y),
+        (int) std::ceil(max_x) - 1, (int) std::ceil(max_y) - 1, closest);
+}
+
+bool DepthRasterizer::test_rect(int min_x, int min_y, int max_x, int max_y, float depth) {
+    min_x = std::max(min_x, 0);
+    min_y = std::max(min_y, 0);
+    max_x = std::min(max_x, (int) this->width - 1);
+    max_y = std::min(max_y, (int) this->height - 1);
+    if(min_x > max_x || min_y > max_y) {
+        // Entirely off screen
+        return false;
+    }
+    for(int tile_y = min_y / TILE_SIZE; tile_y <= max_y / (int) TILE_SIZE; tile_y++) {
+        for(int tile_x = min_x / TILE_SIZE; tile_x <= max_x / (int) TILE_SIZE; tile_x++) {
+            if(this->tile_depth[tile_y * this->tiles_x + tile_x] > depth) {
+                // Every pixel in the tile is closer
+                continue;
+            }
+            int y_end = std::min(max_y, (tile_y + 1) * (int) TILE_SIZE - 1);
+            int x_end = std::min(max_x, (tile_x + 1) * (int) TILE_SIZE - 1);
+            for(int y = std::max(min_y, tile_y * (int) TILE_SIZE); y <= y_end; y++) {
+                const float* row = this->depth.data() + y * this->width;
+                for(int x = std::max(min_x, tile_x * (int) TILE_SIZE); x <= x_end; x++) {
+                    if(row[x] <= depth) {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+unsigned int DepthRasterizer::get_width() {
+    return this->width;
+}
+
+unsigned int DepthRasterizer::get_height() {
+    return this->height;
+}
+
+const std::vector<float>& DepthRasterizer::get_depth() {
+    return this->depth;
+}
+
+bool DepthRasterizer::self_test() {
+    bool passed = true;
+    auto check = [&passed](bool result, const char* description) {
+        if(!result) {
+            ERROR("Depth rasterizer check failed: %s", description);
+            passed = false;
+        }
+    };
+    const unsigned int size = 64;
+
+    /* Coverage: the lower left half of the screen at a constant W of 2.
+    Pixel centers with x + y < 63 are inside, x + y > 63 outside, and the
+    diagonal itself lies exactly on the edge. */
+    DepthRasterizer half(size, size);
+    half.add_triangle(glm::vec4(-2.0, -2.0, 0.0, 2.0), glm::vec4(2.0, -2.0, 0.0, 2.0),
+        glm::vec4(-2.0, 2.0, 0.0, 2.0));
+    half.rasterize();
+    size_t wrong_coverage = 0;
+    size_t wrong_depth = 0;
+    for(unsigned int y = 0; y < size; y++) {
+        for(unsigned int x = 0; x < size; x++) {
+            float depth = half.depth[y * size + x];
+            if(x + y < size - 1) {
+                wrong_coverage += depth == 0.0;
+                wrong_depth += depth != 0.0 && std::abs(depth - 0.5) > 1e-5;
+            } else if(x + y > size - 1) {
+                wrong_coverage += depth != 0.0;
+            }
+        }
+    }
+    check(wrong_coverage == 0, "half screen triangle coverage");
+    check(wrong_depth == 0, "half screen triangle depth");
+
+    /* Depth: inverse W is linear in screen space.  This triangle covers the
+    whole screen, with W of 1, 2, and 4 at its corners, so the depth at
+    normalized pixel position (u, v) is 1 - 0.25u - 0.375v. */
+    DepthRasterizer slope(size, size);
+    slope.add_triangle(glm::vec4(-1.0, -1.0, 0.0, 1.0), glm::vec4(6.0, -2.0, 0.0, 2.0),
+        glm::vec4(-4.0, 12.0, 0.0, 4.0));
+    slope.rasterize();
+    float max_error = 0.0;
+    for(unsigned int y = 0; y < size; y++) {
+        for(unsigned int x = 0; x < size; x++) {
+            float u = (x + 0.5) / size;
+            float v = (y + 0.5) / size;
+            float expected = 1.0 - 0.25 * u - 0.375 * v;
+            max_error = std::max(max_error, std::abs(slope.depth[y * size + x] - expected));
+        }
+    }
+    check(max_error < 1e-5, "interpolated depth");
+
+    /* Near plane clipping: a triangle reaching behind the camera, compared
+    against rays traced through every pixel center.  Disagreements are only
+    allowed right along the triangle's edges. */
+    float near = 0.1;
+    float fov = 1.2;
+    glm::mat4 projection = glm::perspective(fov, 1.0f, near, 100.0f);
+    glm::vec3 p0(-50.0, -50.0, 5.0);
+    glm::vec3 p1(50.0, -50.0, 5.0);
+    glm::vec3 p2(0.0, 50.0, -50.0);
+    DepthRasterizer clipped(size, size);
+    clipped.add_triangle(projection * glm::vec4(p0, 1.0), projection * glm::vec4(p1, 1.0),
+        projection * glm::vec4(p2, 1.0));
+    clipped.rasterize();
+    float focal = 1.0 / std::tan(fov / 2.0);
+    size_t covered = 0;
+    size_t mismatched = 0;
+    max_error = 0.0;
+    for(unsigned int y = 0; y < size; y++) {
+        for(unsigned int x = 0; x < size; x++) {
+            glm::vec3 direction(((x + 0.5) / size * 2.0 - 1.0) / focal,
+                ((y + 0.5) / size * 2.0 - 1.0) / focal, -1.0);
+            // Ray triangle intersection, with the distance along -Z as t
+            glm::vec3 edge1 = p1 - p0;
+            glm::vec3 edge2 = p2 - p0;
+            glm::vec3 pvec = glm::cross(direction, edge2);
+            float determinant = glm::dot(edge1, pvec);
+            glm::vec3 qvec = glm::cross(-p0, edge1);
+            float u = glm::dot(-p0, pvec) / determinant;
+            float v = glm::dot(direction, qvec) / determinant;
+            float t = glm::dot(edge2, qvec) / determinant;
+            float expected = (u >= 0.0 && v >= 0.0 && u + v <= 1.0 && t >= near) ? 1.0 / t : 0.0;
+            float depth = clipped.depth[y * size + x];
+            if((expected == 0.0) != (depth == 0.0)) {
+                mismatched++;
+            } else if(expected != 0.0) {
+                covered++;
+                max_error = std::max(max_error, std::abs(depth - expected) / expected);
+            }
+        }
+    }
+    check(covered > size * size / 4, "clipped triangle covers the screen");
+    check(mismatched <= size * 3, "clipped triangle coverage");
+    check(max_error < 1e-3, "clipped triangle depth");
+
+    /* Box tests against a wall 10 units away, spanning 10 units square, so
+    the depth buffer holds 0.1 wherever the wall is. */
+    DepthRasterizer wall(size, size);
+    wall.add_box(projection, glm::vec3(-5.0, -5.0, -10.0), glm::vec3(5.0, 5.0, -10.0));
+    wall.rasterize();
+    check(!wall.test_box(projection, glm::vec3(-1.0, -1.0, -20.0), glm::vec3(1.0, 1.0, -18.0)),
+        "box behind the wall is occluded");
+    check(wall.test_box(projection, glm::vec3(-1.0, -1.0, -6.0), glm::vec3(1.0, 1.0, -4.0)),
+        "box in front of the wall is visible");
+    check(wall.test_box(projection, glm::vec3(-1.0, -1.0, -11.0), glm::vec3(1.0, 1.0, -9.0)),
+        "box through the wall is visible");
+    check(wall.test_box(projection, glm::vec3(4.0, -1.0, -30.0), glm::vec3(20.0, 1.0, -28.0)),
+        "box partly behind the wall is visible");
+    check(wall.test_box(projection, glm::vec3(-1.0, -1.0, -1.0), glm::vec3(1.0, 1.0, 1.0)),
+        "box crossing the near plane is visible");
+    check(!wall.test_box(projection, glm::vec3(-1.0, 200.0, -20.0), glm::vec3(1.0, 202.0, -18.0)),
+        "box off screen is culled");
+    check(!wall.test_rect(24, 24, 39, 39, 0.05) && wall.test_rect(24, 24, 39, 39, 0.2),
+        "rectangle against the wall depth");
+
+    INFO("Depth rasterizer self test %s", passed ? "passed" : "FAILED");
+    return passed;
+}
@@ -11,6 +11,7 @@
 #include "se/util/log.hpp"
 
 #include <cstdlib>
+#include <errno.h>
 #include <sys/stat.h>
 #include <string.h>
 
@@ -72,4 +73,17 @@ std::string se::util::dirs::app_data() {
     std::string value = "/opt/";
     value += appname;
     return value;
-}
\ No newline at end of file
+}
+bool se::util::dirs::create_directories(std::string path) {
+    // Create each parent in turn
+    for(size_t i = 1; i <= path.size(); i++) {
+        if(i != path.size() && path[i] != '/') { continue; }
+        std::string parent = path.substr(0, i);
+        if(mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST) {
+            WARN("Failed to create directory [%s] [%i: %s]", parent.c_str(),
+                errno, strerror(errno));
+            return false;
+        }
+    }
+    return true;
+}
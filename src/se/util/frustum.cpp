@@ -0,0 +1,94 @@
+/*!
+ *  @file src/se/util/frustum.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/util/frustum.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/geometric.hpp>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+void se::util::frustum::extract_planes(const glm::mat4& matrix, glm::vec4 planes[6]) {
+    // GLM matrices are column major, so rows are gathered across columns
+    glm::vec4 row[4];
+    for(int i = 0; i < 4; i++) {
+        row[i] = glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]);
+    }
+    planes[0] = row[3] + row[0];
+    planes[1] = row[3] - row[0];
+    planes[2] = row[3] + row[1];
+    planes[3] = row[3] - row[1];
+    planes[4] = row[3] + row[2];
+    planes[5] = row[3] - row[2];
+    for(int i = 0; i < 6; i++) {
+        float length = glm::length(glm::vec3(planes[i]));
+        if(length > 0.0) {
+            planes[i] /= length;
+        }
+    }
+}
+
+void se::util::frustum::transform_sphere(const glm::mat4& matrix,
+    glm::vec3& center, float& radius) {
+    center = glm::vec3(matrix * glm::vec4(center, 1.0));
+    float scale = std::max(glm::length(glm::vec3(matrix[0])),
+        std::max(glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2]))));
+    radius *= scale;
+}
+
+size_t se::util::frustum::cull_spheres(const glm::vec4 planes[6], const float* x,
+    const float* y, const float* z, const float* radius, size_t count,
+    uint8_t* visible) {
+    size_t visible_count = 0;
+    size_t i = 0;
+
+    #ifdef __SSE2__
+    /* Four spheres at a time.  A sphere is outside if it is further than its
+    radius behind any plane. */
+    __m128 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+    for(int p = 0; p < 6; p++) {
+        plane_x[p] = _mm_set1_ps(planes[p].x);
+        plane_y[p] = _mm_set1_ps(planes[p].y);
+        plane_z[p] = _mm_set1_ps(planes[p].z);
+        plane_w[p] = _mm_set1_ps(planes[p].w);
+    }
+    for(; i + 4 <= count; i += 4) {
+        __m128 sx = _mm_loadu_ps(x + i);
+        __m128 sy = _mm_loadu_ps(y + i);
+        __m128 sz = _mm_loadu_ps(z + i);
+        __m128 neg_r = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for(int p = 0; p < 6; p++) {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(plane_x[p], sx), _mm_mul_ps(plane_y[p], sy)),
+                _mm_add_ps(_mm_mul_ps(plane_z[p], sz), plane_w[p]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, neg_r));
+        }
+        int mask = _mm_movemask_ps(inside);
+        for(int j = 0; j < 4; j++) {
+            visible[i + j] = (mask >> j) & 1;
+        }
+        visible_count += __builtin_popcount(mask);
+    }
+    #endif
+
+    for(; i < count; i++) {
+        bool inside = true;
+        for(int p = 0; p < 6 && inside; p++) {
+            float distance = planes[p].x * x[i] + planes[p].y * y[i] +
+                planes[p].z * z[i] + planes[p].w;
+            inside = distance >= -radius[i];
+        }
+        visible[i] = inside;
+        visible_count += inside;
+    }
+    return visible_count;
+}
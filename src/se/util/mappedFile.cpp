@@ -0,0 +1,69 @@
+/*!
+ *  @file src/se/util/mappedFile.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/util/mappedFile.hpp"
+
+#include "se/util/log.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace se::util;
+
+// ====================
+// == PUBLIC MEMBERS ==
+// ====================
+
+MappedFile::MappedFile(std::string path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        if(errno != ENOENT) {
+            WARN("Failed to open [%s] [%i: %s]", path.c_str(), errno, strerror(errno));
+        }
+        return;
+    }
+    struct stat file_stat;
+    if(fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+        close(fd);
+        return;
+    }
+    void* mapping = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping remains valid after the descriptor has been closed
+    close(fd);
+    if(mapping == MAP_FAILED) {
+        WARN("Failed to map [%s] [%i: %s]", path.c_str(), errno, strerror(errno));
+        return;
+    }
+    // The data is almost always read from front to back exactly once
+    madvise(mapping, file_stat.st_size, MADV_SEQUENTIAL);
+    madvise(mapping, file_stat.st_size, MADV_WILLNEED);
+    this->mapping = mapping;
+    this->mapping_size = file_stat.st_size;
+}
+
+MappedFile::~MappedFile() {
+    if(this->mapping != nullptr) {
+        munmap(this->mapping, this->mapping_size);
+    }
+}
+
+bool MappedFile::is_valid() {
+    return this->mapping != nullptr;
+}
+
+const void* MappedFile::get_data() {
+    return this->mapping;
+}
+
+size_t MappedFile::get_size() {
+    return this->mapping_size;
+}
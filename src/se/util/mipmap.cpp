@@ -0,0 +1,86 @@
+/*!
+ *  @file src/se/util/mipmap.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/util/mipmap.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+unsigned int se::util::mipmap::level_count(int width, int height) {
+    unsigned int levels = 1;
+    int size = std::max(width, height);
+    while(size > 1) {
+        size /= 2;
+        levels++;
+    }
+    return levels;
+}
+
+size_t se::util::mipmap::chain_size(int width, int height, int channels) {
+    size_t size = 0;
+    unsigned int levels = level_count(width, height);
+    for(unsigned int i = 0; i < levels; i++) {
+        size += (size_t) width * height * channels;
+        width = std::max(width / 2, 1);
+        height = std::max(height / 2, 1);
+    }
+    return size;
+}
+
+void se::util::mipmap::downsample(const uint8_t* src, int width, int height,
+    int channels, uint8_t* dst) {
+    int dst_width = std::max(width / 2, 1);
+    int dst_height = std::max(height / 2, 1);
+    size_t row_size = (size_t) width * channels;
+    /* Each output row is produced in two passes.  First the two source rows
+    are summed into a 16 bit row, then horizontally adjacent pixels of the sum
+    are combined. */
+    std::vector<uint16_t> sums(row_size);
+    for(int y = 0; y < dst_height; y++) {
+        const uint8_t* row_a = src + std::min(y * 2, height - 1) * row_size;
+        const uint8_t* row_b = src + std::min(y * 2 + 1, height - 1) * row_size;
+        size_t i = 0;
+        #ifdef __SSE2__
+        const __m128i zero = _mm_setzero_si128();
+        for(; i + 16 <= row_size; i += 16) {
+            __m128i a = _mm_loadu_si128((const __m128i*) (row_a + i));
+            __m128i b = _mm_loadu_si128((const __m128i*) (row_b + i));
+            __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            _mm_storeu_si128((__m128i*) (sums.data() + i), lo);
+            _mm_storeu_si128((__m128i*) (sums.data() + i + 8), hi);
+        }
+        #endif
+        for(; i < row_size; i++) {
+            sums[i] = row_a[i] + row_b[i];
+        }
+        uint8_t* out = dst + (size_t) y * dst_width * channels;
+        for(int x = 0; x < dst_width; x++) {
+            const uint16_t* left = sums.data() + std::min(x * 2, width - 1) * channels;
+            const uint16_t* right = sums.data() + std::min(x * 2 + 1, width - 1) * channels;
+            for(int c = 0; c < channels; c++) {
+                out[x * channels + c] = (left[c] + right[c] + 2) >> 2;
+            }
+        }
+    }
+}
+
+void se::util::mipmap::generate(uint8_t* data, int width, int height, int channels) {
+    unsigned int levels = level_count(width, height);
+    for(unsigned int i = 1; i < levels; i++) {
+        uint8_t* next = data + (size_t) width * height * channels;
+        downsample(data, width, height, channels, next);
+        data = next;
+        width = std::max(width / 2, 1);
+        height = std::max(height / 2, 1);
+    }
+}
@@ -0,0 +1,243 @@
+/*!
+ *  @file src/se/util/simplify.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/util/simplify.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <unordered_map>
+#include <glm/geometric.hpp>
+
+/*!
+ *  Quadric.
+ * 
+ *  Symmetric 4x4 matrix, stored as its upper triangle.  Evaluating it at a
+ *  point gives the sum of the squared distances to every plane added to it.
+ */
+struct Quadric {
+    double a = 0.0, b = 0.0, c = 0.0, d = 0.0;
+    double e = 0.0, f = 0.0, g = 0.0;
+    double h = 0.0, i = 0.0;
+    double j = 0.0;
+
+    /// Add the plane `n.p + w = 0`
+    void add_plane(glm::vec3 n, float w) {
+        a += n.x * n.x; b += n.x * n.y; c += n.x * n.z; d += n.x * w;
+        e += n.y * n.y; f += n.y * n.z; g += n.y * w;
+        h += n.z * n.z; i += n.z * w;
+        j += w * w;
+    }
+
+    void operator+=(const Quadric& q) {
+        a += q.a; b += q.b; c += q.c; d += q.d;
+        e += q.e; f += q.f; g += q.g;
+        h += q.h; i += q.i;
+        j += q.j;
+    }
+
+    /// Evaluate at a point
+    double evaluate(glm::vec3 p) const {
+        double x = p.x, y = p.y, z = p.z;
+        return a*x*x + 2*b*x*y + 2*c*x*z + 2*d*x +
+            e*y*y + 2*f*y*z + 2*g*y +
+            h*z*z + 2*i*z +
+            j;
+    }
+};
+
+/// Candidate edge collapse
+struct Collapse {
+    /// Quadric error of the collapse
+    double cost;
+    /// Vertex which is removed
+    uint32_t from;
+    /// Vertex it is moved onto
+    uint32_t to;
+    /// Versions of both vertices when the cost was calculated
+    uint32_t from_version, to_version;
+
+    bool operator>(const Collapse& other) const {
+        return cost > other.cost;
+    }
+};
+
+float se::util::simplify::simplify(const uint32_t* indices, size_t index_count,
+    const glm::vec3* positions, size_t vertex_count,
+    size_t target_index_count, std::vector<uint32_t>& result) {
+    size_t triangle_count = index_count / 3;
+    std::vector<uint32_t> triangles(indices, indices + triangle_count * 3);
+    std::vector<uint8_t> triangle_alive(triangle_count, 1);
+    size_t alive_count = triangle_count;
+
+    // Adjacency and quadrics
+    std::vector<std::vector<uint32_t>> vertex_triangles(vertex_count);
+    std::vector<Quadric> quadrics(vertex_count);
+    std::unordered_map<uint64_t, uint32_t> edge_uses;
+    edge_uses.reserve(index_count);
+    for(size_t t = 0; t < triangle_count; t++) {
+        const uint32_t* tri = &triangles[t * 3];
+        glm::vec3 normal = glm::cross(positions[tri[1]] - positions[tri[0]],
+            positions[tri[2]] - positions[tri[0]]);
+        float length = glm::length(normal);
+        for(int k = 0; k < 3; k++) {
+            vertex_triangles[tri[k]].push_back(t);
+            if(length > 0.0) {
+                glm::vec3 unit = normal / length;
+                quadrics[tri[k]].add_plane(unit, -glm::dot(unit, positions[tri[0]]));
+            }
+            uint32_t u = std::min(tri[k], tri[(k + 1) % 3]);
+            uint32_t v = std::max(tri[k], tri[(k + 1) % 3]);
+            edge_uses[((uint64_t) u << 32) | v]++;
+        }
+    }
+
+    // Lock the vertices of every edge with only one triangle
+    std::vector<uint8_t> locked(vertex_count, 0);
+    for(auto& edge : edge_uses) {
+        if(edge.second == 1) {
+            locked[edge.first >> 32] = 1;
+            locked[edge.first & 0xffffffff] = 1;
+        }
+    }
+
+    std::vector<uint8_t> removed(vertex_count, 0);
+    std::vector<uint32_t> version(vertex_count, 0);
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+    auto push_candidate = [&](uint32_t from, uint32_t to){
+        if(locked[from]) {
+            return;
+        }
+        Quadric quadric = quadrics[from];
+        quadric += quadrics[to];
+        queue.push({std::max(quadric.evaluate(positions[to]), 0.0), from, to,
+            version[from], version[to]});
+    };
+    auto push_vertex = [&](uint32_t vertex){
+        for(uint32_t t : vertex_triangles[vertex]) {
+            if(!triangle_alive[t]) {
+                continue;
+            }
+            for(int k = 0; k < 3; k++) {
+                uint32_t other = triangles[t * 3 + k];
+                if(other != vertex) {
+                    push_candidate(vertex, other);
+                    push_candidate(other, vertex);
+                }
+            }
+        }
+    };
+    for(size_t t = 0; t < triangle_count; t++) {
+        for(int k = 0; k < 3; k++) {
+            push_candidate(triangles[t * 3 + k], triangles[t * 3 + (k + 1) % 3]);
+            push_candidate(triangles[t * 3 + (k + 1) % 3], triangles[t * 3 + k]);
+        }
+    }
+
+    std::vector<uint32_t> from_neighbors, to_neighbors;
+    auto gather_neighbors = [&](uint32_t vertex, std::vector<uint32_t>& neighbors){
+        neighbors.clear();
+        for(uint32_t t : vertex_triangles[vertex]) {
+            if(!triangle_alive[t]) {
+                continue;
+            }
+            for(int k = 0; k < 3; k++) {
+                uint32_t other = triangles[t * 3 + k];
+                if(other != vertex) {
+                    neighbors.push_back(other);
+                }
+            }
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    };
+
+    double max_cost = 0.0;
+    while(alive_count * 3 > target_index_count && !queue.empty()) {
+        Collapse collapse = queue.top();
+        queue.pop();
+        uint32_t from = collapse.from;
+        uint32_t to = collapse.to;
+        if(removed[from] || removed[to] || collapse.from_version != version[from] ||
+            collapse.to_version != version[to]) {
+            continue;
+        }
+
+        /* Link condition: an edge between two vertices may only share two
+        neighbors (the opposite corners of its two triangles), otherwise the
+        collapse pinches the surface. */
+        gather_neighbors(from, from_neighbors);
+        gather_neighbors(to, to_neighbors);
+        if(!std::binary_search(from_neighbors.begin(), from_neighbors.end(), to)) {
+            continue;
+        }
+        size_t shared = 0;
+        for(uint32_t neighbor : from_neighbors) {
+            shared += std::binary_search(to_neighbors.begin(), to_neighbors.end(), neighbor);
+        }
+        if(shared > 2) {
+            continue;
+        }
+
+        // Reject collapses which flip or degenerate a remaining triangle
+        bool valid = true;
+        for(uint32_t t : vertex_triangles[from]) {
+            const uint32_t* tri = &triangles[t * 3];
+            if(!triangle_alive[t] || tri[0] == to || tri[1] == to || tri[2] == to) {
+                continue;
+            }
+            glm::vec3 before[3], after[3];
+            for(int k = 0; k < 3; k++) {
+                before[k] = positions[tri[k]];
+                after[k] = tri[k] == from ? positions[to] : before[k];
+            }
+            glm::vec3 normal_before = glm::cross(before[1] - before[0], before[2] - before[0]);
+            glm::vec3 normal_after = glm::cross(after[1] - after[0], after[2] - after[0]);
+            if(glm::dot(normal_before, normal_after) <= 0.0) {
+                valid = false;
+                break;
+            }
+        }
+        if(!valid) {
+            continue;
+        }
+
+        for(uint32_t t : vertex_triangles[from]) {
+            if(!triangle_alive[t]) {
+                continue;
+            }
+            uint32_t* tri = &triangles[t * 3];
+            if(tri[0] == to || tri[1] == to || tri[2] == to) {
+                triangle_alive[t] = 0;
+                alive_count--;
+                continue;
+            }
+            for(int k = 0; k < 3; k++) {
+                if(tri[k] == from) {
+                    tri[k] = to;
+                }
+            }
+            vertex_triangles[to].push_back(t);
+        }
+        vertex_triangles[from].clear();
+        quadrics[to] += quadrics[from];
+        removed[from] = 1;
+        version[to]++;
+        max_cost = std::max(max_cost, collapse.cost);
+        push_vertex(to);
+    }
+
+    result.clear();
+    result.reserve(alive_count * 3);
+    for(size_t t = 0; t < triangle_count; t++) {
+        if(triangle_alive[t]) {
+            result.insert(result.end(), &triangles[t * 3], &triangles[t * 3 + 3]);
+        }
+    }
+    return sqrt(max_cost);
+}
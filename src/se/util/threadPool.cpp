@@ -0,0 +1,148 @@
+/*!
+ *  @file src/se/util/threadPool.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/util/threadPool.hpp"
+
+#include "se/util/log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+
+using namespace se::util;
+
+// =====================
+// == PRIVATE MEMBERS ==
+// =====================
+
+void ThreadPool::worker_main(unsigned int index) {
+    std::string thread_name = "WORKER";
+    thread_name += std::to_string(index);
+    se::util::log::set_thread_name(thread_name.c_str());
+
+    while(true) {
+        WorkerJob job;
+        {
+            std::unique_lock<std::mutex> lock(this->jobs_mutex);
+            this->jobs_condition.wait(lock, [this](){
+                return !this->run || !this->jobs.empty(); });
+            if(this->jobs.empty()) {
+                // Stopping and nothing left to do
+                break;
+            }
+            job = std::move(this->jobs.front());
+            this->jobs.pop_front();
+            this->active_jobs++;
+        }
+        auto start_time = std::chrono::steady_clock::now();
+        job();
+        this->stat_total_job_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_time).count();
+        this->stat_total_job_count++;
+        this->active_jobs--;
+    }
+
+    DEBUG("Worker thread terminated");
+}
+
+// ====================
+// == PUBLIC MEMBERS ==
+// ====================
+
+ThreadPool::ThreadPool(unsigned int thread_count) {
+    if(thread_count == 0) {
+        unsigned int hardware_threads = std::thread::hardware_concurrency();
+        thread_count = hardware_threads > 1 ? hardware_threads - 1 : 1;
+    }
+    DEBUG("Starting %u worker threads", thread_count);
+    for(unsigned int i = 0; i < thread_count; i++) {
+        this->workers.push_back(std::thread(&ThreadPool::worker_main, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->jobs_mutex);
+        this->run = false;
+    }
+    this->jobs_condition.notify_all();
+    DEBUG("Waiting for worker threads to exit");
+    for(auto& worker : this->workers) {
+        if(worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    // Print out benchmarking information
+    uint64_t bm_job_count = this->stat_total_job_count;
+    if(bm_job_count == 0) {
+        WARN("No worker jobs executed! Skipping worker benchmarking");
+    } else {
+        uint64_t bm_job_time_ns = this->stat_total_job_time_ns;
+        float bm_job_time_ms = bm_job_time_ns / 1000000.0;
+        INFO("Worker jobs executed: %lu", bm_job_count);
+        INFO("Time spent on worker jobs: %luns (%.3fms)", bm_job_time_ns, bm_job_time_ms);
+        INFO("Average worker job time: %luns", bm_job_time_ns / bm_job_count);
+    }
+}
+
+void ThreadPool::submit(WorkerJob job) {
+    {
+        std::lock_guard<std::mutex> lock(this->jobs_mutex);
+        this->jobs.push_back(std::move(job));
+    }
+    this->jobs_condition.notify_one();
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& body) {
+    if(count == 0) {
+        return;
+    }
+    /* Helpers which only start after every index has been taken exit without
+    touching `body`, so the shared state is all that has to outlive this
+    call. */
+    struct ParallelFor {
+        const std::function<void(size_t)>* body;
+        size_t count;
+        std::atomic<size_t> next = 0;
+        std::atomic<size_t> done = 0;
+        std::mutex done_mutex;
+        std::condition_variable done_condition;
+    };
+    auto state = std::make_shared<ParallelFor>();
+    state->body = &body;
+    state->count = count;
+    auto run = [state](){
+        size_t index;
+        while((index = state->next++) < state->count) {
+            (*state->body)(index);
+            if(++state->done == state->count) {
+                std::lock_guard<std::mutex> lock(state->done_mutex);
+                state->done_condition.notify_all();
+            }
+        }
+    };
+    size_t helpers = std::min(count - 1, this->workers.size());
+    for(size_t i = 0; i < helpers; i++) {
+        this->submit(run);
+    }
+    run();
+    std::unique_lock<std::mutex> lock(state->done_mutex);
+    state->done_condition.wait(lock, [&state](){
+        return state->done == state->count; });
+}
+
+unsigned int ThreadPool::get_thread_count() {
+    return this->workers.size();
+}
+
+unsigned int ThreadPool::pending_job_count() {
+    std::lock_guard<std::mutex> lock(this->jobs_mutex);
+    return this->jobs.size() + this->active_jobs;
+}
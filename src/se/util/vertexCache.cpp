@@ -0,0 +1,209 @@
+/*!
+ *  @file src/se/util/vertexCache.cpp
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/util/vertexCache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/// Size of the modelled LRU cache
+#define VC_CACHE_SIZE 32
+/// Cache position score falloff
+#define VC_CACHE_DECAY_POWER 1.5f
+/// Score for vertices used by the most recent triangle
+#define VC_LAST_TRI_SCORE 0.75f
+/// Bonus for vertices with few remaining triangles
+#define VC_VALENCE_BOOST_SCALE 2.0f
+/// Falloff of the valence bonus
+#define VC_VALENCE_BOOST_POWER 0.5f
+
+/// Per-vertex optimizer state
+struct VertexState {
+    /// Position in the modelled cache, or -1
+    int cache_position = -1;
+    /// Current score
+    float score = 0.0;
+    /// Number of triangles not yet emitted
+    uint32_t active_triangles = 0;
+    /// Offset of this vertex's triangle list in the adjacency array
+    uint32_t triangle_offset = 0;
+};
+
+/// Calculate the score of a vertex
+static float vertex_score(const VertexState& vertex) {
+    if(vertex.active_triangles == 0) {
+        // No triangles left, this vertex is irrelevant
+        return -1.0;
+    }
+    float score = 0.0;
+    if(vertex.cache_position >= 0) {
+        if(vertex.cache_position < 3) {
+            /* Vertices used by the last triangle get a fixed score, otherwise
+            the optimizer would favor re-using the exact same edge. */
+            score = VC_LAST_TRI_SCORE;
+        } else {
+            float scaler = 1.0f / (VC_CACHE_SIZE - 3);
+            score = std::pow(1.0f - (vertex.cache_position - 3) * scaler,
+                VC_CACHE_DECAY_POWER);
+        }
+    }
+    // Favor finishing off vertices with few triangles left
+    score += VC_VALENCE_BOOST_SCALE * std::pow((float) vertex.active_triangles,
+        -VC_VALENCE_BOOST_POWER);
+    return score;
+}
+
+void se::util::vertex_cache::optimize(uint32_t* indices, size_t index_count,
+    size_t vertex_count) {
+    size_t triangle_count = index_count / 3;
+    if(triangle_count == 0 || vertex_count == 0) { return; }
+
+    // Build the vertex to triangle adjacency lists
+    std::vector<VertexState> vertices(vertex_count);
+    for(size_t i = 0; i < triangle_count * 3; i++) {
+        vertices[indices[i]].active_triangles++;
+    }
+    uint32_t offset = 0;
+    for(auto& vertex : vertices) {
+        vertex.triangle_offset = offset;
+        offset += vertex.active_triangles;
+    }
+    std::vector<uint32_t> adjacency(offset);
+    std::vector<uint32_t> fill(vertex_count, 0);
+    for(size_t t = 0; t < triangle_count; t++) {
+        for(int c = 0; c < 3; c++) {
+            uint32_t v = indices[t * 3 + c];
+            adjacency[vertices[v].triangle_offset + fill[v]++] = t;
+        }
+    }
+
+    // Initial scores
+    for(auto& vertex : vertices) {
+        vertex.score = vertex_score(vertex);
+    }
+    std::vector<float> triangle_scores(triangle_count);
+    std::vector<bool> triangle_added(triangle_count, false);
+    for(size_t t = 0; t < triangle_count; t++) {
+        triangle_scores[t] = vertices[indices[t * 3]].score +
+            vertices[indices[t * 3 + 1]].score + vertices[indices[t * 3 + 2]].score;
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve(triangle_count * 3);
+    // Modelled cache, with room for the three vertices being pushed
+    std::vector<uint32_t> cache;
+    cache.reserve(VC_CACHE_SIZE + 3);
+    std::vector<uint32_t> new_cache;
+    new_cache.reserve(VC_CACHE_SIZE + 3);
+
+    long best_triangle = -1;
+    float best_score = -1.0;
+    size_t scan_position = 0;
+    for(size_t emitted = 0; emitted < triangle_count; emitted++) {
+        if(best_triangle < 0) {
+            /* Nothing useful in the cache, fall back to a scan for the best
+            remaining triangle.  Already emitted triangles are never revisited,
+            so this stays linear over the whole run. */
+            best_score = -1.0;
+            while(scan_position < triangle_count && triangle_added[scan_position]) {
+                scan_position++;
+            }
+            for(size_t t = scan_position; t < triangle_count; t++) {
+                if(!triangle_added[t] && triangle_scores[t] > best_score) {
+                    best_score = triangle_scores[t];
+                    best_triangle = t;
+                }
+            }
+        }
+
+        // Emit the triangle
+        uint32_t* tri = indices + best_triangle * 3;
+        output.push_back(tri[0]);
+        output.push_back(tri[1]);
+        output.push_back(tri[2]);
+        triangle_added[best_triangle] = true;
+
+        // Remove the triangle from the adjacency lists of its vertices
+        for(int c = 0; c < 3; c++) {
+            VertexState& vertex = vertices[tri[c]];
+            uint32_t* list = &adjacency[vertex.triangle_offset];
+            for(uint32_t i = 0; i < vertex.active_triangles; i++) {
+                if(list[i] == (uint32_t) best_triangle) {
+                    list[i] = list[vertex.active_triangles - 1];
+                    break;
+                }
+            }
+            vertex.active_triangles--;
+        }
+
+        // Push the triangle's vertices to the front of the cache
+        new_cache.clear();
+        new_cache.push_back(tri[0]);
+        new_cache.push_back(tri[1]);
+        new_cache.push_back(tri[2]);
+        for(uint32_t v : cache) {
+            if(v != tri[0] && v != tri[1] && v != tri[2]) {
+                new_cache.push_back(v);
+            }
+        }
+        // Vertices falling out of the cache lose their position
+        for(size_t i = VC_CACHE_SIZE; i < new_cache.size(); i++) {
+            vertices[new_cache[i]].cache_position = -1;
+            vertices[new_cache[i]].score = vertex_score(vertices[new_cache[i]]);
+        }
+        if(new_cache.size() > VC_CACHE_SIZE) {
+            new_cache.resize(VC_CACHE_SIZE);
+        }
+        cache.swap(new_cache);
+
+        // Update the cached vertex scores
+        for(size_t i = 0; i < cache.size(); i++) {
+            VertexState& vertex = vertices[cache[i]];
+            vertex.cache_position = i;
+            vertex.score = vertex_score(vertex);
+        }
+
+        // Re-score triangles touching the cache and pick the next best one
+        best_triangle = -1;
+        best_score = -1.0;
+        for(uint32_t v : cache) {
+            VertexState& vertex = vertices[v];
+            for(uint32_t i = 0; i < vertex.active_triangles; i++) {
+                uint32_t t = adjacency[vertex.triangle_offset + i];
+                float score = vertices[indices[t * 3]].score +
+                    vertices[indices[t * 3 + 1]].score +
+                    vertices[indices[t * 3 + 2]].score;
+                triangle_scores[t] = score;
+                if(score > best_score) {
+                    best_score = score;
+                    best_triangle = t;
+                }
+            }
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+size_t se::util::vertex_cache::count_transforms(const uint32_t* indices,
+    size_t index_count, size_t vertex_count, unsigned int cache_size) {
+    // Time at which each vertex entered the cache
+    std::vector<size_t> entered(vertex_count, 0);
+    size_t transforms = 0;
+    for(size_t i = 0; i < index_count; i++) {
+        uint32_t v = indices[i];
+        /* A FIFO cache holds the last `cache_size` misses, so a vertex is a
+        hit if fewer than that many misses have happened since it entered. */
+        if(entered[v] == 0 || transforms - (entered[v] - 1) >= cache_size) {
+            transforms++;
+            entered[v] = transforms;
+        }
+    }
+    return transforms;
+}
@@ -15,10 +15,14 @@
 #include "se/entity/skybox.hpp"
 #include "se/entity/sign.hpp"
 #include "se/graphics/graphicsController.hpp"
+#include "se/graphics/objParser.hpp"
 #include "se/graphics/simpleRenderManager.hpp"
 #include "se/graphics/textTexture.hpp"
 
+#include "se/util/bvh.hpp"
 #include "se/util/config.hpp"
+#include "se/util/depthRasterizer.hpp"
+#include "se/util/dirs.hpp"
 #include "se/util/log.hpp"
 
 #include <thread>
@@ -40,16 +44,33 @@ int main(int argc, char** argv) {
 
     Engine e;
 
+    if(e.config->get_bool("logic.bvh_benchmark", false)) {
+        se::util::BVH::benchmark(10000);
+        se::util::BVH::benchmark(100000);
+        se::util::BVH::benchmark(1000000);
+    }
+
+    if(e.config->get_bool("logic.obj_benchmark", false)) {
+        std::string suzanne = se::util::dirs::app_data() + "/models/suzanne.obj";
+        se::graphics::obj::benchmark(suzanne.c_str(), e.worker_pool);
+        se::graphics::obj::benchmark_synthetic(1000000, e.worker_pool);
+        se::graphics::obj::benchmark_synthetic(4000000, e.worker_pool);
+    }
+
+    if(e.config->get_bool("logic.depth_rasterizer_test", false)) {
+        se::util::DepthRasterizer::self_test();
+    }
+
     SimpleRenderManager srm(&e);
     e.graphics_controller->set_render_manager(&srm);
 
     Scene scene(&e);
-    scene.load_scene("test");
+    scene.load_scene(e.config->get_string("engine.scene", "test").c_str());
     srm.set_active_scene(&scene);
 
     FPCamera cam(&e);
     cam.set_name("camera");
-    cam.z = 1.524;
+    cam.set_position(0.0, 0.0, 1.524);
     srm.set_active_camera(&cam);
     scene.register_entity(&cam);
 
@@ -55,55 +55,64 @@ MainWindow::~MainWindow() {
 
 void MainWindow::on_entity_rot_x_valueChanged(double arg1) {
     if(this->no_update_entity) { return; }
-    this->target->rx = (float) arg1;
+    glm::vec3 v = this->target->get_rotation();
+    this->target->set_rotation((float) arg1, v.y, v.z);
     this->ui->silhouette->update();
 }
 
 void MainWindow::on_entity_rot_y_valueChanged(double arg1) {
     if(this->no_update_entity) { return; }
-    this->target->ry = (float) arg1;
+    glm::vec3 v = this->target->get_rotation();
+    this->target->set_rotation(v.x, (float) arg1, v.z);
     this->ui->silhouette->update();
 }
 
 void MainWindow::on_entity_rot_z_valueChanged(double arg1) {
     if(this->no_update_entity) { return; }
-    this->target->rz = (float) arg1;
+    glm::vec3 v = this->target->get_rotation();
+    this->target->set_rotation(v.x, v.y, (float) arg1);
     this->ui->silhouette->update();
 }
 
 void MainWindow::on_entity_pos_x_valueChanged(double arg1) {
     if(this->no_update_entity) { return; }
-    this->target->x = arg1;
+    glm::vec3 v = this->target->get_position();
+    this->target->set_position((float) arg1, v.y, v.z);
     this->ui->silhouette->update();
 }
 
 void MainWindow::on_entity_pos_y_valueChanged(double arg1) {
     if(this->no_update_entity) { return; }
-    this->target->y = arg1;
+    glm::vec3 v = this->target->get_position();
+    this->target->set_position(v.x, (float) arg1, v.z);
     this->ui->silhouette->update();
 }
 
 void MainWindow::on_entity_pos_z_valueChanged(double arg1) {
     if(this->no_update_entity) { return; }
-    this->target->z = arg1;
+    glm::vec3 v = this->target->get_position();
+    this->target->set_position(v.x, v.y, (float) arg1);
     this->ui->silhouette->update();
 }
 
 void MainWindow::on_entity_scale_x_valueChanged(double arg1) {
     if(this->no_update_entity) { return; }
-    this->target->sx = arg1;
+    glm::vec3 v = this->target->get_scale();
+    this->target->set_scale((float) arg1, v.y, v.z);
     this->ui->silhouette->update();
 }
 
 void MainWindow::on_entity_scale_y_valueChanged(double arg1) {
     if(this->no_update_entity) { return; }
-    this->target->sy = arg1;
+    glm::vec3 v = this->target->get_scale();
+    this->target->set_scale(v.x, (float) arg1, v.z);
     this->ui->silhouette->update();
 }
 
 void MainWindow::on_entity_scale_z_valueChanged(double arg1) {
     if(this->no_update_entity) { return; }
-    this->target->sz = arg1;
+    glm::vec3 v = this->target->get_scale();
+    this->target->set_scale(v.x, v.y, (float) arg1);
     this->ui->silhouette->update();
 }
 
@@ -138,15 +147,15 @@ void MainWindow::on_entity_list_itemDoubleClicked(QListWidgetItem *item)
     this->ui->entity_name->setText(QString(e->get_name()));
     this->ui->entity_type->setText(QString(e->get_type()));
 
-    this->ui->entity_rot_x->setValue(this->target->rx);
-    this->ui->entity_rot_y->setValue(this->target->ry);
-    this->ui->entity_rot_z->setValue(this->target->rz);
-    this->ui->entity_pos_x->setValue(this->target->x);
-    this->ui->entity_pos_y->setValue(this->target->y);
-    this->ui->entity_pos_z->setValue(this->target->z);
-    this->ui->entity_scale_x->setValue(this->target->sx);
-    this->ui->entity_scale_y->setValue(this->target->sy);
-    this->ui->entity_scale_z->setValue(this->target->sz);
+    this->ui->entity_rot_x->setValue(this->target->get_rotation().x);
+    this->ui->entity_rot_y->setValue(this->target->get_rotation().y);
+    this->ui->entity_rot_z->setValue(this->target->get_rotation().z);
+    this->ui->entity_pos_x->setValue(this->target->get_position().x);
+    this->ui->entity_pos_y->setValue(this->target->get_position().y);
+    this->ui->entity_pos_z->setValue(this->target->get_position().z);
+    this->ui->entity_scale_x->setValue(this->target->get_scale().x);
+    this->ui->entity_scale_y->setValue(this->target->get_scale().y);
+    this->ui->entity_scale_z->setValue(this->target->get_scale().z);
 
     this->ui->entity_rot_x->setEnabled(true);
     this->ui->entity_rot_y->setEnabled(true);
@@ -0,0 +1,214 @@
+/*!
+ *  @file src/test/unit/bvh.cpp
+ * 
+ *  Checks BVH queries against a brute force search.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/util/bvh.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace se::util;
+
+/// Number of objects in each test tree
+#define TEST_OBJECT_COUNT 500
+/// Number of queries of each kind
+#define TEST_QUERY_COUNT 100
+
+/*!
+ *  BVH test fixture.
+ * 
+ *  Keeps a copy of the box stored for every object, so that query results
+ *  can be compared with a brute force search.  The tree has no margin, so
+ *  the stored boxes only differ from the requested ones when a move fits
+ *  inside the old box.
+ */
+class BVHTest : public ::testing::Test {
+
+    protected:
+
+        /// Tree under test
+        BVH bvh = BVH(0.0);
+
+        /// Stored box of every object, indexed by user data
+        std::vector<AABB> boxes;
+
+        /// Proxy of every object, or -1 if it was removed
+        std::vector<int32_t> proxies;
+
+        /// Random number generator, seeded so failures can be reproduced
+        std::mt19937 random = std::mt19937(1234);
+
+        /// Generate a random box
+        AABB random_box() {
+            std::uniform_real_distribution<float> position(-100.0, 100.0);
+            std::uniform_real_distribution<float> size(0.1, 5.0);
+            glm::vec3 min(position(this->random), position(this->random),
+                position(this->random));
+            glm::vec3 extent(size(this->random), size(this->random),
+                size(this->random));
+            return {min, min + extent};
+        }
+
+        /// Insert an object with a random box
+        void insert_random() {
+            AABB box = this->random_box();
+            void* user_data = (void*) this->boxes.size();
+            this->proxies.push_back(this->bvh.insert(box, user_data));
+            this->boxes.push_back(box);
+        }
+
+        /// Check every kind of query against a brute force search
+        void check_queries() {
+            std::vector<void*> results;
+            std::vector<void*> expected;
+            std::uniform_real_distribution<float> radius(1.0, 30.0);
+            for(int i = 0; i < TEST_QUERY_COUNT; i++) {
+                AABB box = this->random_box();
+                box.max += glm::vec3(20.0, 20.0, 20.0);
+                results.clear();
+                expected.clear();
+                this->bvh.query_aabb(box, results);
+                for(size_t j = 0; j < this->boxes.size(); j++) {
+                    if(this->proxies[j] != -1 && overlaps(this->boxes[j], box)) {
+                        expected.push_back((void*) j);
+                    }
+                }
+                expect_same(results, expected);
+
+                glm::vec3 center = box.min;
+                float r = radius(this->random);
+                results.clear();
+                expected.clear();
+                this->bvh.query_sphere(center, r, results);
+                for(size_t j = 0; j < this->boxes.size(); j++) {
+                    if(this->proxies[j] != -1 &&
+                        distance_squared(this->boxes[j], center) <= r * r) {
+                        expected.push_back((void*) j);
+                    }
+                }
+                expect_same(results, expected);
+            }
+        }
+
+        /// Check whether two boxes overlap
+        static bool overlaps(const AABB& a, const AABB& b) {
+            for(int i = 0; i < 3; i++) {
+                if(a.max[i] < b.min[i] || a.min[i] > b.max[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /// Check whether a box lies entirely inside another
+        static bool contains(const AABB& outer, const AABB& inner) {
+            for(int i = 0; i < 3; i++) {
+                if(inner.min[i] < outer.min[i] || inner.max[i] > outer.max[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /// Get the squared distance from a point to the closest point in a box
+        static float distance_squared(const AABB& box, glm::vec3 point) {
+            float result = 0.0;
+            for(int i = 0; i < 3; i++) {
+                float d = std::max(std::max(box.min[i] - point[i],
+                    point[i] - box.max[i]), 0.0f);
+                result += d * d;
+            }
+            return result;
+        }
+
+        /// Compare query results, ignoring order
+        static void expect_same(std::vector<void*> results, std::vector<void*> expected) {
+            std::sort(results.begin(), results.end());
+            std::sort(expected.begin(), expected.end());
+            EXPECT_EQ(results, expected);
+        }
+
+};
+
+TEST_F(BVHTest, Empty) {
+    std::vector<void*> results;
+    this->bvh.query_aabb(this->random_box(), results);
+    this->bvh.query_sphere(glm::vec3(0.0, 0.0, 0.0), 1000.0, results);
+    EXPECT_EQ(this->bvh.size(), 0u);
+    EXPECT_TRUE(results.empty());
+}
+
+TEST_F(BVHTest, Insert) {
+    for(int i = 0; i < TEST_OBJECT_COUNT; i++) {
+        this->insert_random();
+    }
+    EXPECT_EQ(this->bvh.size(), (size_t) TEST_OBJECT_COUNT);
+    this->check_queries();
+}
+
+TEST_F(BVHTest, RemoveAndMove) {
+    for(int i = 0; i < TEST_OBJECT_COUNT; i++) {
+        this->insert_random();
+    }
+    size_t removed = 0;
+    for(size_t i = 0; i < this->boxes.size(); i += 3) {
+        this->bvh.remove(this->proxies[i]);
+        this->proxies[i] = -1;
+        removed++;
+    }
+    for(size_t i = 1; i < this->boxes.size(); i += 3) {
+        AABB box = this->random_box();
+        bool changed = this->bvh.move(this->proxies[i], box);
+        // A box that fits inside the stored box is left alone
+        EXPECT_EQ(changed, !contains(this->boxes[i], box));
+        if(changed) {
+            this->boxes[i] = box;
+        }
+    }
+    EXPECT_EQ(this->bvh.size(), this->boxes.size() - removed);
+    this->check_queries();
+}
+
+TEST_F(BVHTest, Rebuild) {
+    for(int i = 0; i < TEST_OBJECT_COUNT; i++) {
+        this->insert_random();
+    }
+    this->bvh.rebuild();
+    this->check_queries();
+}
+
+TEST_F(BVHTest, ChangesDuringRebuild) {
+    for(int i = 0; i < TEST_OBJECT_COUNT; i++) {
+        this->insert_random();
+    }
+    BVHBuild build;
+    this->bvh.begin_rebuild(build);
+
+    // Changes made while the tree is built must survive the swap
+    for(size_t i = 0; i < this->boxes.size(); i += 5) {
+        this->bvh.remove(this->proxies[i]);
+        this->proxies[i] = -1;
+    }
+    for(size_t i = 1; i < this->boxes.size(); i += 5) {
+        AABB box = this->random_box();
+        if(this->bvh.move(this->proxies[i], box)) {
+            this->boxes[i] = box;
+        }
+    }
+    for(int i = 0; i < TEST_OBJECT_COUNT / 10; i++) {
+        this->insert_random();
+    }
+
+    BVH::build(build);
+    this->bvh.finish_rebuild(build);
+    this->check_queries();
+}
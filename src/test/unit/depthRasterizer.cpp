@@ -0,0 +1,18 @@
+/*!
+ *  @file src/test/unit/depthRasterizer.cpp
+ * 
+ *  Runs the software depth rasterizer self test.
+ * 
+ *  Copyright 2019 Nicholas Hollander <nhhollander@wpi.edu>
+ * 
+ *  Licensed under the MIT license (see LICENSE for the complete text)
+ */
+
+#include "se/util/depthRasterizer.hpp"
+
+#include <gtest/gtest.h>
+
+// Failures are logged by the self test itself
+TEST(DepthRasterizerTest, SelfTest) {
+    EXPECT_TRUE(se::util::DepthRasterizer::self_test());
+}